@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "Clock.h"
+
+/**
+ * Registry and timing helpers for openglove_bench. Each BENCH prints its own results; run the
+ * binary with part of a name to run only the benchmarks whose name contains it.
+ **/
+using BenchFunction = void (*)();
+
+bool RegisterBench(const char* name, BenchFunction function);
+
+#if defined(_MSC_VER)
+extern volatile const void* g_benchSink;
+#endif
+
+#define BENCH(name)                                                               \
+  static void Bench_##name();                                                     \
+  static const bool Bench_##name##_registered = RegisterBench(#name, &Bench_##name); \
+  static void Bench_##name()
+
+// Keeps the compiler from throwing away a result that is otherwise unused.
+template <typename T>
+inline void DoNotOptimize(T& value) {
+#if defined(_MSC_VER)
+  g_benchSink = &value;
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+// Calls fn in batches of at least 20 ms and returns the fastest batch's time per call, in ns.
+template <typename Fn>
+double MeasureNs(Fn&& fn) {
+  constexpr DriverDuration c_batchTime = std::chrono::milliseconds(20);
+  constexpr int c_batches = 5;
+
+  // grow the batch until it is long enough to time, which doubles as the warm-up
+  size_t iterations = 1;
+  for (;;) {
+    const DriverTimePoint start = DriverClock().Now();
+    for (size_t i = 0; i < iterations; i++) fn();
+    if (DriverClock().Now() - start >= c_batchTime) break;
+    iterations *= 2;
+  }
+
+  double best = 0;
+  for (int batch = 0; batch < c_batches; batch++) {
+    const DriverTimePoint start = DriverClock().Now();
+    for (size_t i = 0; i < iterations; i++) fn();
+    const double ns = static_cast<double>((DriverClock().Now() - start).count()) / iterations;
+    if (batch == 0 || ns < best) best = ns;
+  }
+  return best;
+}
+
+inline void ReportNs(const char* label, double ns) { std::printf("  %-40s %10.1f ns\n", label, ns); }
+
+// CPU time the calling thread has used so far, in ns, or -1 where that can't be read (off Linux).
+inline int64_t ThreadCpuNs() {
+#if defined(__linux__)
+  timespec now;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0)
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+  return -1;
+}
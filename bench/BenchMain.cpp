@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Bench.h"
+#include "Simd/SimdKernels.h"
+
+volatile const void* g_benchSink;
+
+namespace {
+struct RegisteredBench {
+  const char* name;
+  BenchFunction function;
+};
+
+std::vector<RegisteredBench>& Registry() {
+  static std::vector<RegisteredBench> registry;
+  return registry;
+}
+}  // namespace
+
+bool RegisterBench(const char* name, BenchFunction function) {
+  Registry().push_back({name, function});
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+
+  // the best kernels this CPU runs, as the driver binds them at startup
+  std::printf("SIMD: %s\n", SimdIsaName(BindSimdKernels()));
+
+  for (const RegisteredBench& bench : Registry()) {
+    if (filter && std::strstr(bench.name, filter) == nullptr) continue;
+
+    std::printf("%s\n", bench.name);
+    bench.function();
+    std::fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Bench.h"
+#include "Communication/FrameBuffer.h"
+#include "Encode/AlphaEncodingManager.h"
+#include "Encode/LegacyEncodingManager.h"
+#include "Encode/PackedSample.h"
+
+BENCH(Decode) {
+  AlphaEncodingManager alpha(1023.f);
+  LegacyEncodingManager legacy(1023.f);
+  constexpr std::string_view c_alphaPacket = "A512B640C700D800E900F511G511HI\n";
+  constexpr std::string_view c_legacyPacket = "512&640&700&800&900&511&511&1&1&0&0&0&0\n";
+
+  ReportNs("alpha packet", MeasureNs([&] {
+             VRCommData_t data = alpha.Decode(c_alphaPacket);
+             DoNotOptimize(data);
+           }));
+  ReportNs("legacy packet", MeasureNs([&] {
+             VRCommData_t data = legacy.Decode(c_legacyPacket);
+             DoNotOptimize(data);
+           }));
+
+  const VRCommData_t data = alpha.Decode(c_alphaPacket);
+  ReportNs("pack sample", MeasureNs([&] {
+             PackedSample sample = PackSample(data, 0, 0);
+             DoNotOptimize(sample);
+           }));
+}
+
+// The per-byte cost of the frames a broken or hostile glove can send, to compare with Decode.
+BENCH(DecodeAdversarial) {
+  AlphaEncodingManager alpha(1023.f);
+  LegacyEncodingManager legacy(1023.f);
+
+  std::string repeatedKeys;
+  while (repeatedKeys.size() + 2 < c_maxFrameSize) repeatedKeys += "A1";
+  std::string garbage(c_maxFrameSize - 1, '\0');
+  uint32_t random = 1;
+  for (char& byte : garbage) {
+    random = random * 1664525u + 1013904223u;
+    byte = static_cast<char>('\n' + 1 + (random >> 24) % 200);
+  }
+
+  const struct {
+    const char* label;
+    std::string frame;
+  } frames[] = {{"longest number", "A" + std::string(c_maxFrameSize - 2, '9') + "\n"},
+                {"repeated keys", repeatedKeys + "\n"},
+                {"binary garbage", garbage + "\n"}};
+
+  char label[64];
+  for (const auto& [name, frame] : frames) {
+    for (IEncodingManager* decoder : {static_cast<IEncodingManager*>(&alpha),
+                                      static_cast<IEncodingManager*>(&legacy)}) {
+      const double ns = MeasureNs([&] {
+        try {
+          VRCommData_t data = decoder->Decode(frame);
+          DoNotOptimize(data);
+        } catch (const std::invalid_argument&) {
+        }
+      });
+      std::snprintf(label, sizeof(label), "%s %s, per byte", decoder == &alpha ? "alpha" : "legacy",
+                    name);
+      ReportNs(label, ns / static_cast<double>(frame.size()));
+    }
+  }
+
+  // framing alone, a stream with no terminator is read and thrown away
+  FrameBuffer buffer;
+  const std::string stream(64 * 1024, '7');
+  const double ns = MeasureNs([&] {
+    std::string_view rest = stream;
+    while (!rest.empty()) {
+      const size_t bytes = std::min(rest.size(), buffer.WritableBytes());
+      std::memcpy(buffer.WritePtr(), rest.data(), bytes);
+      buffer.Commit(bytes);
+      rest.remove_prefix(bytes);
+
+      std::string_view frame;
+      while (buffer.NextFrame(frame)) DoNotOptimize(frame);
+    }
+  });
+  ReportNs("framing 64 KiB without terminators", ns);
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "DeviceControl.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// enough updates per thread that thread start-up is lost in the noise
+constexpr uint64_t c_updatesPerThread = 2000000;
+constexpr int c_runs = 5;
+
+// DeviceCounters as it was before the fields were grouped by writer: whatever the decoder, the
+// submission thread and RunFrame write shares lines.
+struct PackedCounters {
+  std::atomic<uint64_t> packets{0};
+  std::atomic<uint64_t> decodeErrors{0};
+  std::atomic<uint64_t> submitted{0};
+  std::atomic<uint64_t> reconnects{0};
+  std::atomic<float> latencyMeanMs{0.f};
+  std::atomic<float> latencyJitterMs{0.f};
+  std::atomic<uint64_t> budgetEvents{0};
+  std::atomic<uint32_t> degradedStages{0};
+  std::atomic<float> frameCostUs{0.f};
+
+  std::atomic<bool> connected{false};
+  std::atomic<int64_t> lastPacketNs{0};
+
+  LatencyHistogram decodeLatency;
+  LatencyHistogram submitLatency;
+  LatencyHistogram frameAge;
+};
+
+/**
+ * Hardware cache misses of this thread and every thread it starts while counting, read with
+ * perf_event_open. Not available off Linux, in most containers, or where perf_event_paranoid
+ * forbids it, in which case Available() is false and the reason is in Error().
+ **/
+class CacheMissCounter {
+ public:
+  CacheMissCounter() {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    if (m_fd < 0) m_error = std::strerror(errno);
+#endif
+  }
+  ~CacheMissCounter() {
+#if defined(__linux__)
+    if (m_fd >= 0) close(m_fd);
+#endif
+  }
+
+  bool Available() const { return m_fd >= 0; }
+  const char* Error() const { return m_error; }
+
+  void Start() {
+#if defined(__linux__)
+    if (m_fd < 0) return;
+    ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  // Misses since Start(), counted in threads that have been joined by now.
+  uint64_t Stop() {
+    uint64_t misses = 0;
+#if defined(__linux__)
+    if (m_fd < 0) return 0;
+    ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(m_fd, &misses, sizeof(misses)) != sizeof(misses)) misses = 0;
+#endif
+    return misses;
+  }
+
+ private:
+  int m_fd = -1;
+  const char* m_error = "not supported on this platform";
+};
+
+struct RunResult {
+  double nsPerUpdate;
+  uint64_t misses;
+};
+
+// Both hands at full rate: per hand the listener decoding and the thread submitting to SteamVR,
+// and RunFrame copying frame statistics into both. Every thread only ever writes, so any misses
+// beyond the cold ones come from lines taken away by another writer.
+template <typename Counters>
+RunResult Run(CacheMissCounter& perf) {
+  // two hands allocated together, as the driver's two DeviceControls may well be
+  auto hands = std::make_unique<Counters[]>(2);
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+
+  perf.Start();
+  const DriverTimePoint start = DriverClock().Now();
+  for (int hand = 0; hand < 2; hand++) {
+    Counters& counters = hands[hand];
+    threads.emplace_back([&counters, &go]() {
+      while (!go) std::this_thread::yield();
+      for (uint64_t i = 0; i < c_updatesPerThread; i++) {
+        counters.packets.fetch_add(1, std::memory_order_relaxed);
+        counters.lastPacketNs.store(static_cast<int64_t>(i), std::memory_order_relaxed);
+        counters.decodeLatency.Observe(std::chrono::microseconds(30));
+      }
+    });
+    threads.emplace_back([&counters, &go]() {
+      while (!go) std::this_thread::yield();
+      for (uint64_t i = 0; i < c_updatesPerThread; i++) {
+        counters.submitted.fetch_add(1, std::memory_order_relaxed);
+        counters.submitLatency.Observe(std::chrono::microseconds(80));
+      }
+    });
+  }
+  threads.emplace_back([&hands, &go]() {
+    while (!go) std::this_thread::yield();
+    for (uint64_t i = 0; i < c_updatesPerThread; i++) {
+      for (int hand = 0; hand < 2; hand++) {
+        hands[hand].latencyMeanMs.store(static_cast<float>(i & 7), std::memory_order_relaxed);
+        hands[hand].frameCostUs.store(static_cast<float>(i & 15), std::memory_order_relaxed);
+      }
+    }
+  });
+  go = true;
+  for (std::thread& thread : threads) thread.join();
+  const double ns = static_cast<double>((DriverClock().Now() - start).count());
+  const uint64_t misses = perf.Stop();
+
+  uint64_t packets = hands[0].packets + hands[1].packets;
+  DoNotOptimize(packets);
+  return {ns / static_cast<double>(c_updatesPerThread), misses};
+}
+
+template <typename Counters>
+void Report(const char* layout, CacheMissCounter& perf) {
+  RunResult best{};
+  for (int run = 0; run < c_runs; run++) {
+    const RunResult result = Run<Counters>(perf);
+    if (run == 0 || result.nsPerUpdate < best.nsPerUpdate) best = result;
+  }
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s, per update", layout);
+  ReportNs(label, best.nsPerUpdate);
+  std::snprintf(label, sizeof(label), "%s, cache misses", layout);
+  if (perf.Available()) {
+    std::printf("  %-40s %10.2f per update\n", label,
+                static_cast<double>(best.misses) / static_cast<double>(5 * c_updatesPerThread));
+  } else {
+    std::printf("  %-40s unavailable (%s)\n", label, perf.Error());
+  }
+}
+}  // namespace
+
+// DeviceCounters laid out by writer against the layout it replaced, with five threads writing
+// into two hands' counters. The difference only shows when the threads really run side by side,
+// so the core count is printed with it.
+BENCH(FalseSharing) {
+  std::printf("  %u hardware threads\n", std::max(1u, std::thread::hardware_concurrency()));
+  CacheMissCounter perf;
+  Report<PackedCounters>("adjacent", perf);
+  Report<DeviceCounters>("cache-line aligned", perf);
+}
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "Communication/IoReactor.h"
+
+#if defined(__linux__)
+#include <filesystem>
+#endif
+
+namespace {
+// a glove streams at up to 1 kHz, for this long per stream count
+constexpr auto c_packetInterval = std::chrono::milliseconds(1);
+constexpr auto c_runTime = std::chrono::milliseconds(400);
+const size_t c_streamCounts[] = {1, 2, 4, 8, 16, 32};
+
+#if defined(__linux__)
+using Socket = asio::local::stream_protocol::socket;
+
+// One simulated device: the driver reads its end through the reactor, the bench writes the other.
+struct SimulatedStream {
+  SimulatedStream(asio::io_context& reactorContext, asio::io_context& writerContext)
+      : driverEnd(reactorContext), deviceEnd(writerContext) {
+    asio::local::connect_pair(driverEnd, deviceEnd);
+  }
+
+  Socket driverEnd;
+  Socket deviceEnd;
+  FrameBuffer frameBuffer;
+  std::shared_ptr<AsyncFrameReader<Socket>> reader;
+};
+
+size_t ProcessThreads() {
+  size_t threads = 0;
+  for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task")) {
+    (void)entry;
+    threads++;
+  }
+  return threads;
+}
+
+// Streams packets into every stream at the glove rate for c_runTime, and reports the reactor's
+// threads and the reactor thread's CPU time per packet it framed.
+void Run(size_t streamCount) {
+  IoReactor reactor;
+  asio::io_context writerContext;
+  std::vector<std::unique_ptr<SimulatedStream>> streams;
+  for (size_t i = 0; i < streamCount; i++)
+    streams.push_back(std::make_unique<SimulatedStream>(reactor.Context(), writerContext));
+
+  std::atomic<uint64_t> frames{0};
+  std::atomic<uint64_t> errors{0};
+  reactor.Start();
+  reactor.RunSync([&]() {
+    for (auto& stream : streams) {
+      stream->reader = std::make_shared<AsyncFrameReader<Socket>>(
+          stream->driverEnd, stream->frameBuffer, std::chrono::seconds(1),
+          [&](std::string_view) { frames.fetch_add(1, std::memory_order_relaxed); },
+          [&](const asio::error_code&) { errors++; });
+      stream->reader->Start(DriverDuration::zero());
+    }
+  });
+
+  // the bench's own main and writer threads are not the reactor's
+  const size_t threads = ProcessThreads() + 1 - 2;
+
+  int64_t cpuStart = 0;
+  reactor.RunSync([&]() { cpuStart = ThreadCpuNs(); });
+
+  const std::string packet = "A512B512C512D512E512F300G300\n";
+  uint64_t sent = 0;
+  std::thread writer([&]() {
+    const auto start = std::chrono::steady_clock::now();
+    for (auto next = start; next - start < c_runTime; next += c_packetInterval) {
+      std::this_thread::sleep_until(next);
+      for (auto& stream : streams) {
+        asio::error_code ec;
+        asio::write(stream->deviceEnd, asio::buffer(packet), ec);
+        if (!ec) sent++;
+      }
+    }
+  });
+  writer.join();
+
+  // let the reactor catch up with what is still in the sockets
+  const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (frames < sent && std::chrono::steady_clock::now() < giveUp) std::this_thread::yield();
+
+  int64_t cpuEnd = 0;
+  reactor.RunSync([&]() {
+    cpuEnd = ThreadCpuNs();
+    for (auto& stream : streams) {
+      stream->reader->Stop();
+      stream->reader.reset();
+      asio::error_code ec;
+      stream->driverEnd.close(ec);
+    }
+  });
+  // the cancelled reads complete before this, releasing the readers while the sockets still exist
+  reactor.RunSync([]() {});
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "%zu streams, %zu threads, per packet", streamCount, threads);
+  ReportNs(label, static_cast<double>(cpuEnd - cpuStart) / static_cast<double>(frames.load()));
+  if (frames != sent || errors != 0) {
+    std::printf("  %zu streams: %llu of %llu packets framed, %llu errors\n", streamCount,
+                static_cast<unsigned long long>(frames.load()),
+                static_cast<unsigned long long>(sent),
+                static_cast<unsigned long long>(errors.load()));
+  }
+}
+#endif
+}  // namespace
+
+// Reactor thread CPU per packet as the number of devices grows. The listener threads it replaced
+// took one thread per device; the reactor stays at its own thread and the blocking pool.
+BENCH(IoReactorScaling) {
+#if defined(__linux__)
+  for (size_t streamCount : c_streamCounts) Run(streamCount);
+#else
+  std::printf("  needs socketpairs and per-thread CPU time, only run on Linux\n");
+#endif
+}
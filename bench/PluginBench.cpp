@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bench.h"
+#include "Encode/AlphaEncodingManager.h"
+#include "Encode/PackedSample.h"
+#include "Encode/PluginEncodingManager.h"
+#include "Plugin/PluginRegistry.h"
+
+namespace {
+// what a read usually completes at a few hundred Hz, and the most a listener passes in one call
+constexpr size_t c_smallBatch = 4;
+constexpr size_t c_largeBatch = 64;
+
+std::vector<std::string> Packets(size_t count) {
+  std::vector<std::string> packets;
+  for (size_t i = 0; i < count; i++) {
+    std::string packet;
+    for (char key = 'A'; key <= 'G'; key++)
+      packet += key + std::to_string((i * 37 + key * 11) % 1024);
+    if (i % 3 == 0) packet += "I";
+    if (i % 5 == 0) packet += "J";
+    packets.push_back(packet + "\n");
+  }
+  return packets;
+}
+
+// Time per frame, decoding one frame per call the way transports did before batching, then in
+// batches through DecodeBatch().
+void Report(const char* name, IEncodingManager& decoder, const std::vector<std::string>& packets) {
+  std::vector<std::string_view> frames(packets.begin(), packets.end());
+  std::vector<PackedSample> samples(frames.size());
+  char label[64];
+
+  size_t next = 0;
+  const double single = MeasureNs([&] {
+    PackedSample sample = PackSample(decoder.Decode(frames[next]), 0, 0);
+    DoNotOptimize(sample);
+    next = (next + 1) % frames.size();
+  });
+  std::snprintf(label, sizeof(label), "%s x1", name);
+  ReportNs(label, single);
+
+  for (size_t batch : {c_smallBatch, c_largeBatch}) {
+    const double ns = MeasureNs([&] {
+      size_t decoded = decoder.DecodeBatch(frames.data(), batch, samples.data());
+      DoNotOptimize(decoded);
+    });
+    std::snprintf(label, sizeof(label), "%s x%zu", name, batch);
+    ReportNs(label, ns / static_cast<double>(batch));
+  }
+}
+}  // namespace
+
+// The sample plugin's codec decodes the same keys as the built-in alpha decoder, so the difference
+// is what crossing the plugin ABI costs.
+BENCH(PluginCodec) {
+  const std::vector<std::string> packets = Packets(c_largeBatch);
+
+  AlphaEncodingManager builtIn(1023.f);
+  Report("alpha", builtIn, packets);
+
+  PluginRegistry registry;
+  const OpengloveCodecApi* codec =
+      registry.Load(OPENGLOVE_SAMPLE_PLUGIN) ? registry.FindCodec("sample-alpha") : nullptr;
+  if (codec == nullptr) {
+    std::printf("  %s could not be loaded\n", OPENGLOVE_SAMPLE_PLUGIN);
+    return;
+  }
+
+  PluginEncodingManager plugin(codec, "1023");
+  Report("sample-alpha plugin", plugin, packets);
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "Bench.h"
+#include "Communication/FrameBuffer.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+// what a glove at a few hundred Hz leaves queued when the listener is a few ms late
+constexpr size_t c_packetsPerBurst = 16;
+
+std::string Burst() {
+  std::string burst;
+  for (size_t i = 0; i < c_packetsPerBurst; i++) burst += "A512B640C700D800E900F511G511HI\n";
+  return burst;
+}
+
+// The listeners before chunked reads: one read per byte, appended to a string until the terminator.
+template <typename ReadByte>
+size_t PerByteFrames(size_t bytes, ReadByte&& readByte) {
+  std::string frame;
+  size_t frames = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    const char next = readByte();
+    frame += next;
+    if (next == '\n') {
+      DoNotOptimize(frame);
+      frame.clear();
+      frames++;
+    }
+  }
+  return frames;
+}
+
+// What they do now: read whatever is queued straight into the frame buffer, then split it up.
+template <typename Read>
+size_t ChunkedFrames(FrameBuffer& frameBuffer, size_t bytes, Read&& read) {
+  size_t frames = 0;
+  while (bytes > 0) {
+    const size_t room = std::min(bytes, frameBuffer.WritableBytes());
+    const size_t bytesRead = read(frameBuffer.WritePtr(), room);
+    frameBuffer.Commit(bytesRead);
+    bytes -= bytesRead;
+
+    std::string_view frame;
+    while (frameBuffer.NextFrame(frame)) {
+      DoNotOptimize(frame);
+      frames++;
+    }
+  }
+  return frames;
+}
+}  // namespace
+
+// Time per packet to get a burst of queued packets from the transport into frames. From memory that
+// is the framing alone; through a pipe it includes a read call per byte or per chunk, as a serial
+// port or socket would.
+BENCH(ReadPath) {
+  const std::string burst = Burst();
+  const double packets = static_cast<double>(c_packetsPerBurst);
+  FrameBuffer frameBuffer;
+
+  ReportNs("memory, per byte", MeasureNs([&] {
+             size_t position = 0;
+             size_t frames = PerByteFrames(burst.size(), [&] { return burst[position++]; });
+             DoNotOptimize(frames);
+           }) / packets);
+  ReportNs("memory, chunked frame buffer", MeasureNs([&] {
+             size_t position = 0;
+             size_t frames = ChunkedFrames(frameBuffer, burst.size(), [&](char* out, size_t room) {
+               std::memcpy(out, burst.data() + position, room);
+               position += room;
+               return room;
+             });
+             DoNotOptimize(frames);
+           }) / packets);
+
+#if defined(__linux__)
+  int fds[2];
+  if (pipe(fds) != 0) return;
+
+  // the burst fits in the pipe, so writing it never blocks
+  ReportNs("pipe, per byte", MeasureNs([&] {
+             if (write(fds[1], burst.data(), burst.size()) < 0) return;
+             size_t frames = PerByteFrames(burst.size(), [&] {
+               char next = 0;
+               if (read(fds[0], &next, 1) != 1) next = '\n';
+               return next;
+             });
+             DoNotOptimize(frames);
+           }) / packets);
+  ReportNs("pipe, chunked frame buffer", MeasureNs([&] {
+             if (write(fds[1], burst.data(), burst.size()) < 0) return;
+             size_t frames = ChunkedFrames(frameBuffer, burst.size(), [&](char* out, size_t room) {
+               const ssize_t bytesRead = read(fds[0], out, room);
+               return bytesRead > 0 ? static_cast<size_t>(bytesRead) : room;
+             });
+             DoNotOptimize(frames);
+           }) / packets);
+
+  close(fds[0]);
+  close(fds[1]);
+#endif
+}
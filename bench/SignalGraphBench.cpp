@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Bench.h"
+#include "SignalGraph.h"
+
+namespace {
+// The same processing as one pass per stage over the packet, the way it would run if every stage
+// were applied separately. Only here to compare against.
+struct StagedTuning {
+  VRInputTuning_t tuning;
+  std::array<float, 5> filtered{};
+  bool primed = false;
+
+  void Process(VRCommData_t& data) {
+    for (float& value : data.flexion)
+      value = std::clamp((value - tuning.flexionMin) / (tuning.flexionMax - tuning.flexionMin), 0.f,
+                         1.f);
+
+    for (size_t i = 0; i < data.flexion.size(); i++) {
+      if (primed) data.flexion[i] += (filtered[i] - data.flexion[i]) * tuning.smoothing;
+      filtered[i] = data.flexion[i];
+    }
+    primed = true;
+
+    for (float& value : data.flexion)
+      value = std::max((value - tuning.flexionDeadzone) / (1.f - tuning.flexionDeadzone), 0.f);
+
+    for (float& value : data.flexion) value = std::pow(std::min(value, 1.f), tuning.flexionCurve);
+
+    data.grab = data.grab || (data.flexion[2] + data.flexion[3] + data.flexion[4]) / 3.f >=
+                                 tuning.grabThreshold;
+    data.pinch = data.pinch || std::min(data.flexion[0], data.flexion[1]) >= tuning.pinchThreshold;
+
+    const float magnitude = std::hypot(data.joyX, data.joyY);
+    const float scale =
+        magnitude <= tuning.joystickDeadzone
+            ? 0.f
+            : std::min((magnitude - tuning.joystickDeadzone) / (1.f - tuning.joystickDeadzone), 1.f) /
+                  magnitude;
+    data.joyX *= scale;
+    data.joyY *= scale;
+  }
+};
+}  // namespace
+
+BENCH(SignalGraph) {
+  // every stage on
+  const VRInputTuning_t tuning(0.5f, 2.2f, 0.1f, 0.2f, 0.05f, 0.95f, 0.8f, 0.8f);
+  const VRCommData_t packet({0.3f, 0.4f, 0.5f, 0.6f, 0.7f}, {0.5f, 0.5f, 0.5f, 0.5f, 0.5f}, 0.5f,
+                            0.1f, false, false, false, false, false, false, false);
+
+  SignalGraph fused;
+  fused.Compile(tuning);
+  StagedTuning staged{tuning};
+  SignalGraph identity;
+
+  int i = 0;
+  auto vary = [&](VRCommData_t& data) {
+    data.flexion[i % 5] = static_cast<float>(i & 1023) / 1024.f;
+    i++;
+  };
+
+  ReportNs("staged, one pass per stage", MeasureNs([&] {
+             VRCommData_t data = packet;
+             vary(data);
+             staged.Process(data);
+             DoNotOptimize(data);
+           }));
+  ReportNs("fused, every stage", MeasureNs([&] {
+             VRCommData_t data = packet;
+             vary(data);
+             fused.Process(data);
+             DoNotOptimize(data);
+           }));
+  ReportNs("fused, default tuning", MeasureNs([&] {
+             VRCommData_t data = packet;
+             vary(data);
+             identity.Process(data);
+             DoNotOptimize(data);
+           }));
+}
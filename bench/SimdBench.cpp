@@ -0,0 +1,79 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "Simd/SimdKernels.h"
+
+namespace {
+// one skeleton per hand per frame, and the four poses a thumb blend mixes over every bone
+constexpr size_t c_bones = 31;
+constexpr size_t c_blendFloats = c_bones * 8;
+// every per-lane stage enabled
+constexpr uint32_t c_allStages = 15;
+
+void ReportSpeedup(const char* kernel, SimdIsa isa, double ns, double scalarNs) {
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s %s (%.1fx)", kernel, SimdIsaName(isa), scalarNs / ns);
+  ReportNs(label, ns);
+}
+}  // namespace
+
+// Each kernel family at every instruction set this CPU runs, with the speedup over scalar.
+BENCH(SimdKernels) {
+  std::vector<float> open(c_blendFloats), fist(c_blendFloats), out(c_blendFloats);
+  std::vector<float> a(c_blendFloats), b(c_blendFloats), c(c_blendFloats), d(c_blendFloats);
+  std::vector<float> boneWeights(c_bones);
+  for (size_t i = 0; i < c_blendFloats; i++) {
+    open[i] = std::sin(static_cast<float>(i));
+    fist[i] = std::cos(static_cast<float>(i));
+    a[i] = open[i];
+    b[i] = fist[i];
+    c[i] = open[i] * 0.5f;
+    d[i] = fist[i] * 0.5f;
+  }
+  for (size_t i = 0; i < c_bones; i++) boneWeights[i] = static_cast<float>(i) / c_bones;
+  const float blendWeights[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+
+  std::vector<float> curveTable(c_signalCurveTableSize + 1);
+  for (size_t i = 0; i < curveTable.size(); i++)
+    curveTable[i] = std::pow(static_cast<float>(i) / c_signalCurveTableSize, 1.5f);
+  SignalLaneParameters parameters;
+  parameters.rangeMin = 0.05f;
+  parameters.rangeScale = 1.1f;
+  parameters.deadband = 0.02f;
+  parameters.deadbandScale = 1.f / 0.98f;
+  float filtered[c_signalLaneCount] = {};
+  float lanes[c_signalLaneCount] = {};
+
+  double scalarNs[3] = {};
+  for (uint32_t isa = SimdIsa_Scalar; isa <= DetectSimdIsa(); isa++) {
+    const SimdKernels kernels = SimdKernelsFor(static_cast<SimdIsa>(isa));
+    // nothing built for this one, its numbers would be the level below's
+    if (kernels.isa != isa) continue;
+
+    const double ns[3] = {
+        MeasureNs([&] {
+          kernels.blendBones(open.data(), fist.data(), boneWeights.data(), out.data(), c_bones);
+          DoNotOptimize(out);
+        }),
+        MeasureNs([&] {
+          kernels.blend4(a.data(), b.data(), c.data(), d.data(), blendWeights, out.data(),
+                         c_blendFloats);
+          DoNotOptimize(out);
+        }),
+        MeasureNs([&] {
+          for (size_t i = 0; i < c_signalLaneCount; i++) lanes[i] = 0.1f * static_cast<float>(i);
+          kernels.signalLanes[c_allStages](parameters, curveTable.data(), 0.3f, filtered, lanes);
+          DoNotOptimize(lanes);
+        }),
+    };
+    if (isa == SimdIsa_Scalar) {
+      for (int i = 0; i < 3; i++) scalarNs[i] = ns[i];
+    }
+
+    ReportSpeedup("blendBones", kernels.isa, ns[0], scalarNs[0]);
+    ReportSpeedup("blend4", kernels.isa, ns[1], scalarNs[1]);
+    ReportSpeedup("signalLanes", kernels.isa, ns[2], scalarNs[2]);
+  }
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "Communication/FrameBuffer.h"
+#include "Communication/TransportWaiter.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// a glove at 1 kHz, for long enough that the arrival model has settled for most of the run
+constexpr auto c_packetInterval = std::chrono::milliseconds(1);
+constexpr size_t c_packets = 1000;
+
+#if defined(__linux__)
+struct WaitResult {
+  std::vector<int64_t> latencyNs;
+  int64_t cpuNs;
+};
+
+// The transport the serial and Bluetooth listeners see, on one end of a socketpair: poll() is
+// FIONREAD where they call ClearCommError or ioctlsocket, block() waits in ppoll.
+WaitResult Run(VRWaitStrategy strategy) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return {};
+  const int driverEnd = fds[0];
+  const int deviceEnd = fds[1];
+
+  // the writer stamps each packet before it sends it, the reader looks the stamp up by sequence
+  auto sentNs = std::make_unique<std::atomic<int64_t>[]>(c_packets);
+  WaitResult result;
+  result.latencyNs.reserve(c_packets);
+
+  std::atomic<bool> active{true};
+  std::thread reader([&]() {
+    TransportWaiter waiter(strategy, active);
+    FrameBuffer frameBuffer;
+    const auto poll = [&]() {
+      int available = 0;
+      if (ioctl(driverEnd, FIONREAD, &available) != 0) return -1;
+      return available > 0 ? 1 : 0;
+    };
+    const auto block = [&](DriverDuration timeout) {
+      pollfd descriptor{driverEnd, POLLIN, 0};
+      timespec limit;
+      if (timeout != DriverDuration::max()) {
+        const int64_t ns = std::max<int64_t>(0, timeout.count());
+        limit = {static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+      }
+      return ppoll(&descriptor, 1, timeout == DriverDuration::max() ? nullptr : &limit,
+                   nullptr) >= 0;
+    };
+
+    const int64_t cpuStart = ThreadCpuNs();
+    while (result.latencyNs.size() < c_packets) {
+      if (!waiter.Wait(poll, block)) break;
+      const ssize_t bytes = read(driverEnd, frameBuffer.WritePtr(), frameBuffer.WritableBytes());
+      // the writer closing its end
+      if (bytes <= 0) break;
+      frameBuffer.Commit(static_cast<size_t>(bytes));
+      waiter.OnArrival();
+
+      const int64_t now = DriverClock().Now().time_since_epoch().count();
+      std::string_view frame;
+      while (frameBuffer.NextFrame(frame) && result.latencyNs.size() < c_packets)
+        result.latencyNs.push_back(now - sentNs[result.latencyNs.size()]);
+    }
+    result.cpuNs = ThreadCpuNs() - cpuStart;
+  });
+
+  const char packet[] = "A512B512C512D512E512F300G300\n";
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < c_packets; i++) {
+    std::this_thread::sleep_until(start + i * c_packetInterval);
+    sentNs[i] = DriverClock().Now().time_since_epoch().count();
+    if (write(deviceEnd, packet, sizeof(packet) - 1) < 0) break;
+  }
+
+  // a reader that fell behind finishes from what is queued, then sees the end of the stream, or
+  // stops spinning on it the way Disconnect() stops a listener
+  shutdown(deviceEnd, SHUT_WR);
+  active = false;
+  reader.join();
+  close(driverEnd);
+  close(deviceEnd);
+  return result;
+}
+
+void Report(const char* strategyName, VRWaitStrategy strategy) {
+  WaitResult result = Run(strategy);
+  if (result.latencyNs.empty()) {
+    std::printf("  %s: no packets read\n", strategyName);
+    return;
+  }
+
+  std::vector<int64_t>& latency = result.latencyNs;
+  std::sort(latency.begin(), latency.end());
+  double sum = 0;
+  for (int64_t ns : latency) sum += static_cast<double>(ns);
+  const double packets = static_cast<double>(latency.size());
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s, wake latency mean", strategyName);
+  ReportNs(label, sum / packets);
+  std::snprintf(label, sizeof(label), "%s, wake latency p99", strategyName);
+  ReportNs(label, static_cast<double>(latency[latency.size() * 99 / 100]));
+  std::snprintf(label, sizeof(label), "%s, reader CPU per packet", strategyName);
+  ReportNs(label, static_cast<double>(result.cpuNs) / packets);
+}
+#endif
+}  // namespace
+
+// Time from a packet being written to the listener having read it, and the listener thread's CPU
+// time per packet, for each wait strategy with packets arriving at the glove rate.
+BENCH(TransportWaiter) {
+#if defined(__linux__)
+  Report("blocking", VRWaitStrategy::BLOCKING);
+  Report("busy poll", VRWaitStrategy::BUSY_POLL);
+  Report("adaptive spin", VRWaitStrategy::ADAPTIVE_SPIN);
+#else
+  std::printf("  needs socketpairs and per-thread CPU time, only run on Linux\n");
+#endif
+}
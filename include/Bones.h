@@ -2,11 +2,12 @@
 #include <openvr_driver.h>
 
 const int NUM_BONES = 31;
-extern vr::VRBoneTransform_t rightOpenPose[NUM_BONES];
-extern vr::VRBoneTransform_t rightFistPose[NUM_BONES];
+//read only, so both hands' threads can read them without ever taking each other's cache lines
+extern const vr::VRBoneTransform_t rightOpenPose[NUM_BONES];
+extern const vr::VRBoneTransform_t rightFistPose[NUM_BONES];
 
-extern vr::VRBoneTransform_t leftOpenPose[NUM_BONES];
-extern vr::VRBoneTransform_t leftFistPose[NUM_BONES];
+extern const vr::VRBoneTransform_t leftOpenPose[NUM_BONES];
+extern const vr::VRBoneTransform_t leftFistPose[NUM_BONES];
 
 enum HandSkeletonBone : vr::BoneIndex_t {
 	eBone_Root = 0,
@@ -44,6 +45,14 @@ enum HandSkeletonBone : vr::BoneIndex_t {
 };
 
 void ComputeBoneFlexion(vr::VRBoneTransform_t* bone_transform, float transform, int index, const bool isRightHand);
+/**
+*Writes the index to pinky bones of handTransforms from the flexion of each finger, in one pass of the bound SIMD kernel.
+**/
+void ComputeFingerFlexion(vr::VRBoneTransform_t* handTransforms, const float* flexion, const bool isRightHand);
+/**
+*Writes all thumb bones of handTransforms from curl and opposition, see ThumbPoseTable.
+**/
+void ComputeThumbPose(vr::VRBoneTransform_t* handTransforms, float curl, float opposition, const bool isRightHand);
 void ComputeBoneSplay(vr::VRBoneTransform_t* bone_transform, const float transform, int index, const bool isRightHand);
 vr::HmdQuaternionf_t CalculateOrientation(const float transform, const int boneIndex, const vr::VRBoneTransform_t* openPose, const vr::VRBoneTransform_t* fistPose);
 vr::HmdVector4_t CalculatePosition(const float transform, const int boneIndex, const vr::VRBoneTransform_t* openPose, const vr::VRBoneTransform_t* fistPose);
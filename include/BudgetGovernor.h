@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CacheLine.h"
+#include "Clock.h"
+#include "DeviceConfiguration.h"
+#include "SignalGraph.h"
+
+struct DeviceCounters;
+
+// Optional processing the governor may degrade, and what degrading it does.
+enum BudgetStage : uint32_t {
+  BudgetStage_Recording = 1 << 0,     // submitted samples are not recorded
+  BudgetStage_Diagnostics = 1 << 1,   // diagnostics and OSC get a fresh snapshot less often
+  BudgetStage_SkeletonRate = 1 << 2,  // the skeleton is submitted at most once per frame
+  BudgetStage_Smoothing = 1 << 3,     // the flexion filter is bypassed
+  BudgetStage_Gestures = 1 << 4,      // grab and pinch are left to the glove
+};
+static constexpr uint32_t c_budgetStageCount = 5;
+
+// Where the driver spends its time for one hand, charged by whichever thread does the work.
+enum BudgetCost : uint32_t {
+  BudgetCost_Signal,       // unpacking and the signal graph
+  BudgetCost_Skeleton,     // bone transforms and skeleton submission
+  BudgetCost_Controls,     // scalar and boolean components
+  BudgetCost_Diagnostics,  // snapshot publishing
+  BudgetCost_Recording,
+  BudgetCost_Pose,  // RunFrame
+};
+static constexpr uint32_t c_budgetCostCount = 6;
+
+const char* BudgetStageName(BudgetStage stage);
+
+// Stage names in a comma separated list, in order. Unknown names are logged and skipped, and
+// stages that are missing are not degraded at all.
+std::vector<BudgetStage> ParseBudgetStages(std::string_view list);
+
+// SignalStage bits the degraded BudgetStage bits take out of the signal graph
+inline uint32_t BypassedSignalStages(uint32_t degraded) {
+  return ((degraded & BudgetStage_Smoothing) ? static_cast<uint32_t>(SignalStage_Filter) : 0u) |
+         ((degraded & BudgetStage_Gestures) ? static_cast<uint32_t>(SignalStage_Gesture) : 0u);
+}
+
+/**
+ * Keeps the driver's work for one hand within a per-frame time budget. The input path and RunFrame
+ * charge what each part of their work costs; once per evaluation window RunFrame works out the
+ * average cost of a frame and compares it with the budget.
+ *
+ * Over budget, the next optional stage in the configured order is degraded, one per window. Once
+ * the cost has stayed below restoreHeadroom of the budget for long enough, the stage degraded last
+ * is restored. A stage that goes straight back over budget after being restored doubles how long
+ * the next restore waits, so a machine that is loaded for a while does not make the hand flicker
+ * between the two. Every change is logged with the costs that caused it and counted.
+ *
+ * Charge() and Degraded() can be called from any thread, OnFrame() only from RunFrame.
+ **/
+class BudgetGovernor {
+ public:
+  BudgetGovernor(const VRBudgetConfiguration_t& configuration, std::string name,
+                 DeviceCounters& counters);
+
+  void Charge(BudgetCost cost, DriverDuration spent) {
+    m_spentNs[cost].fetch_add(spent.count(), std::memory_order_relaxed);
+  }
+
+  void OnFrame(DriverTimePoint now);
+
+  // BudgetStage bits that are degraded right now
+  uint32_t Degraded() const { return m_degraded.load(std::memory_order_relaxed); }
+  bool IsDegraded(BudgetStage stage) const { return (Degraded() & stage) != 0; }
+
+  // average time between frames over the last window, 0 until one has passed
+  DriverDuration FramePeriod() const {
+    return DriverDuration(m_framePeriodNs.load(std::memory_order_relaxed));
+  }
+
+ private:
+  void Evaluate(DriverTimePoint now, DriverDuration window);
+  void Degrade(DriverTimePoint now, double frameCostUs, const double* costsUs);
+  void Restore(DriverTimePoint now, double frameCostUs, const double* costsUs);
+
+  const bool m_enabled;
+  const double m_budgetUs;
+  const double m_restoreUs;
+  const std::vector<BudgetStage> m_order;
+  const std::string m_name;
+  DeviceCounters& m_counters;
+
+  // charged by the input path on every packet
+  alignas(c_cacheLineSize) std::array<std::atomic<int64_t>, c_budgetCostCount> m_spentNs{};
+  // read on every packet, written once a window
+  alignas(c_cacheLineSize) std::atomic<uint32_t> m_degraded{0};
+  std::atomic<int64_t> m_framePeriodNs{0};
+
+  // owned by RunFrame
+  alignas(c_cacheLineSize) DriverTimePoint m_windowStart{};
+  uint32_t m_frames = 0;
+  // how many of m_order are degraded, always the first ones
+  size_t m_degradedCount = 0;
+  uint32_t m_calmWindows = 0;
+  uint32_t m_holdWindows;
+  DriverTimePoint m_lastRestore{};
+  DriverTimePoint m_lastDegrade{};
+  bool m_exhausted = false;
+};
+
+/**
+ * Charges the time since it was started, or since the last charge, to one cost at a time, so a
+ * sequence of stages is timed with one clock read each.
+ **/
+class BudgetTimer {
+ public:
+  BudgetTimer(BudgetGovernor& governor, DriverTimePoint start)
+      : m_governor(governor), m_mark(start) {}
+
+  void Charge(BudgetCost cost) {
+    const DriverTimePoint now = DriverClock().Now();
+    m_governor.Charge(cost, now - m_mark);
+    m_mark = now;
+  }
+
+  DriverTimePoint Mark() const { return m_mark; }
+
+ private:
+  BudgetGovernor& m_governor;
+  DriverTimePoint m_mark;
+};
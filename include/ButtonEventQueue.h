@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ConcurrencyChecks.h"
+#include "Encode/PackedSample.h"
+#include "SpscRing.h"
+
+// Buttons whose every press and release matters. Grab and pinch can also come out of the signal
+// graph from flexion, so they follow the analog channels instead.
+static constexpr uint16_t c_eventButtons =
+    PackedButton_Joystick | PackedButton_Trigger | PackedButton_A | PackedButton_B;
+
+struct ButtonEvent {
+  // when the packet with the change was decoded, on DriverClock()
+  int64_t timeNs;
+  // state of every event button after the change
+  uint16_t buttons;
+  // the bits that changed
+  uint16_t changed;
+};
+
+/**
+ * Carries button changes from the transport thread to the thread that submits them, so a tap that
+ * starts and ends between two frames still reaches SteamVR when only the latest analog state is
+ * applied each frame. One producer, one consumer.
+ **/
+class ButtonEventQueue {
+ public:
+  explicit ButtonEventQueue(size_t capacity);
+
+  // Producer. Queues an event if the sample's buttons differ from the last queued state. If the
+  // queue is full the change is counted and folded into the next event, so the consumer can miss
+  // a tap but always ends up with the right state.
+  void OnSample(const PackedSample& sample);
+
+  // Consumer. Hands every queued event to fn in the order they happened.
+  template <typename Fn>
+  size_t Drain(Fn&& fn) {
+    size_t drained = 0;
+    ButtonEvent event;
+    while (m_ring.TryPop(event)) {
+      // every change is relative to the event before it, so a lost or reordered event shows here
+      OPENGLOVE_CHECK(
+          event.changed == (event.buttons ^ m_drainedButtons) && event.timeNs >= m_drainedNs,
+          "ButtonEventQueue lost or reordered an event");
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+      m_drainedButtons = event.buttons;
+      m_drainedNs = event.timeNs;
+#endif
+      fn(event);
+      drained++;
+    }
+    return drained;
+  }
+
+  uint64_t Overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+
+ private:
+  SpscRing<ButtonEvent> m_ring;
+
+  // producer only
+  uint16_t m_queuedButtons = 0;
+  std::atomic<uint64_t> m_overflows{0};
+
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+  // consumer only
+  uint16_t m_drainedButtons = 0;
+  int64_t m_drainedNs = 0;
+#endif
+};
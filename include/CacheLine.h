@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+// Data written by different threads is kept at least this far apart, so a write from one thread
+// never takes a line away from another that only reads its own data next to it (false sharing).
+// Both hands run on threads of their own, with RunFrame on a third.
+static constexpr size_t c_cacheLineSize = 64;
+
+/**
+ * Heap bytes that start on a cache line and are padded to a whole number of lines, so no other
+ * allocation shares a line with them. For buffers a thread writes at the packet rate, which the
+ * allocator would otherwise happily place right next to the other hand's.
+ **/
+class CacheAlignedBuffer {
+ public:
+  explicit CacheAlignedBuffer(size_t size)
+      : m_data(static_cast<char*>(::operator new[](
+            (size + c_cacheLineSize - 1) / c_cacheLineSize * c_cacheLineSize,
+            std::align_val_t(c_cacheLineSize)))),
+        m_size(size) {}
+
+  char* Data() { return m_data.get(); }
+  const char* Data() const { return m_data.get(); }
+  size_t Size() const { return m_size; }
+
+ private:
+  struct Free {
+    void operator()(char* data) const {
+      ::operator delete[](data, std::align_val_t(c_cacheLineSize));
+    }
+  };
+
+  std::unique_ptr<char[], Free> m_data;
+  size_t m_size;
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+
+using DriverDuration = std::chrono::nanoseconds;
+using DriverTimePoint = std::chrono::time_point<std::chrono::steady_clock, DriverDuration>;
+
+/**
+ * Wakes a thread sleeping on a clock before its deadline, so the owner of a worker doesn't have to
+ * wait out the rest of its sleep to stop it. Stays set until Reset().
+ **/
+class ClockSignal {
+ public:
+  void Set();
+  void Reset() { m_set.store(false, std::memory_order_release); }
+  bool IsSet() const { return m_set.load(std::memory_order_acquire); }
+
+ private:
+  friend class SystemClock;
+
+  std::atomic<bool> m_set{false};
+  std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+};
+
+/**
+ * Source of time for everything in the driver that waits or measures. Components must go through
+ * DriverClock() rather than std::chrono/std::this_thread directly so that a session can be replayed
+ * against a SimulatedClock.
+ **/
+class IClock {
+ public:
+  virtual ~IClock() = default;
+
+  virtual DriverTimePoint Now() = 0;
+
+  // Block the calling thread until Now() >= deadline.
+  virtual void SleepUntil(DriverTimePoint deadline) = 0;
+  // The same, but returns false as soon as cancel is set.
+  virtual bool SleepUntil(DriverTimePoint deadline, ClockSignal& cancel) = 0;
+
+  // Waits on OS objects (events, sockets, asio timers) run on host time. They block for at most this
+  // long at a time and then check Now() against their deadline again, so they keep to this clock.
+  virtual DriverDuration MaxHostWait(DriverDuration remaining) = 0;
+
+  void SleepFor(DriverDuration duration) { SleepUntil(Now() + duration); }
+  bool SleepFor(DriverDuration duration, ClockSignal& cancel) {
+    return SleepUntil(Now() + duration, cancel);
+  }
+};
+
+// Wall-clock implementation backed by std::chrono::steady_clock.
+class SystemClock : public IClock {
+ public:
+  DriverTimePoint Now() override;
+  void SleepUntil(DriverTimePoint deadline) override;
+  bool SleepUntil(DriverTimePoint deadline, ClockSignal& cancel) override;
+  DriverDuration MaxHostWait(DriverDuration remaining) override { return remaining; }
+};
+
+/**
+ * Clock that only moves when told to. Sleeping threads are parked until simulated time reaches their
+ * deadline, so ordering between threads is decided by deadlines rather than by the OS scheduler.
+ *
+ * With SetParticipants(n), time jumps straight to the earliest deadline as soon as all n threads are
+ * asleep, which lets a session run as fast as the CPU allows.
+ *
+ * Waits on OS objects are cut into short host-time slices, and a sleeper checks its ClockSignal
+ * after each one. Both cost real time, which only matters in tests.
+ **/
+class SimulatedClock : public IClock {
+ public:
+  explicit SimulatedClock(DriverTimePoint start = DriverTimePoint());
+
+  DriverTimePoint Now() override;
+  void SleepUntil(DriverTimePoint deadline) override;
+  bool SleepUntil(DriverTimePoint deadline, ClockSignal& cancel) override;
+  DriverDuration MaxHostWait(DriverDuration remaining) override;
+
+  void AdvanceBy(DriverDuration duration);
+  void AdvanceTo(DriverTimePoint time);
+
+  // Jump to the earliest pending wake-up. Returns false if no thread is sleeping.
+  bool AdvanceToNextWakeup();
+
+  // Number of threads that must be asleep before time advances by itself. 0 disables auto-advance.
+  void SetParticipants(int participants);
+
+  size_t SleepingCount();
+
+ private:
+  void AdvanceToLocked(DriverTimePoint time);
+  void MaybeAutoAdvanceLocked();
+
+  std::atomic<int64_t> m_nowNs;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+  std::multiset<DriverTimePoint> m_deadlines;
+  int m_participants = 0;
+};
+
+/**
+ * Drift-free fixed-rate scheduling on top of a clock. Wait() sleeps until the next tick; if the
+ * caller fell behind by more than one period the schedule is re-based instead of bursting.
+ **/
+class Ticker {
+ public:
+  Ticker(IClock& clock, DriverDuration period);
+
+  void Wait();
+  void SetPeriod(DriverDuration period);
+
+  DriverTimePoint NextTick() const { return m_nextTick; }
+
+ private:
+  IClock& m_clock;
+  DriverDuration m_period;
+  DriverTimePoint m_nextTick;
+};
+
+IClock& DriverClock();
+
+// Replace the driver-wide clock. Must be called before any thread that uses the clock is started.
+void SetDriverClock(std::unique_ptr<IClock> clock);
+
+inline double ToSeconds(DriverDuration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+inline DriverDuration FromMilliseconds(float milliseconds) {
+  return std::chrono::duration_cast<DriverDuration>(
+      std::chrono::duration<float, std::milli>(milliseconds));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <asio.hpp>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include "Clock.h"
+#include "Communication/FrameBuffer.h"
+#include "DriverTimer.h"
+
+/**
+ * Coroutine building blocks for multi-step transport setup (connect, probe, handshake) on the io
+ * reactor. A sequence of steps reads top to bottom like the blocking version, but suspends instead
+ * of holding a thread, so any number of devices can be working through their setup on one executor.
+ *
+ * Failures and timeouts are thrown as asio::system_error, the same way use_awaitable reports them.
+ **/
+
+/**
+ * Cancels the stream's pending operations if it is still in scope when the timeout runs out, so the
+ * awaited operation completes with operation_aborted, which Check() reports as timed_out.
+ **/
+template <typename Stream>
+class StreamDeadline {
+ public:
+  StreamDeadline(Stream& stream, DriverDuration timeout)
+      : m_timer(stream.get_executor()), m_state(std::make_shared<State>()) {
+    m_timer.expires_after(timeout);
+    m_timer.async_wait([&stream, state = m_state](const asio::error_code& ec) {
+      // the handler can already be queued when the deadline goes out of scope
+      if (ec || state->done) return;
+
+      state->expired = true;
+      asio::error_code ignored;
+      stream.cancel(ignored);
+    });
+  }
+
+  ~StreamDeadline() {
+    m_state->done = true;
+    m_timer.cancel();
+  }
+
+  void Check(const asio::error_code& ec) const {
+    if (m_state->expired) throw asio::system_error(asio::error::timed_out);
+    if (ec) throw asio::system_error(ec);
+  }
+
+ private:
+  struct State {
+    bool expired = false;
+    bool done = false;
+  };
+
+  DriverTimer m_timer;
+  std::shared_ptr<State> m_state;
+};
+
+inline asio::awaitable<void> AsyncSleep(DriverTimer& timer, DriverDuration duration) {
+  timer.expires_after(duration);
+  co_await timer.async_wait(asio::use_awaitable);
+}
+
+// Runs a call that has no async form (device inquiry, opening a port) on the pool and resumes the
+// caller on its own executor with the result.
+template <typename Fn>
+asio::awaitable<std::invoke_result_t<Fn>> RunBlocking(asio::thread_pool& pool, Fn fn) {
+  using Result = std::invoke_result_t<Fn>;
+
+  co_return co_await asio::co_spawn(
+      pool, [fn = std::move(fn)]() -> asio::awaitable<Result> { co_return fn(); },
+      asio::use_awaitable);
+}
+
+template <typename Socket>
+asio::awaitable<void> AsyncConnect(Socket& socket, const typename Socket::endpoint_type& endpoint,
+                                   DriverDuration timeout) {
+  StreamDeadline<Socket> deadline(socket, timeout);
+
+  asio::error_code ec;
+  co_await socket.async_connect(endpoint, asio::redirect_error(asio::use_awaitable, ec));
+  deadline.Check(ec);
+}
+
+template <typename Stream>
+asio::awaitable<void> AsyncWriteAll(Stream& stream, std::string_view data, DriverDuration timeout) {
+  StreamDeadline<Stream> deadline(stream, timeout);
+
+  asio::error_code ec;
+  co_await asio::async_write(stream, asio::buffer(data),
+                             asio::redirect_error(asio::use_awaitable, ec));
+  deadline.Check(ec);
+}
+
+// Reads until frameBuffer holds a complete frame and returns it. The view is valid until the next
+// read through the same buffer.
+template <typename Stream>
+asio::awaitable<std::string_view> AsyncReadFrame(Stream& stream, FrameBuffer& frameBuffer,
+                                                 DriverDuration timeout) {
+  StreamDeadline<Stream> deadline(stream, timeout);
+
+  asio::error_code ec;
+  std::string_view frame;
+  while (!frameBuffer.NextFrame(frame)) {
+    const size_t bytesRead = co_await stream.async_read_some(
+        asio::buffer(frameBuffer.WritePtr(), frameBuffer.WritableBytes()),
+        asio::redirect_error(asio::use_awaitable, ec));
+    deadline.Check(ec);
+
+    frameBuffer.Commit(bytesRead);
+  }
+
+  co_return frame;
+}
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "CommunicationManager.h"
+#include "Communication/AsyncTransport.h"
+#include "Communication/FrameBuffer.h"
+#include "Communication/FramePipeline.h"
+#include "Communication/IoReactor.h"
+#include "Communication/TransportWaiter.h"
 #include "DeviceConfiguration.h"
+#include "StopEvent.h"
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -18,27 +24,62 @@
 #define ARDUINO_WAIT_TIME 1000
 class BTSerialCommunicationManager : public ICommunicationManager {
 public:
-	BTSerialCommunicationManager(const VRBTSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager);
-	//connect to the device using serial
+	//if ioReactor is set the socket is read asynchronously on the reactor instead of on a listener thread
+	BTSerialCommunicationManager(const VRBTSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager, IoReactor* ioReactor = nullptr);
+	~BTSerialCommunicationManager();
+	//connect to the device using serial. With a reactor this only starts connecting, the reactor keeps
+	//retrying in the background until Disconnect()
 	void Connect();
 	//start a thread that listens for updates from the device and calls the callback with data
-	void BeginListener(const std::function<void(VRCommData_t)>& callback);
-	//returns if connected or not
+	void BeginListener(const std::function<void(const PackedSample&)>& callback);
+	//returns if connected or not. With a reactor this is true from Connect() on, a listener begun before
+	//the socket is up starts reading once it is
 	bool IsConnected();
 	//close the serial port
 	void Disconnect();
 private:
-    void ListenerThread(const std::function<void(VRCommData_t)>& callback);
-    bool ReceiveNextPacket(std::string &buff);
+    void ListenerThread(const std::function<void(const PackedSample&)>& callback);
+    //wakes the listener from whatever it is waiting on and joins it
+    void StopListener();
+    //reads on this thread and decodes on a second one, handing frames over through m_pipeline
+    void PipelinedListen(const std::function<void(const PackedSample&)>& callback);
+    void DecodeFrame(std::string_view frame, const std::function<void(const PackedSample&)>& callback);
+    //the frame points into m_frameBuffer and is valid until the next call
+    bool ReceiveNextPacket(std::string_view& frame);
+    //waits for data, then reads up to room bytes of whatever has arrived
+    bool ReadAvailable(char* buffer, size_t room, int& bytesRead);
     bool PurgeBuffer();
+    //>0 if the socket has bytes to read, 0 if not, <0 on error
+    int PollBytesAvailable();
+    bool WaitForBytes(DriverDuration timeout);
+
+    //reactor mode, these all run on the reactor thread
+    void BeginAsyncListener();
+    void OnAsyncFrame(std::string_view frame);
+    void OnAsyncError(const asio::error_code& ec);
+    void CloseAsync();
+    //finds the device off the reactor, then connects the socket without blocking it
+    asio::awaitable<bool> ConnectAsync();
+    //keeps trying until connected or stopped, then starts the listener if it has a callback
+    void StartConnecting(bool backOffFirst);
+    asio::awaitable<void> ConnectAndListenAsync(bool backOffFirst);
 	bool getPairedEsp32BtAddress();
 	bool startupWindowsSocket();
 	bool connectToEsp32();
+	//closes the listener thread mode socket if there is one, the next connect opens a new one
+	void closeEsp32Socket();
 	bool sendMessageToEsp32();
 
-	bool m_isConnected;
+	std::atomic<bool> m_isConnected;
+	//reactor mode, set between Connect() and Disconnect()
+	std::atomic<bool> m_connecting = false;
+	bool m_winsockStarted = false;
 	std::atomic<bool> m_threadActive;
 	std::thread m_serialThread;
+	//set to make the listener return from any wait
+	StopEvent m_stopEvent;
+	//signalled by the socket when data arrives or the connection closes, listener thread mode only
+	WSAEVENT m_readEvent = WSA_INVALID_EVENT;
 
 	std::unique_ptr<IEncodingManager> m_encodingManager;
 
@@ -46,8 +87,25 @@ private:
 
 	BTH_ADDR m_esp32BtAddress;
 	SOCKADDR_BTH m_btSocketAddress;
-	SOCKET m_btClientSocket;
+	SOCKET m_btClientSocket = INVALID_SOCKET;
 	WCHAR* m_wcDeviceName;
 	//std::unique_ptr<WCHAR*> m_wcDeviceName;
 
+	TransportWaiter m_waiter;
+	FrameBuffer m_frameBuffer;
+	//only set when the pipelined listener is on
+	std::unique_ptr<FramePipeline> m_pipeline;
+
+	IoReactor* m_ioReactor;
+	std::unique_ptr<asio::generic::stream_protocol::socket> m_socket;
+	std::shared_ptr<AsyncFrameReader<asio::generic::stream_protocol::socket>> m_asyncReader;
+	std::unique_ptr<DriverTimer> m_reconnectTimer;
+	ReconnectBackoff m_reconnectBackoff;
+	bool m_asyncStopped = false;
+	bool m_connectInFlight = false;
+	std::function<void(const PackedSample&)> m_callback;
+
+	//stamped on every packet handed to the callback, only touched by whichever thread decodes
+	uint32_t m_sequence = 0;
+
 };
\ No newline at end of file
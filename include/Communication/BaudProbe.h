@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Communication/FrameBuffer.h"
+
+// Tried in order when the serial baud rate is set to 0.
+static constexpr uint32_t c_autoBaudRates[] = {115200, 230400, 460800, 500000, 921600, 1000000,
+                                               2000000};
+// Clean frames in a row that settle a rate.
+static constexpr int c_baudProbeFrames = 3;
+
+/**
+ * Decides whether a serial port is open at the rate the glove sends at, from what it receives.
+ *
+ * At the wrong rate bytes come through as framing errors and non-printable noise, with the odd
+ * newline. Only a run of printable frames on a clean line counts as a match. The first frame is
+ * never counted, as the buffer purge before probing can land in the middle of one.
+ *
+ * The port reads into WritePtr() and reports each read with Commit(), and any framing, parity or
+ * break error the driver saw since the last read with OnLineError().
+ **/
+class BaudProbe {
+ public:
+  explicit BaudProbe(int framesNeeded = c_baudProbeFrames) : m_framesNeeded(framesNeeded) {}
+
+  char* WritePtr() { return m_frameBuffer.WritePtr(); }
+  size_t WritableBytes() const { return m_frameBuffer.WritableBytes(); }
+
+  // Mark bytes written to WritePtr() as received. Returns true once the rate is a match.
+  bool Commit(size_t bytes);
+
+  void OnLineError() { m_cleanFrames = 0; }
+
+  bool Matched() const { return m_cleanFrames >= m_framesNeeded; }
+
+ private:
+  FrameBuffer m_frameBuffer;
+  int m_framesNeeded;
+  int m_cleanFrames = 0;
+  bool m_skippedFirst = false;
+};
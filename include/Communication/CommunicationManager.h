@@ -2,11 +2,14 @@
 #include <functional>
 #include <memory>
 #include "Encode/EncodingManager.h"
+#include "Encode/PackedSample.h"
 
 class ICommunicationManager {
 public:
+	//stops any listener thread that is still running
+	virtual ~ICommunicationManager() = default;
 	virtual void Connect() = 0;
-	virtual void BeginListener(const std::function<void(VRCommData_t)>& callback) = 0;
+	virtual void BeginListener(const std::function<void(const PackedSample&)>& callback) = 0;
 	virtual bool IsConnected() = 0;
 	virtual void Disconnect() = 0;
 private:
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "CacheLine.h"
+
+// Longest frame a transport hands on, terminator included. Anything longer is dropped as corrupt.
+static constexpr size_t c_maxFrameSize = 1024;
+
+/**
+ * Fixed-size receive buffer that transports read into directly, in as large chunks as the OS has
+ * ready, and that hands out '\n' terminated frames as views into the same memory.
+ *
+ * Bytes are copied at most once (when the unread tail is moved back to the front) instead of the
+ * one syscall and one string append per byte the listeners used to do.
+ *
+ * Frames longer than maxFrameSize are never handed out. As soon as a partial frame grows past the
+ * limit its bytes are dropped and everything up to the next terminator is skipped, so a link that
+ * stops sending terminators costs a bounded amount of memory and one scan per byte.
+ *
+ * The bytes and the positions are both written on every read, so each sits on cache lines of its
+ * own rather than next to whatever the other hand's transport thread is writing.
+ **/
+class alignas(c_cacheLineSize) FrameBuffer {
+ public:
+  explicit FrameBuffer(size_t capacity = 4096, size_t maxFrameSize = c_maxFrameSize);
+
+  // Where the next read should land, and how much room there is.
+  char* WritePtr() { return m_buffer.Data() + m_writePos; }
+  size_t WritableBytes() const { return m_buffer.Size() - m_writePos; }
+
+  // Mark bytes written to WritePtr() as received.
+  void Commit(size_t bytes);
+
+  // Returns true and the next frame (terminator included) if a complete one is buffered. The view is
+  // valid until the next call to Commit() or NextFrame().
+  bool NextFrame(std::string_view& frame);
+
+  // Hands out up to maxFrames complete frames at once, for decoding as a batch. They stay valid
+  // until the next call to Commit(), NextFrame() or NextFrames(). Call again until it returns 0
+  // before reading more, as NextFrame() until it returns false.
+  size_t NextFrames(std::string_view* frames, size_t maxFrames);
+
+  void Clear();
+
+  uint64_t DroppedBytes() const { return m_droppedBytes; }
+  // Frames thrown away for being longer than maxFrameSize.
+  uint64_t OversizedFrames() const { return m_oversizedFrames; }
+
+ private:
+  // NextFrame() without the compaction, which would move bytes under frames already handed out
+  bool ScanFrame(std::string_view& frame);
+  void Compact();
+  void DropPending();
+
+  CacheAlignedBuffer m_buffer;
+  size_t m_maxFrameSize;
+  size_t m_readPos = 0;
+  // everything in [m_readPos, m_scanPos) is known not to contain a terminator
+  size_t m_scanPos = 0;
+  size_t m_writePos = 0;
+
+  // skipping the rest of an oversized frame, up to and including its terminator
+  bool m_discarding = false;
+
+  uint64_t m_droppedBytes = 0;
+  uint64_t m_oversizedFrames = 0;
+};
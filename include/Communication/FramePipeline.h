@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "Communication/FrameBuffer.h"
+#include "DeviceConfiguration.h"
+#include "SpscRing.h"
+
+struct FramePipelineStats {
+  std::atomic<uint64_t> framesPublished{0};
+  // frames lost to the DROP policy or for being longer than the frame limit
+  std::atomic<uint64_t> framesDropped{0};
+  std::atomic<uint64_t> bytesDropped{0};
+  // times the reader had to wait for the decoder under the BLOCK policy
+  std::atomic<uint64_t> readerStalls{0};
+  // most bytes ever held in the ring, published or not
+  std::atomic<size_t> highWaterBytes{0};
+};
+
+/**
+ * Hands '\n' terminated frames from a reader thread to a decode thread without copying them. The
+ * reader reads straight into a byte ring and publishes a descriptor per complete frame; the decoder
+ * gets each frame as a view into the ring and releases it once done, which frees its bytes.
+ *
+ * Frames are always contiguous. When the ring wraps in the middle of a frame, the bytes received so
+ * far are moved to the front of the ring, so at most one partial frame is copied per lap.
+ *
+ * When the decoder falls behind and the ring fills, the policy decides whether the reader waits
+ * (BLOCK, the OS queue takes up the slack) or keeps reading and throws away what does not fit
+ * (DROP, so the link is never stalled).
+ **/
+class FramePipeline {
+ public:
+  FramePipeline(size_t capacity, VRBackpressurePolicy policy, size_t maxFrameSize = c_maxFrameSize);
+
+  // Reader side. Returns where the next read should land and sets room to how much fits, waiting
+  // for space under the BLOCK policy. Returns nullptr once Stop() has been called.
+  char* PrepareWrite(size_t& room);
+  // Mark bytes written to the last PrepareWrite() pointer as received and publish any frames they
+  // complete.
+  void Commit(size_t bytes);
+
+  // Decoder side. Waits for the next frame. The view stays valid until Release(). Returns false
+  // once Stop() has been called.
+  bool NextFrame(std::string_view& frame);
+  void Release();
+
+  // Wakes both sides. Safe to call from any thread.
+  void Stop();
+
+  size_t Capacity() const { return m_mask + 1; }
+  const FramePipelineStats& Stats() const { return m_stats; }
+
+ private:
+  struct FrameSlice {
+    size_t start;
+    size_t length;
+    // no frame to hand out, only frees the dropped bytes before start
+    bool skip;
+  };
+
+  size_t FreeBytes() const {
+    return Capacity() - (m_writePos - m_readPos.load(std::memory_order_acquire));
+  }
+  bool TryPublish(const FrameSlice& slice);
+  void FlushSkipped();
+  void WaitForRelease(uint32_t seen);
+  void DropPartial();
+
+  size_t m_mask;
+  size_t m_maxFrameSize;
+  VRBackpressurePolicy m_policy;
+  CacheAlignedBuffer m_data;
+
+  SpscRing<FrameSlice> m_frames;
+
+  // reader only, absolute positions that are masked to index the ring
+  size_t m_writePos = 0;
+  size_t m_frameStart = 0;
+  size_t m_scanPos = 0;
+  // everything before m_frameStart that no published slice covers yet was dropped
+  size_t m_publishedEnd = 0;
+  bool m_discarding = false;
+  // reads go here instead of the ring while the DROP policy is throwing data away
+  CacheAlignedBuffer m_scratch;
+  bool m_writingScratch = false;
+
+  // decoder only
+  size_t m_releaseTo = 0;
+
+  alignas(c_cacheLineSize) std::atomic<size_t> m_readPos{0};
+  std::atomic<uint32_t> m_releases{0};
+  std::atomic<bool> m_readerWaiting{false};
+
+  alignas(c_cacheLineSize) std::atomic<uint32_t> m_published{0};
+  std::atomic<bool> m_decoderWaiting{false};
+
+  std::atomic<bool> m_stopped{false};
+
+  FramePipelineStats m_stats;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include "Clock.h"
+#include "Communication/FrameBuffer.h"
+#include "DriverTimer.h"
+
+/**
+ * One io_context and one thread servicing the transports of every device. Communication managers
+ * created with a reactor issue async reads and keep their timers here instead of each running a
+ * blocking listener thread. Calls that can only block (device inquiry, opening ports) are handed to a
+ * small pool so they never stall the reactor.
+ **/
+class IoReactor {
+ public:
+  IoReactor();
+  ~IoReactor();
+
+  void Start();
+  // Joins the reactor thread, then waits for the blocking pool to drain. Handlers still queued are
+  // never run, so once this returns nothing on either will call into a transport again.
+  void Stop();
+
+  asio::io_context& Context() { return m_context; }
+  asio::thread_pool& BlockingPool() { return m_blockingPool; }
+
+  // Run fn on the reactor thread and wait for it to finish. Runs inline if already on that thread,
+  // or if the reactor isn't running.
+  void RunSync(const std::function<void()>& fn);
+
+ private:
+  asio::io_context m_context;
+  asio::executor_work_guard<asio::io_context::executor_type> m_workGuard;
+  std::thread m_thread;
+
+  asio::thread_pool m_blockingPool{2};
+};
+
+/**
+ * Keeps an async read outstanding on a stream (serial port or socket), splits what arrives into
+ * frames and passes each one to onFrame. Reports read errors, and silence longer than the watchdog
+ * timeout, to onError once; after that the reader is finished and a new one has to be started.
+ *
+ * Must be created, started and stopped on the reactor thread.
+ **/
+template <typename Stream>
+class AsyncFrameReader : public std::enable_shared_from_this<AsyncFrameReader<Stream>> {
+ public:
+  using FrameHandler = std::function<void(std::string_view)>;
+  using ErrorHandler = std::function<void(const asio::error_code&)>;
+
+  AsyncFrameReader(Stream& stream, FrameBuffer& frameBuffer, DriverDuration watchdogTimeout,
+                   FrameHandler onFrame, ErrorHandler onError)
+      : m_stream(stream),
+        m_frameBuffer(frameBuffer),
+        m_watchdog(stream.get_executor()),
+        m_watchdogTimeout(watchdogTimeout),
+        m_onFrame(std::move(onFrame)),
+        m_onError(std::move(onError)) {}
+
+  void Start(DriverDuration initialDelay) {
+    m_frameBuffer.Clear();
+    m_lastFrame = DriverClock().Now() + initialDelay;
+
+    // the watchdog doubles as the start-up delay
+    m_watchdog.expires_after(initialDelay);
+    m_watchdog.async_wait([self = this->shared_from_this()](const asio::error_code& ec) {
+      if (ec || self->m_stopped) return;
+
+      self->ArmWatchdog();
+      self->ReadSome();
+    });
+  }
+
+  void Stop() {
+    m_stopped = true;
+    m_watchdog.cancel();
+  }
+
+ private:
+  void ReadSome() {
+    m_stream.async_read_some(
+        asio::buffer(m_frameBuffer.WritePtr(), m_frameBuffer.WritableBytes()),
+        [self = this->shared_from_this()](const asio::error_code& ec, size_t bytesRead) {
+          if (self->m_stopped) return;
+          if (ec) {
+            self->Fail(ec);
+            return;
+          }
+
+          self->m_frameBuffer.Commit(bytesRead);
+
+          std::string_view frame;
+          while (self->m_frameBuffer.NextFrame(frame)) {
+            self->m_lastFrame = DriverClock().Now();
+            self->m_onFrame(frame);
+          }
+
+          self->ReadSome();
+        });
+  }
+
+  void ArmWatchdog() {
+    m_watchdog.expires_after(m_watchdogTimeout);
+    m_watchdog.async_wait([self = this->shared_from_this()](const asio::error_code& ec) {
+      if (ec || self->m_stopped) return;
+
+      if (DriverClock().Now() - self->m_lastFrame >= self->m_watchdogTimeout) {
+        self->Fail(asio::error::timed_out);
+        return;
+      }
+      self->ArmWatchdog();
+    });
+  }
+
+  void Fail(const asio::error_code& ec) {
+    Stop();
+    m_onError(ec);
+  }
+
+  Stream& m_stream;
+  FrameBuffer& m_frameBuffer;
+  DriverTimer m_watchdog;
+  DriverDuration m_watchdogTimeout;
+  DriverTimePoint m_lastFrame;
+
+  FrameHandler m_onFrame;
+  ErrorHandler m_onError;
+
+  bool m_stopped = false;
+};
+
+/**
+ * Exponential backoff between reconnect attempts, reset once a connection succeeds.
+ **/
+class ReconnectBackoff {
+ public:
+  DriverDuration Next();
+  void Reset() { m_delay = DriverDuration::zero(); }
+
+ private:
+  DriverDuration m_delay = DriverDuration::zero();
+};
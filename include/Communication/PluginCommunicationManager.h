@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Communication/CommunicationManager.h"
+#include "Communication/FrameBuffer.h"
+#include "Plugin/OpenglovePlugin.h"
+
+/**
+ * Reads from a transport plugin on a listener thread. Each read goes straight into the frame
+ * buffer, and every frame it completes is decoded in one DecodeBatch() call, so a plugin codec
+ * sees one call per read rather than one per packet.
+ **/
+class PluginCommunicationManager : public ICommunicationManager {
+ public:
+  // transport belongs to a library in the PluginRegistry, which has to outlive this
+  PluginCommunicationManager(const OpengloveTransportApi* transport, std::string config,
+                             std::unique_ptr<IEncodingManager> encodingManager);
+  ~PluginCommunicationManager();
+
+  void Connect() override;
+  void BeginListener(const std::function<void(const PackedSample&)>& callback) override;
+  bool IsConnected() override;
+  void Disconnect() override;
+
+ private:
+  void ListenerThread(const std::function<void(const PackedSample&)>& callback);
+  void StopListener();
+
+  const OpengloveTransportApi* m_transport;
+  std::string m_config;
+  std::unique_ptr<IEncodingManager> m_encodingManager;
+
+  void* m_instance = nullptr;
+  bool m_isConnected = false;
+
+  std::atomic<bool> m_threadActive{false};
+  std::thread m_thread;
+
+  // only touched by the listener thread
+  FrameBuffer m_frameBuffer;
+  uint32_t m_sequence = 0;
+};
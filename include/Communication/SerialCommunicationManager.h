@@ -1,7 +1,13 @@
 #pragma once
 
 #include "CommunicationManager.h"
+#include "Communication/AsyncTransport.h"
+#include "Communication/FrameBuffer.h"
+#include "Communication/FramePipeline.h"
+#include "Communication/IoReactor.h"
+#include "Communication/TransportWaiter.h"
 #include "DeviceConfiguration.h"
+#include "StopEvent.h"
 #include <windows.h>
 #include <iostream>
 #include <memory>
@@ -13,31 +19,88 @@
 
 class SerialCommunicationManager : public ICommunicationManager {
 public:
-	SerialCommunicationManager(const VRSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager) : m_serialConfiguration(configuration), m_encodingManager(std::move(encodingManager)), m_isConnected(false), m_hSerial(0), m_errors(0) {};
+	//if ioReactor is set the port is read asynchronously on the reactor instead of on a listener thread
+	SerialCommunicationManager(const VRSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager, IoReactor* ioReactor = nullptr);
+	~SerialCommunicationManager();
 	//connect to the device using serial
 	void Connect();
 	//start a thread that listens for updates from the device and calls the callback with data
-	void BeginListener(const std::function<void(VRCommData_t)>& callback);
+	void BeginListener(const std::function<void(const PackedSample&)>& callback);
 	//returns if connected or not
 	bool IsConnected();
 	//close the serial port
 	void Disconnect();
 private:
-    void ListenerThread(const std::function<void(VRCommData_t)>& callback);
-    bool ReceiveNextPacket(std::string &buff);
-    bool PurgeBuffer();
+    void ListenerThread(const std::function<void(const PackedSample&)>& callback);
+    //wakes the listener from whatever it is waiting on and joins it
+    void StopListener();
+    //reads on this thread and decodes on a second one, handing frames over through m_pipeline
+    void PipelinedListen(const std::function<void(const PackedSample&)>& callback);
+    void DecodeFrame(std::string_view frame, const std::function<void(const PackedSample&)>& callback);
+    //the frame points into m_frameBuffer and is valid until the next call
+    bool ReceiveNextPacket(std::string_view& frame);
+    //waits for data, then reads up to room bytes of whatever the driver has queued
+    bool ReadAvailable(char* buffer, size_t room, DWORD& bytesRead);
+    bool PurgeBuffer(HANDLE port);
+    //>0 if there are bytes waiting in the driver queue, 0 if not, <0 on error
+    int PollBytesAvailable(HANDLE port);
+    bool WaitForBytes(DriverDuration timeout);
 
-	bool m_isConnected;
+    //opens and configures the port, returns INVALID_HANDLE_VALUE if that failed. Only uses the handle
+    //it returns, so the reactor can run it on the blocking pool while m_hSerial stays its own
+    HANDLE OpenPort();
+    //applies the baud rate, queue sizes and timeouts to the open port
+    bool ConfigurePort(HANDLE port, DWORD baudRate);
+    //listens at each supported rate until one carries clean frames. Returns 0 if none did
+    DWORD DetectBaudRate(HANDLE port);
+    bool ProbeBaudRate(HANDLE port, DWORD baudRate);
+    //reads bytes the driver already has queued
+    bool ReadQueued(HANDLE port, char* buffer, DWORD bytes, DWORD& bytesRead);
+
+    //reactor mode, these all run on the reactor thread
+    void BeginAsyncListener();
+    void OnAsyncFrame(std::string_view frame);
+    void OnAsyncError(const asio::error_code& ec);
+    void CloseAsync();
+    asio::awaitable<void> ReconnectAsync();
+
+	//read from other threads through IsConnected()
+	std::atomic<bool> m_isConnected;
 	//Serial comm handler
 	HANDLE m_hSerial;
 	//Connection information
 	COMSTAT m_status;
 	//Error tracking
 	DWORD m_errors;
+	//deepest the driver receive queue has been, and how many polls found overrun or framing errors
+	DWORD m_queueHighWater = 0;
+	uint64_t m_lineErrors = 0;
+	//rate the port was last opened at, detection tries it first when reconnecting
+	DWORD m_baudRate = 0;
 	std::atomic<bool> m_threadActive;
 	std::thread m_serialThread;
+	//set to make the listener return from any wait
+	StopEvent m_stopEvent;
+	//completion event for overlapped reads and comm waits, only used by the thread doing blocking io on the port
+	HANDLE m_ioEvent;
 
 	VRSerialConfiguration_t m_serialConfiguration;
 
 	std::unique_ptr<IEncodingManager> m_encodingManager;
+
+	TransportWaiter m_waiter;
+	FrameBuffer m_frameBuffer;
+	//only set when the pipelined listener is on
+	std::unique_ptr<FramePipeline> m_pipeline;
+
+	IoReactor* m_ioReactor;
+	std::unique_ptr<asio::serial_port> m_serialPort;
+	std::shared_ptr<AsyncFrameReader<asio::serial_port>> m_asyncReader;
+	std::unique_ptr<DriverTimer> m_reconnectTimer;
+	ReconnectBackoff m_reconnectBackoff;
+	std::atomic<bool> m_asyncStopped{false};
+	std::function<void(const PackedSample&)> m_callback;
+
+	//stamped on every packet handed to the callback, only touched by whichever thread decodes
+	uint32_t m_sequence = 0;
 };
\ No newline at end of file
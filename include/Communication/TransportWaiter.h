@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "Clock.h"
+#include "DeviceConfiguration.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+inline void CpuRelax() { _mm_pause(); }
+#else
+inline void CpuRelax() { std::this_thread::yield(); }
+#endif
+
+struct TransportWaitStats {
+  std::atomic<uint64_t> waits{0};
+  // data was picked up while spinning, without going through the OS
+  std::atomic<uint64_t> spinHits{0};
+  std::atomic<uint64_t> blocks{0};
+  std::atomic<int64_t> spinTimeNs{0};
+};
+
+/**
+ * Decides how a listener thread waits for the next bytes from its transport.
+ *
+ * BLOCKING parks the thread in the OS until data arrives. BUSY_POLL never sleeps and burns a core for
+ * the lowest wake-up latency. ADAPTIVE_SPIN learns the packet inter-arrival time, blocks until shortly
+ * before the next packet is due and spins across the window where it is expected to land.
+ *
+ * Transports provide two callables:
+ *   int poll()                   >0 data ready, 0 nothing yet, <0 error. Must not block.
+ *   bool block(DriverDuration t) wait at most t for data, DriverDuration::max() for no limit.
+ *                                Returns false on error.
+ **/
+class TransportWaiter {
+ public:
+  TransportWaiter(VRWaitStrategy strategy, const std::atomic<bool>& active)
+      : m_strategy(strategy), m_active(active) {}
+
+  template <typename Poll, typename Block>
+  bool Wait(Poll&& poll, Block&& block) {
+    m_stats.waits++;
+
+    const int ready = poll();
+    if (ready != 0) return ready > 0;
+
+    switch (m_strategy) {
+      case VRWaitStrategy::BUSY_POLL:
+        return Spin(poll, DriverDuration::max());
+
+      case VRWaitStrategy::ADAPTIVE_SPIN: {
+        if (m_intervalNs == 0) break;
+
+        const DriverDuration window = SpinWindow();
+        const DriverDuration untilExpected =
+            m_lastArrival + DriverDuration(m_intervalNs) - DriverClock().Now();
+
+        if (untilExpected > window && !block(untilExpected - window)) return false;
+
+        const int result = Spin(poll, 2 * window);
+        if (result != 0) return result > 0;
+        break;
+      }
+
+      default:
+        break;
+    }
+
+    m_stats.blocks++;
+    return block(DriverDuration::max());
+  }
+
+  // Call once for every read that returned bytes, however many frames it held, to update the
+  // arrival model. Frames after the first in a read would only add intervals of a few ns.
+  void OnArrival();
+
+  DriverDuration SpinWindow() const;
+
+  const TransportWaitStats& Stats() const { return m_stats; }
+
+ private:
+  // Returns the result of the last poll, 0 if the time limit ran out.
+  template <typename Poll>
+  int Spin(Poll& poll, DriverDuration limit) {
+    const DriverTimePoint start = DriverClock().Now();
+    const DriverTimePoint end = limit == DriverDuration::max() ? DriverTimePoint::max() : start + limit;
+
+    int result = 0;
+    while (m_active) {
+      result = poll();
+      if (result != 0) break;
+      if (DriverClock().Now() >= end) break;
+      CpuRelax();
+    }
+
+    if (result > 0) m_stats.spinHits++;
+    m_stats.spinTimeNs += (DriverClock().Now() - start).count();
+
+    if (result == 0 && !m_active) return -1;
+    return result;
+  }
+
+  VRWaitStrategy m_strategy;
+  const std::atomic<bool>& m_active;
+
+  DriverTimePoint m_lastArrival;
+  int64_t m_intervalNs = 0;
+  int64_t m_deviationNs = 0;
+
+  TransportWaitStats m_stats;
+};
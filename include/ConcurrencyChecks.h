@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Contract checks for the lock-free primitives (SpscRing, SeqLock, SampleHistory and what is built
+ * on them). Compiled in when OPENGLOVE_CHECK_CONCURRENCY is defined, which the CMake options of the
+ * same name and OPENGLOVE_SANITIZE do for everything linking the core library. A primitive used
+ * outside its contract, such as two producers on a single producer ring, overlapping seqlock
+ * stores or history appended out of order, then stops the driver where it happens instead of
+ * showing up much later as a torn or lost value. Without the define the checks cost nothing.
+ **/
+
+#if defined(__SANITIZE_THREAD__)
+#define OPENGLOVE_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define OPENGLOVE_TSAN 1
+#endif
+#endif
+
+// Logs where and why, then aborts.
+[[noreturn]] void ConcurrencyCheckFailed(const char* message, const char* file, int line);
+
+/**
+ * Marks one side of a primitive that only one thread may be in at a time. The side can move to
+ * another thread, as a listener does when it reconnects, as long as the two never overlap.
+ **/
+class ExclusiveSection {
+ public:
+  class Scope {
+   public:
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+    Scope(ExclusiveSection& section, const char* message, const char* file, int line)
+        : m_section(section) {
+      if (m_section.m_busy.exchange(true, std::memory_order_acquire))
+        ConcurrencyCheckFailed(message, file, line);
+    }
+    ~Scope() { m_section.m_busy.store(false, std::memory_order_release); }
+
+   private:
+    ExclusiveSection& m_section;
+#else
+    Scope(ExclusiveSection&, const char*, const char*, int) {}
+#endif
+  };
+
+ private:
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+  std::atomic<bool> m_busy{false};
+#endif
+};
+
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+#define OPENGLOVE_CHECK(condition, message) \
+  ((condition) ? void() : ConcurrencyCheckFailed(message, __FILE__, __LINE__))
+#else
+#define OPENGLOVE_CHECK(condition, message) void()
+#endif
+
+// Holds section until the end of the enclosing block.
+#define OPENGLOVE_EXCLUSIVE(section, message) \
+  ExclusiveSection::Scope exclusiveScope_(section, message, __FILE__, __LINE__)
+
+/**
+ * memcpy for data guarded by a sequence number, on either side. The copy races with the writer by
+ * design and the sequence check throws away a torn result. ThreadSanitizer cannot see that, so
+ * under it the bytes are copied with relaxed atomics, which race without being undefined.
+ **/
+inline void CopyShared(void* to, const void* from, size_t size) {
+#if defined(OPENGLOVE_TSAN)
+  auto* out = static_cast<unsigned char*>(to);
+  auto* in = static_cast<unsigned char*>(const_cast<void*>(from));
+  for (size_t i = 0; i < size; i++) {
+    const unsigned char byte =
+        std::atomic_ref<unsigned char>(in[i]).load(std::memory_order_relaxed);
+    std::atomic_ref<unsigned char>(out[i]).store(byte, std::memory_order_relaxed);
+  }
+#else
+  std::memcpy(to, from, size);
+#endif
+}
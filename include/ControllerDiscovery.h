@@ -6,6 +6,7 @@
 #include <functional>
 #include <thread>
 
+#include "StopEvent.h"
 #include "openvr_driver.h"
 
 struct ControllerPipeData {
@@ -37,6 +38,8 @@ class ControllerDiscoveryPipe {
   HANDLE m_hPipe;
 
   std::thread m_pipeThread;
+  // wakes the listener from its wait for a client
+  StopEvent m_stopEvent;
 
   std::atomic<bool> m_listenerActive;
   std::atomic<bool> m_clientConnected;
@@ -4,8 +4,12 @@
 #include "DeviceConfiguration.h"
 #include "ControllerDiscovery.h"
 #include "Calibration.h"
+#include "PoseBridge.h"
+#include "CacheLine.h"
 
-class ControllerPose {
+// UpdatePose writes the bridge every frame, aligned so the allocation never shares a line with the
+// other hand's state.
+class alignas(c_cacheLineSize) ControllerPose {
  public:
   ControllerPose(vr::ETrackedControllerRole shadowDeviceOfRole, std::string thisDeviceManufacturer,
                  VRPoseConfiguration_t poseConfiguration);
@@ -37,4 +41,6 @@ class ControllerPose {
 
   std::unique_ptr<ControllerDiscoveryPipe> m_controllerDiscoverer;
   std::unique_ptr<Calibration> m_calibration;
+
+  PoseBridge m_poseBridge;
 };
\ No newline at end of file
@@ -7,15 +7,34 @@
 
 static const char *c_driverSettingsSection = "driver_openglove";
 static const char *c_poseSettingsSection = "pose_settings";
+static const char *c_inputTuningSettingsSection = "input_tuning";
+static const char *c_pluginSettingsSection = "plugins";
+static const char *c_budgetSettingsSection = "budget";
 
 enum VRCommunicationProtocol {
 	SERIAL = 0,
 	BTSERIAL = 1,
+	//a transport from a plugin, named in the "plugins" settings section
+	PLUGIN_TRANSPORT = 2,
 };
 
 enum VREncodingProtocol {
     LEGACY = 0,
     ALPHA = 1,
+    //a codec from a plugin, named in the "plugins" settings section
+    PLUGIN_CODEC = 2,
+};
+
+enum VRWaitStrategy {
+    BLOCKING = 0,
+    ADAPTIVE_SPIN = 1,
+    BUSY_POLL = 2,
+};
+
+// What the reader does when the pipelined decoder falls behind and the frame ring is full
+enum VRBackpressurePolicy {
+    BACKPRESSURE_BLOCK = 0,
+    BACKPRESSURE_DROP = 1,
 };
 
 enum VRDeviceDriver {
@@ -23,43 +42,129 @@ enum VRDeviceDriver {
     EMULATED_KNUCKLES = 1,
 };
 
+struct VRPipelineConfiguration_t {
+    VRPipelineConfiguration_t(bool enabled = false, int ringSize = 65536, VRBackpressurePolicy backpressure = BACKPRESSURE_BLOCK) :
+            enabled(enabled), ringSize(ringSize), backpressure(backpressure) {};
+
+    // Read and decode on separate threads, handing frames over through a ring of ringSize bytes
+    bool enabled;
+    int ringSize;
+    VRBackpressurePolicy backpressure;
+};
+
 struct VRSerialConfiguration_t {
     std::string port;
+    VRWaitStrategy waitStrategy;
+    // 0 picks the rate by listening for clean frames at each supported rate in turn
+    int baudRate;
+    // size of the driver's receive queue, in bytes
+    int receiveBufferSize;
+    VRPipelineConfiguration_t pipeline;
 
-    VRSerialConfiguration_t(std::string port) : port(port) {};
+    VRSerialConfiguration_t(std::string port, VRWaitStrategy waitStrategy, int baudRate = 115200, int receiveBufferSize = 4096,
+                            VRPipelineConfiguration_t pipeline = VRPipelineConfiguration_t()) :
+            port(port), waitStrategy(waitStrategy), baudRate(baudRate), receiveBufferSize(receiveBufferSize), pipeline(pipeline) {};
 };
 
 struct VRBTSerialConfiguration_t {
 	std::string name;
+	VRWaitStrategy waitStrategy;
+	VRPipelineConfiguration_t pipeline;
 
-	VRBTSerialConfiguration_t(std::string name) : name(name) {};
+	VRBTSerialConfiguration_t(std::string name, VRWaitStrategy waitStrategy, VRPipelineConfiguration_t pipeline = VRPipelineConfiguration_t()) :
+		name(name), waitStrategy(waitStrategy), pipeline(pipeline) {};
 };
 
 struct VRPoseConfiguration_t {
     VRPoseConfiguration_t(vr::HmdVector3_t offsetVector, vr::HmdQuaternion_t angleOffsetQuaternion, float poseOffset,
-                          bool controllerOverrideEnabled, int controllerIdOverride) :
+                          bool controllerOverrideEnabled, int controllerIdOverride,
+                          float trackingLossBridgeMs = 0.f, float trackingLossBlendMs = 0.f) :
             offsetVector(offsetVector),
             angleOffsetQuaternion(angleOffsetQuaternion),
             poseOffset(poseOffset),
             controllerOverrideEnabled(controllerOverrideEnabled),
-            controllerIdOverride(controllerIdOverride) {};
+            controllerIdOverride(controllerIdOverride),
+            trackingLossBridgeMs(trackingLossBridgeMs),
+            trackingLossBlendMs(trackingLossBlendMs) {};
     vr::HmdVector3_t offsetVector;
     vr::HmdQuaternion_t angleOffsetQuaternion;
     float poseOffset;
     int controllerIdOverride;
     bool controllerOverrideEnabled;
+
+    // How long to dead reckon the pose after the shadowed controller loses tracking (0 disables),
+    // and how long to blend back once it is found again
+    float trackingLossBridgeMs;
+    float trackingLossBlendMs;
+};
+
+struct VRLateLatchConfiguration_t {
+    VRLateLatchConfiguration_t(bool enabled, float marginMs) : enabled(enabled), marginMs(marginMs) {};
+
+    // Submit the skeleton once per frame, marginMs before SteamVR samples poses, instead of on every packet
+    bool enabled;
+    float marginMs;
+};
+
+struct VRBudgetConfiguration_t {
+    VRBudgetConfiguration_t(bool enabled = false, float frameBudgetUs = 1000.f, float restoreHeadroom = 0.5f,
+                            std::string degradeOrder = "") :
+            enabled(enabled), frameBudgetUs(frameBudgetUs), restoreHeadroom(restoreHeadroom), degradeOrder(degradeOrder) {};
+
+    // Degrade optional processing while one hand costs more than frameBudgetUs of driver time per frame
+    bool enabled;
+    float frameBudgetUs;
+    // stages come back one at a time once a frame costs less than this share of the budget
+    float restoreHeadroom;
+    // comma separated stage names, the first one is degraded first
+    std::string degradeOrder;
+};
+
+struct VRInputTuning_t {
+    VRInputTuning_t(float smoothing = 0.f, float flexionCurve = 1.f, float flexionDeadzone = 0.f, float joystickDeadzone = 0.f,
+                    float flexionMin = 0.f, float flexionMax = 1.f, float grabThreshold = 0.f, float pinchThreshold = 0.f) :
+            smoothing(smoothing),
+            flexionCurve(flexionCurve),
+            flexionDeadzone(flexionDeadzone),
+            joystickDeadzone(joystickDeadzone),
+            flexionMin(flexionMin),
+            flexionMax(flexionMax),
+            grabThreshold(grabThreshold),
+            pinchThreshold(pinchThreshold) {};
+
+    // Weight of the previous flexion value in an exponential moving average, 0 turns smoothing off
+    float smoothing;
+    // Exponent applied to flexion, 1 is linear
+    float flexionCurve;
+    // Flexion below this reads as fully open, the rest of the range is stretched to 0..1
+    float flexionDeadzone;
+    // Radial deadzone for the joystick
+    float joystickDeadzone;
+    // Flexion range the sensors actually reach, stretched to 0..1 before anything else runs
+    float flexionMin;
+    float flexionMax;
+    // Average flexion of the last three fingers that counts as a grab, 0 leaves grab to the glove
+    float grabThreshold;
+    // Flexion of both thumb and index that counts as a pinch, 0 leaves pinch to the glove
+    float pinchThreshold;
 };
 
 struct VRDeviceConfiguration_t {
     VRDeviceConfiguration_t(vr::ETrackedControllerRole role,
                             bool enabled,
                             VRPoseConfiguration_t poseConfiguration,
+                            VRLateLatchConfiguration_t lateLatchConfiguration,
+                            VRBudgetConfiguration_t budgetConfiguration,
+                            VRInputTuning_t inputTuning,
                             VREncodingProtocol encodingProtocol,
                             VRCommunicationProtocol communicationProtocol,
                             VRDeviceDriver deviceDriver) :
             role(role),
             enabled(enabled),
             poseConfiguration(poseConfiguration),
+            lateLatchConfiguration(lateLatchConfiguration),
+            budgetConfiguration(budgetConfiguration),
+            inputTuning(inputTuning),
             encodingProtocol(encodingProtocol),
             communicationProtocol(communicationProtocol),
             deviceDriver(deviceDriver) {};
@@ -68,6 +173,10 @@ struct VRDeviceConfiguration_t {
     bool enabled;
 
     VRPoseConfiguration_t poseConfiguration;
+    VRLateLatchConfiguration_t lateLatchConfiguration;
+    VRBudgetConfiguration_t budgetConfiguration;
+    // initial values, can be changed while running through DebugRequest
+    VRInputTuning_t inputTuning;
 
     VREncodingProtocol encodingProtocol;
     VRCommunicationProtocol communicationProtocol;
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "Bones.h"
+#include "CacheLine.h"
+#include "DeviceConfiguration.h"
+#include "Encode/PackedSample.h"
+#include "LatencyHistogram.h"
+#include "Recorder.h"
+#include "SampleHistory.h"
+#include "SeqLock.h"
+
+// Updated from the input path with relaxed increments, read by the control side. Grouped by the
+// thread that writes them, each group on cache lines of its own.
+struct DeviceCounters {
+  // decoder
+  alignas(c_cacheLineSize) std::atomic<uint64_t> packets{0};
+  std::atomic<uint64_t> decodeErrors{0};
+  std::atomic<int64_t> lastPacketNs{0};
+
+  // submission
+  alignas(c_cacheLineSize) std::atomic<uint64_t> submitted{0};
+
+  // RunFrame. Copied from SubmissionLatencyStats every time it reports, and kept by the
+  // BudgetGovernor: degrade and restore events, BudgetStage bits degraded now and what a frame cost
+  // over the last window
+  alignas(c_cacheLineSize) std::atomic<float> latencyMeanMs{0.f};
+  std::atomic<float> latencyJitterMs{0.f};
+  std::atomic<uint64_t> budgetEvents{0};
+  std::atomic<uint32_t> degradedStages{0};
+  std::atomic<float> frameCostUs{0.f};
+
+  // connection changes
+  alignas(c_cacheLineSize) std::atomic<uint64_t> reconnects{0};
+  std::atomic<bool> connected{false};
+
+  // time spent in the decoder, in tuning plus submission to SteamVR, and how old the submitted
+  // state is when a frame picks it up
+  alignas(c_cacheLineSize) LatencyHistogram decodeLatency;
+  alignas(c_cacheLineSize) LatencyHistogram submitLatency;
+  alignas(c_cacheLineSize) LatencyHistogram frameAge;
+};
+
+// Bone transforms last submitted to the skeleton component.
+struct HandSkeleton {
+  vr::VRBoneTransform_t bones[NUM_BONES];
+};
+
+/**
+ * Runtime control plane for one device, reached through ITrackedDeviceServerDriver::DebugRequest
+ * (vrcmd, or IVRDebug::DriverDebugRequest from the overlay or any other OpenVR client). One
+ * command per request:
+ *
+ *   stats                        packet, error and latency counters
+ *   get [parameter]              current input tuning
+ *   set <parameter> <value>      change an input tuning parameter live
+ *   capture start <name> | stop  write raw frames from the transport to a file
+ *   record start <name> | stop   write submitted samples to a file
+ *   reconnect                    drop and re-establish the device connection
+ *   history [milliseconds ago]   received state at a point in the recent past
+ *
+ * Any client can send these, so capture and record files are plain names that always land in the
+ * recording directory. Parsing works on views of the request and never allocates. Tuning changes go out through a
+ * seqlock, so the input path picks them up on its next packet without taking a lock.
+ **/
+class DeviceControl {
+ public:
+  // Captures and recordings are written to recordingDirectory.
+  DeviceControl(const VRInputTuning_t& tuning, const std::string& recordingDirectory);
+
+  // Runs on the thread that sent the command and may block it until the device is back.
+  void SetReconnectHandler(std::function<void()> reconnect);
+
+  // Always writes a zero terminated reply, truncated to fit.
+  void HandleRequest(std::string_view request, char* response, uint32_t responseSize);
+
+  DeviceCounters& Counters() { return m_counters; }
+  const SeqLock<VRInputTuning_t>& Tuning() const { return m_tuning; }
+
+  // Called by whichever thread submits input, readers never hold it up.
+  // Last submitted state of the hand, for diagnostics.
+  void PublishSample(const PackedSample& sample) { m_snapshot.Store(sample); }
+  PackedSample Snapshot() const { return m_snapshot.Load(); }
+  // Bones that went with it, for output sinks.
+  void PublishSkeleton(const vr::VRBoneTransform_t (&bones)[NUM_BONES]) {
+    HandSkeleton skeleton;
+    std::memcpy(skeleton.bones, bones, sizeof(skeleton.bones));
+    m_skeleton.Store(skeleton);
+  }
+  const SeqLock<HandSkeleton>& Skeleton() const { return m_skeleton; }
+
+  // Fed from the transport thread
+  Recorder& Capture() { return m_capture; }
+  // Fed from whichever thread submits input
+  Recorder& Recording() { return m_recording; }
+
+  // Appended to by the transport thread as packets arrive, readable from anywhere
+  SampleHistory& History() { return m_history; }
+
+ private:
+  void HandleStats(char* response, uint32_t responseSize);
+  void HandleGet(std::string_view arguments, char* response, uint32_t responseSize);
+  void HandleSet(std::string_view arguments, char* response, uint32_t responseSize);
+  void HandleHistory(std::string_view arguments, char* response, uint32_t responseSize);
+  void HandleRecorder(Recorder& recorder, std::string_view arguments, char* response,
+                      uint32_t responseSize);
+
+  DeviceCounters m_counters;
+  SeqLock<VRInputTuning_t> m_tuning;
+  SeqLock<PackedSample> m_snapshot;
+  SeqLock<HandSkeleton> m_skeleton;
+
+  Recorder m_capture;
+  Recorder m_recording;
+  SampleHistory m_history;
+
+  std::function<void()> m_reconnect;
+
+  // commands can arrive from several clients at once, this only serialises them with each other
+  std::mutex m_commandMutex;
+};
@@ -3,19 +3,28 @@
 #include <openvr_driver.h>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 #include "Communication/CommunicationManager.h"
 #include "Encode/LegacyEncodingManager.h"
 #include "DeviceDriver/DeviceDriver.h"
 
 #include "Bones.h"
+#include "BudgetGovernor.h"
+#include "ButtonEventQueue.h"
+#include "CacheLine.h"
 
+#include "Clock.h"
 #include "ControllerPose.h"
 #include "DeviceConfiguration.h"
+#include "DeviceControl.h"
+#include "LateLatchScheduler.h"
+#include "SignalGraph.h"
 
 class KnuckleDeviceDriver : public IDeviceDriver {
 public:
-	KnuckleDeviceDriver(VRDeviceConfiguration_t configuration, std::unique_ptr<ICommunicationManager> communicationManager, std::string serialNumber);
+	KnuckleDeviceDriver(VRDeviceConfiguration_t configuration, std::unique_ptr<ICommunicationManager> communicationManager, std::shared_ptr<DeviceControl> control, std::string serialNumber);
 
 	vr::EVRInitError Activate(uint32_t unObjectId);
 	void Deactivate();
@@ -30,8 +39,21 @@ public:
 	bool IsActive();
 private:
 	void StartDevice();
+	void StartLateLatch();
 	bool IsRightHand() const;
 
+	//listener callback, either submits straight away or leaves the packet for the late latch
+	void OnPacket(const PackedSample& sample);
+	//tune one decoded packet and apply it to the skeleton and input components
+	void HandleInput(const PackedSample& sample);
+	//submits the buttons set in changed with the state they have in buttons
+	void SubmitButtons(uint16_t buttons, uint16_t changed, float timeOffset);
+	//late latch submission, applies the freshest packet received since the last frame
+	void SubmitLatestInput();
+	//control plane reconnect command, drops the transport and brings it back up
+	void Reconnect();
+
+	//set up before the device starts, only read by the other threads after that
 	bool m_hasActivated;
 	uint32_t m_driverId;
 
@@ -40,11 +62,33 @@ private:
 
 	vr::VRInputComponentHandle_t m_haptic{};
 
-	vr::VRBoneTransform_t m_handTransforms[NUM_BONES];
-
 	VRDeviceConfiguration_t m_configuration;
 	std::unique_ptr<ICommunicationManager> m_communicationManager;
+	std::shared_ptr<DeviceControl> m_control;
 	std::string m_serialNumber;
 
 	std::unique_ptr<ControllerPose> m_controllerPose;
+
+	//each group below starts on a cache line of its own, the transport thread, the submitting thread and
+	//RunFrame all write to this object at the packet or frame rate
+	alignas(c_cacheLineSize) std::mutex m_latestInputMutex;
+	std::optional<PackedSample> m_latestInput;
+	SubmissionLatencyStats m_latencyStats;
+	//transport thread to RunFrame, only used with the late latch
+	ButtonEventQueue m_buttonEvents;
+
+	//charged from whichever thread does the work, evaluated in RunFrame
+	BudgetGovernor m_budget;
+
+	//owned by whichever thread submits input
+	alignas(c_cacheLineSize) vr::VRBoneTransform_t m_handTransforms[NUM_BONES];
+	uint32_t m_tuningVersion = 0;
+	SignalGraph m_signalGraph;
+	//BudgetStage bits the signal graph was last set up for, and when the degraded stages last ran
+	uint32_t m_appliedDegradation = 0;
+	DriverTimePoint m_lastSkeletonSubmit{};
+	DriverTimePoint m_lastPublish{};
+
+	//declared last so the submission thread is stopped before anything it uses is destroyed
+	alignas(c_cacheLineSize) std::unique_ptr<LateLatchScheduler> m_lateLatchScheduler;
 };
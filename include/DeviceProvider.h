@@ -8,10 +8,15 @@
 #include <memory>
 
 #include "Communication/CommunicationManager.h"
+#include "Communication/IoReactor.h"
 #include "DeviceConfiguration.h"
+#include "DeviceControl.h"
 #include "DeviceDriver/DeviceDriver.h"
+#include "Diagnostics/DiagnosticsServer.h"
 #include "DriverLog.h"
 #include "Encode/EncodingManager.h"
+#include "Output/OscSkeletonSender.h"
+#include "Plugin/PluginRegistry.h"
 
 /**
 This class instantiates all the device drivers you have, meaning if you've
@@ -59,6 +64,12 @@ class DeviceProvider : public vr::IServerTrackedDeviceProvider {
   void LeaveStandby();
 
  private:
+  // shared by both hands' transports when enabled, must outlive them
+  std::unique_ptr<IoReactor> m_ioReactor;
+  // only loaded when a hand uses a plugin codec or transport, must outlive the hands
+  std::unique_ptr<PluginRegistry> m_pluginRegistry;
+  std::unique_ptr<DiagnosticsServer> m_diagnosticsServer;
+  std::unique_ptr<OscSkeletonSender> m_oscSender;
   std::unique_ptr<IDeviceDriver> m_leftHand;
   std::unique_ptr<IDeviceDriver> m_rightHand;
   /**
@@ -66,5 +77,6 @@ class DeviceProvider : public vr::IServerTrackedDeviceProvider {
    **/
   VRDeviceConfiguration_t GetDeviceConfiguration(vr::ETrackedControllerRole role);
 
-  std::unique_ptr<IDeviceDriver> InstantiateDeviceDriver(VRDeviceConfiguration_t configuration);
+  std::unique_ptr<IDeviceDriver> InstantiateDeviceDriver(VRDeviceConfiguration_t configuration,
+                                                         std::shared_ptr<DeviceControl> control);
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+#include "DeviceControl.h"
+
+/**
+ * Optional HTTP endpoint on localhost for watching glove links without attaching a debugger:
+ *
+ *   GET /metrics  Prometheus text format: packet, error and reconnect counters, connection state
+ *                 and per-stage latency histograms for each hand
+ *   GET /stream   WebSocket that pushes a JSON snapshot of every hand at a throttled rate, for a
+ *                 browser dashboard
+ *
+ * Runs its own io_context on its own thread and only reads atomics and seqlock snapshots, so no
+ * client, however slow, can hold up the input path.
+ **/
+class DiagnosticsServer {
+ public:
+  DiagnosticsServer(uint16_t port, float streamRateHz);
+  ~DiagnosticsServer();
+
+  // Register every device before Start().
+  void AddDevice(std::string name, std::shared_ptr<DeviceControl> control);
+
+  bool Start();
+  void Stop();
+
+ private:
+  struct Device {
+    std::string name;
+    std::shared_ptr<DeviceControl> control;
+  };
+
+  asio::awaitable<void> Listen(asio::ip::tcp::acceptor acceptor);
+  asio::awaitable<void> Serve(asio::ip::tcp::socket socket);
+  asio::awaitable<void> StreamSnapshots(std::shared_ptr<asio::ip::tcp::socket> socket);
+
+  void WriteMetrics(std::string& out) const;
+  void WriteSnapshots(std::string& out) const;
+
+  uint16_t m_port;
+  DriverDuration m_streamPeriod;
+  std::vector<Device> m_devices;
+
+  asio::io_context m_context;
+  std::thread m_thread;
+
+  // only touched on the server thread
+  int m_clients = 0;
+};
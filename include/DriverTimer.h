@@ -0,0 +1,32 @@
+#pragma once
+
+#include <asio.hpp>
+
+#include "Clock.h"
+
+/**
+ * asio timers that run on DriverClock(), so watchdogs, reconnect backoff and the output loops follow a
+ * simulated clock like every thread in the driver does. The io_context blocks for at most
+ * DriverClock().MaxHostWait() before it compares the clock with a timer's expiry again.
+ **/
+struct AsioDriverClock {
+  using duration = DriverDuration;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = DriverTimePoint;
+  static constexpr bool is_steady = true;
+
+  static time_point now() { return DriverClock().Now(); }
+};
+
+struct AsioDriverWaitTraits {
+  static DriverDuration to_wait_duration(const DriverDuration& duration) {
+    return DriverClock().MaxHostWait(duration);
+  }
+
+  static DriverDuration to_wait_duration(const DriverTimePoint& expiry) {
+    return to_wait_duration(expiry - DriverClock().Now());
+  }
+};
+
+using DriverTimer = asio::basic_waitable_timer<AsioDriverClock, AsioDriverWaitTraits>;
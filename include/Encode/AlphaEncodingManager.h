@@ -7,10 +7,12 @@ public:
 	AlphaEncodingManager(float maxAnalogValue) : m_maxAnalogValue(maxAnalogValue){};
 	
 	//decode the given string into a VRCommData_t
-	VRCommData_t Decode(std::string input);
+	VRCommData_t Decode(std::string_view input);
 private:
-    std::string getArgumentSubstring(std::string str, char del);
+	//keys run from 'A' up to 'A' + c_argumentCount, expand as more letters are added to manager
+	static const int c_argumentCount = 15;
+	//A-G carry a value, the rest are flags
+	static const int c_analogArgumentCount = 7;
 
 	float m_maxAnalogValue;
-	const char* alphabet = "ABCDEFGHIJKLMNO";  // expand as more letters are added to manager
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Largest magnitude ParseAnalogValue() returns, anything bigger saturates.
+static constexpr float c_maxAnalogMagnitude = 1e9f;
+
+/**
+ * Parses an analog value the way the firmware prints it: optional leading spaces, an optional
+ * sign, digits and an optional fraction. Stops at the first other character. Unlike std::stof it
+ * never throws, accepts no exponent, inf or nan, and looks at each character once, so a hostile
+ * token costs time proportional to its length and nothing more.
+ *
+ * Returns how many characters were used, or 0 (leaving value alone) if there were no digits.
+ **/
+size_t ParseAnalogValue(std::string_view text, float& value);
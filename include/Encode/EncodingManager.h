@@ -1,6 +1,10 @@
 #pragma once
 #include <array>
+#include <cstddef>
 #include <string>
+#include <string_view>
+
+struct PackedSample;
 
 struct VRCommData_t {
     VRCommData_t(std::array<float, 5> flexion, std::array<float, 5> splay, float joyX, float joyY, bool joyButton, bool trgButton, bool aButton, bool bButton, bool grab, bool pinch, bool calibrate) :
@@ -48,7 +52,12 @@ enum VRCommDataInputPosition {
 
 class IEncodingManager {
 public:
-    virtual VRCommData_t Decode(std::string input) = 0;
+    //the frame is only borrowed, it may point straight into a transport's receive buffer
+    virtual VRCommData_t Decode(std::string_view input) = 0;
+    //decodes every frame a read delivered in one call, skipping the ones that fail, and returns how many samples
+    //were written. Samples carry the time they were decoded, the caller stamps the sequence. The default
+    //decodes one frame at a time
+    virtual size_t DecodeBatch(const std::string_view* frames, size_t count, PackedSample* samples);
     virtual ~IEncodingManager() {};
 private:
     float m_maxAnalogValue;
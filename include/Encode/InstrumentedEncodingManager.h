@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+
+#include "DeviceControl.h"
+#include "Encode/EncodingManager.h"
+
+/**
+ * Wraps the configured decoder to count packets and decode errors and to feed raw capture. Runs on
+ * the transport thread, so it only does relaxed increments and a ring push when capture is on.
+ **/
+class InstrumentedEncodingManager : public IEncodingManager {
+public:
+	InstrumentedEncodingManager(std::unique_ptr<IEncodingManager> encodingManager, std::shared_ptr<DeviceControl> control);
+
+	VRCommData_t Decode(std::string_view input);
+	size_t DecodeBatch(const std::string_view* frames, size_t count, PackedSample* samples);
+private:
+	std::unique_ptr<IEncodingManager> m_encodingManager;
+	std::shared_ptr<DeviceControl> m_control;
+};
@@ -7,7 +7,7 @@ public:
 	LegacyEncodingManager(float maxAnalogValue) : m_maxAnalogValue(maxAnalogValue){};
 	
 	//decode the given string into a VRCommData_t
-	VRCommData_t Decode(std::string input);
+	VRCommData_t Decode(std::string_view input);
 private:
 	float m_maxAnalogValue;
 };
\ No newline at end of file
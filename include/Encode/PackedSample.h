@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Encode/EncodingManager.h"
+
+enum PackedButton : uint16_t {
+  PackedButton_Joystick = 1 << 0,
+  PackedButton_Trigger = 1 << 1,
+  PackedButton_A = 1 << 2,
+  PackedButton_B = 1 << 3,
+  PackedButton_Grab = 1 << 4,
+  PackedButton_Pinch = 1 << 5,
+  PackedButton_Calibrate = 1 << 6,
+};
+
+/**
+ * Compact form of a decoded packet for everything that holds or hands samples on: listener
+ * callbacks, mailboxes, queues, snapshots and recordings. One cache line, trivially copyable and
+ * safe to memcpy into shared memory or a file.
+ *
+ * Flexion and splay are 0..1 in uint16 fixed point and the joystick axes -1..1 in int16 fixed point,
+ * both finer than any glove ADC. VRCommData_t stays the float view that processing and submission
+ * work on.
+ **/
+struct alignas(64) PackedSample {
+  // DriverClock() nanoseconds when the packet was decoded
+  int64_t timeNs;
+  // increments with every packet a transport delivers, gaps are lost packets
+  uint32_t sequence;
+  // PackedButton bits
+  uint16_t buttons;
+  uint16_t flexion[5];
+  uint16_t splay[5];
+  int16_t joyX;
+  int16_t joyY;
+};
+static_assert(sizeof(PackedSample) == 64, "a packed sample is one cache line");
+static_assert(std::is_trivially_copyable_v<PackedSample>, "packed samples are copied bytewise");
+
+// Out of range values are clamped, so a finger the glove reports as missing (-1) packs as open.
+// NaN packs as open and centred.
+PackedSample PackSample(const VRCommData_t& data, uint32_t sequence, int64_t timeNs);
+VRCommData_t UnpackSample(const PackedSample& sample);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Encode/EncodingManager.h"
+#include "Plugin/OpenglovePlugin.h"
+
+/**
+ * Decodes through a codec from a plugin. Batches go to the plugin in a single call, through frame
+ * and sample arrays kept here between calls; Decode() is a batch of one for transports that still
+ * decode frame by frame.
+ **/
+class PluginEncodingManager : public IEncodingManager {
+ public:
+  // codec belongs to a library in the PluginRegistry, which has to outlive this
+  PluginEncodingManager(const OpengloveCodecApi* codec, const std::string& config);
+  ~PluginEncodingManager();
+
+  PluginEncodingManager(const PluginEncodingManager&) = delete;
+  PluginEncodingManager& operator=(const PluginEncodingManager&) = delete;
+
+  // false if the plugin failed to create its codec
+  bool IsValid() const { return m_instance != nullptr; }
+
+  VRCommData_t Decode(std::string_view input) override;
+  size_t DecodeBatch(const std::string_view* frames, size_t count, PackedSample* samples) override;
+
+ private:
+  // Runs the plugin over frames and leaves the results in m_samples and m_accepted.
+  void DecodeFrames(const std::string_view* frames, size_t count);
+
+  const OpengloveCodecApi* m_codec;
+  void* m_instance;
+
+  std::vector<OpengloveFrame> m_frames;
+  std::vector<OpengloveSample> m_samples;
+  std::vector<uint8_t> m_accepted;
+};
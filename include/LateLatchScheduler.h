@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "CacheLine.h"
+#include "Clock.h"
+
+/**
+ * Running mean/variance of how old the submitted glove state is when SteamVR picks it up.
+ * Used to compare late-latched submission against submitting on every packet.
+ **/
+class SubmissionLatencyStats {
+ public:
+  void OnSubmit(DriverTimePoint time);
+  // Call once per RunFrame. Returns true every reportInterval frames, when a summary is ready.
+  bool OnFrame(DriverTimePoint time);
+
+  void Reset();
+
+  double MeanMs() const { return m_mean * 1000.0; }
+  double JitterMs() const;
+  uint32_t Samples() const { return m_count; }
+  // Age measured by the last OnFrame() that counted a sample.
+  DriverDuration LastAge() const { return m_lastAge; }
+
+  static const uint32_t reportInterval = 900;
+
+ private:
+  // written by the submitting thread
+  alignas(c_cacheLineSize) std::atomic<int64_t> m_lastSubmitNs{INT64_MIN};
+
+  // RunFrame only
+  alignas(c_cacheLineSize) DriverDuration m_lastAge{0};
+  uint32_t m_count = 0;
+  double m_mean = 0;
+  double m_m2 = 0;
+};
+
+/**
+ * Learns the cadence and phase of SteamVR's RunFrame calls and runs a submission callback a fixed
+ * margin before each predicted frame, so the freshest glove state is sampled at the last moment
+ * instead of whenever a packet happened to arrive.
+ **/
+class LateLatchScheduler {
+ public:
+  LateLatchScheduler(DriverDuration initialPeriod, DriverDuration margin);
+  ~LateLatchScheduler();
+
+  void Start(const std::function<void()>& submit);
+  void Stop();
+
+  // Call from RunFrame on SteamVR's thread.
+  void OnRunFrame();
+
+  DriverDuration Period() const { return DriverDuration(m_periodNs.load()); }
+
+ private:
+  void SubmitThread(const std::function<void()>& submit);
+  DriverTimePoint NextDeadline(DriverTimePoint now) const;
+
+  std::atomic<int64_t> m_periodNs;
+  // Predicted time of the most recent frame, phase-locked to the observed RunFrame calls.
+  std::atomic<int64_t> m_phaseNs;
+  DriverDuration m_margin;
+
+  std::atomic<bool> m_threadActive;
+  // cuts the submit thread's sleep short on Stop()
+  ClockSignal m_stop;
+  std::thread m_submitThread;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Clock.h"
+
+/**
+ * Fixed-bucket latency histogram that any thread can record into with relaxed increments and
+ * another thread can read at any time, in the shape Prometheus expects.
+ **/
+class LatencyHistogram {
+ public:
+  // Upper bounds of the finite buckets in microseconds, there is one more for everything above
+  static constexpr std::array<int64_t, 12> c_bucketBoundsUs = {
+      10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+  static constexpr size_t c_bucketCount = c_bucketBoundsUs.size() + 1;
+
+  void Observe(DriverDuration latency);
+
+  // Non-cumulative count of bucket i.
+  uint64_t BucketCount(size_t i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+  uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+  double SumSeconds() const;
+
+ private:
+  std::array<std::atomic<uint64_t>, c_bucketCount> m_buckets{};
+  std::atomic<uint64_t> m_count{0};
+  std::atomic<int64_t> m_sumNs{0};
+};
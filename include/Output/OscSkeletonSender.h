@@ -0,0 +1,69 @@
+#pragma once
+
+#include <asio.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+#include "DeviceControl.h"
+#include "Output/OscWriter.h"
+
+/**
+ * Optional output for avatar software that cannot read SteamVR skeletons. At a fixed rate it sends
+ * one UDP datagram holding an OSC bundle with both hands:
+ *
+ *   /VMC/Ext/OK 1, /VMC/Ext/T <seconds>
+ *   /VMC/Ext/Bone/Pos <Unity humanoid bone> px py pz qx qy qz qw    for each finger joint
+ *   /openglove/<left|right>/curl thumb index middle ring pinky      0 open, 1 closed
+ *
+ * Bone transforms are the local ones submitted to the skeleton component, converted to Unity's
+ * left-handed axes. They are in the OpenVR hand skeleton's joint frames, so a rig whose rest pose
+ * differs has to be retargeted by the receiver, as with any other VMC source.
+ *
+ * Runs on its own thread and only reads seqlock snapshots, so a slow or missing receiver never
+ * holds up the input path. Nothing is sent while neither hand has new data, apart from a keepalive.
+ **/
+class OscSkeletonSender {
+ public:
+  OscSkeletonSender(std::string host, uint16_t port, float rateHz);
+  ~OscSkeletonSender();
+
+  // Register every device before Start().
+  void AddDevice(std::shared_ptr<DeviceControl> control, bool isRightHand);
+
+  bool Start();
+  void Stop();
+
+ private:
+  struct Device {
+    std::shared_ptr<DeviceControl> control;
+    bool isRightHand;
+    // skeleton version sent last
+    uint32_t sentVersion;
+  };
+
+  asio::awaitable<void> SendLoop();
+  // Returns false if nothing changed since the last datagram.
+  bool WriteBundle(bool force);
+
+  std::string m_host;
+  uint16_t m_port;
+  DriverDuration m_period;
+  std::vector<Device> m_devices;
+
+  asio::io_context m_context;
+  asio::ip::udp::socket m_socket;
+  asio::ip::udp::endpoint m_endpoint;
+  std::thread m_thread;
+
+  // only touched on the sender thread
+  std::array<char, 4096> m_buffer;
+  OscWriter m_writer;
+  DriverTimePoint m_startTime;
+  uint64_t m_datagrams = 0;
+  uint64_t m_sendErrors = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Serialises OSC 1.0 messages, optionally wrapped in a bundle, into a buffer the caller owns.
+ * Nothing is allocated. Once something does not fit, Overflowed() is set, further writes are
+ * ignored and the packet should be dropped.
+ *
+ *   writer.BeginBundle();
+ *   writer.BeginMessage("/VMC/Ext/T", "f");
+ *   writer.AddFloat(time);
+ *   writer.EndMessage();
+ *   send(writer.Data(), writer.Size());
+ **/
+class OscWriter {
+ public:
+  OscWriter(char* buffer, size_t capacity);
+
+  // Drops everything written so far.
+  void Reset();
+
+  // Every message until Reset() becomes an element of the bundle. A time tag of 1 means now.
+  void BeginBundle(uint64_t timeTag = 1);
+
+  // typeTags without the leading ',', e.g. "sfff". The arguments have to follow in that order.
+  void BeginMessage(std::string_view address, std::string_view typeTags);
+  void AddInt(int32_t value);
+  void AddFloat(float value);
+  void AddString(std::string_view value);
+  void EndMessage();
+
+  const char* Data() const { return m_buffer; }
+  size_t Size() const { return m_size; }
+  bool Overflowed() const { return m_overflowed; }
+
+ private:
+  void Write(const void* data, size_t size);
+  void WriteBigEndian(uint32_t value);
+  // string, zero terminated and padded to a multiple of 4 bytes
+  void WritePadded(std::string_view value);
+
+  char* m_buffer;
+  size_t m_capacity;
+  size_t m_size = 0;
+  bool m_overflowed = false;
+
+  bool m_inBundle = false;
+  // where the size of the current bundle element goes once the message is complete
+  size_t m_elementStart = 0;
+};
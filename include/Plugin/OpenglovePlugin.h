@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * C ABI for codec and transport plugins. A plugin is a shared library in the plugin directory that
+ * exports OpenglovePluginEntry(). The driver loads every plugin there at startup. A hand uses a
+ * plugin codec when its encoding protocol is PLUGIN_CODEC, and a plugin transport when its
+ * communication protocol is PLUGIN_TRANSPORT; the "plugins" settings section names which.
+ *
+ * Everything crosses the boundary in batches through buffers the driver owns: a transport read
+ * returns as many bytes as it has ready, and a codec decodes every frame those bytes held in one
+ * call. A plugin never allocates memory that the driver frees, nor the other way round.
+ *
+ * The driver calls a given instance from one thread at a time, apart from Interrupt(), which can
+ * come from any thread while a read is in progress.
+ *
+ * Compatibility: OPENGLOVE_PLUGIN_ABI_VERSION changes whenever an existing field changes meaning.
+ * New fields are only ever appended to the structs, and structSize tells the driver which ones a
+ * plugin built against an older header has filled in.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OPENGLOVE_PLUGIN_ABI_VERSION 1
+
+#if defined(_WIN32)
+#define OPENGLOVE_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define OPENGLOVE_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bits of OpengloveSample::buttons
+enum {
+  OPENGLOVE_BUTTON_JOYSTICK = 1 << 0,
+  OPENGLOVE_BUTTON_TRIGGER = 1 << 1,
+  OPENGLOVE_BUTTON_A = 1 << 2,
+  OPENGLOVE_BUTTON_B = 1 << 3,
+  OPENGLOVE_BUTTON_GRAB = 1 << 4,
+  OPENGLOVE_BUTTON_PINCH = 1 << 5,
+  OPENGLOVE_BUTTON_CALIBRATE = 1 << 6,
+};
+
+// One frame as received, terminator included. Points into the driver's receive buffer and is only
+// valid for the duration of the decode call.
+typedef struct OpengloveFrame {
+  const char* data;
+  uint32_t size;
+} OpengloveFrame;
+
+// One decoded frame. Fingers run thumb to pinky, flexion and splay 0..1, joystick axes -1..1.
+typedef struct OpengloveSample {
+  float flexion[5];
+  float splay[5];
+  float joyX;
+  float joyY;
+  uint32_t buttons;
+} OpengloveSample;
+
+typedef struct OpengloveCodecApi {
+  // sizeof(OpengloveCodecApi) in the header the plugin was built against
+  uint32_t structSize;
+  // what the "codec" setting refers to it by, unique across loaded plugins
+  const char* name;
+
+  // config is the "codec_config" setting, never NULL. Returns NULL on failure.
+  void* (*Create)(const char* config);
+  void (*Destroy)(void* codec);
+
+  // Decodes frames[0..count). samples[i] and accepted[i] belong to frames[i]; accepted[i] is set
+  // to 0 for a frame that is not valid, and samples[i] is then ignored. Returns the number of
+  // frames accepted.
+  uint32_t (*Decode)(void* codec, const OpengloveFrame* frames, uint32_t count,
+                     OpengloveSample* samples, uint8_t* accepted);
+} OpengloveCodecApi;
+
+typedef struct OpengloveTransportApi {
+  uint32_t structSize;
+  // what the "transport" setting refers to it by, unique across loaded plugins
+  const char* name;
+
+  // config is the hand's "left_config" or "right_config" setting, never NULL. Returns NULL if the
+  // device cannot be reached.
+  void* (*Open)(const char* config);
+  void (*Close)(void* transport);
+
+  // Waits up to timeoutMs for data, then copies as much as is ready, up to capacity bytes, into
+  // buffer. Returns the number of bytes copied, 0 if none arrived in time, or a negative value once
+  // the link is lost for good.
+  int32_t (*Read)(void* transport, char* buffer, uint32_t capacity, uint32_t timeoutMs);
+  // Makes a Read() in progress on another thread return soon. May be NULL, the driver then relies
+  // on the read timeout to stop.
+  void (*Interrupt)(void* transport);
+} OpengloveTransportApi;
+
+typedef struct OpenglovePlugin {
+  // OPENGLOVE_PLUGIN_ABI_VERSION the plugin was built against
+  uint32_t abiVersion;
+  uint32_t structSize;
+  const char* name;
+
+  const OpengloveCodecApi* const* codecs;
+  uint32_t codecCount;
+  const OpengloveTransportApi* const* transports;
+  uint32_t transportCount;
+} OpenglovePlugin;
+
+// The one symbol a plugin exports. The result must stay valid until the library is unloaded.
+#define OPENGLOVE_PLUGIN_ENTRY_NAME "OpenglovePluginEntry"
+typedef const OpenglovePlugin* (*OpenglovePluginEntryFn)(void);
+
+#ifdef __cplusplus
+}
+#endif
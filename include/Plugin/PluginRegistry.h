@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Plugin/OpenglovePlugin.h"
+
+/**
+ * Loads codec and transport plugins (see OpenglovePlugin.h) and finds them by name. Libraries stay
+ * loaded until the registry is destroyed, so it has to outlive every device using one of them.
+ **/
+class PluginRegistry {
+ public:
+  PluginRegistry() = default;
+  ~PluginRegistry();
+
+  PluginRegistry(const PluginRegistry&) = delete;
+  PluginRegistry& operator=(const PluginRegistry&) = delete;
+
+  // Loads every shared library in directory. Returns how many loaded.
+  int LoadDirectory(const std::string& directory);
+  // Rejects libraries built against another ABI version, or that export a name already taken.
+  bool Load(const std::string& path);
+
+  // nullptr if no loaded plugin provides it
+  const OpengloveCodecApi* FindCodec(std::string_view name) const;
+  const OpengloveTransportApi* FindTransport(std::string_view name) const;
+
+ private:
+  std::vector<void*> m_libraries;
+  std::vector<const OpengloveCodecApi*> m_codecs;
+  std::vector<const OpengloveTransportApi*> m_transports;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <openvr_driver.h>
+
+#include "Clock.h"
+
+/**
+ * Covers short tracking dropouts of the controller being shadowed (occlusion, a missed base station
+ * sweep) so the hand does not vanish or freeze. While tracking is lost the last good pose is dead
+ * reckoned from its velocity and angular velocity, both decaying to zero over the bridge window,
+ * and reported as TrackingResult_Fallback_RotationOnly. When tracking returns, the gap between the
+ * bridged pose and the tracked one is closed over the blend time instead of snapping.
+ *
+ * Only the last output pose is kept, so every call is O(1).
+ **/
+class PoseBridge {
+ public:
+  PoseBridge(DriverDuration window, DriverDuration blend);
+
+  // Call with the pose built from a valid tracked controller pose. Returns the pose to submit.
+  vr::DriverPose_t OnTracked(const vr::DriverPose_t& pose, DriverTimePoint now);
+
+  // Call when the tracked pose is invalid. Returns a bridged pose while inside the window, otherwise
+  // invalidPose unchanged.
+  vr::DriverPose_t OnLost(const vr::DriverPose_t& invalidPose, DriverTimePoint now);
+
+ private:
+  DriverDuration m_window;
+  DriverDuration m_blend;
+
+  // last pose handed out, bridged or tracked
+  vr::DriverPose_t m_lastPose{};
+  DriverTimePoint m_lastTrackedAt{};
+  bool m_hasPose = false;
+
+  // dead reckoning starts from here, at the time of the last tracked pose
+  vr::DriverPose_t m_anchor{};
+  DriverTimePoint m_lostAt{};
+  bool m_bridging = false;
+
+  // offset of the bridged pose from the tracked one at the moment tracking came back
+  double m_blendPosition[3]{};
+  double m_blendAxis[3]{};
+  double m_blendAngle = 0;
+  DriverTimePoint m_blendStart{};
+  bool m_blending = false;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Clock.h"
+#include "Communication/FrameBuffer.h"
+#include "Encode/PackedSample.h"
+#include "SpscRing.h"
+
+/**
+ * Writes a stream of raw frames or decoded samples to a file from its own thread, so the thread
+ * producing them only pays for a copy into a ring. When the writer can't keep up entries are
+ * dropped and counted rather than stalling the producer.
+ *
+ * Lines are "<microseconds> <frame>" for frames and
+ * "<microseconds>,<sequence>,<flexion x5>,<splay x5>,<joyX>,<joyY>,<buttons x7>" for samples.
+ *
+ * Each recorder holds one kind of entry, so its ring is sized to that: a 1 KiB slot per frame for a
+ * capture, the sample itself for a recording. Record calls for the other kind are ignored.
+ *
+ * Start() and Stop() are for the control side; Record*() must only be called from one thread.
+ *
+ * Recordings can be started by any OpenVR client, so they only ever go to a plain file name inside
+ * the directory the recorder was given.
+ **/
+// True for a name that stays inside the directory it is put in and names a file: letters, digits,
+// '.', '-' and '_' only, neither starting nor ending with '.' and not a Windows device name such
+// as NUL or COM3.
+bool IsPlainFileName(std::string_view name);
+
+enum RecorderContent : uint8_t {
+  RecorderContent_Frames = 0,
+  RecorderContent_Samples = 1,
+};
+
+class Recorder {
+ public:
+  Recorder(std::string directory, RecorderContent content);
+  ~Recorder();
+
+  // Creates or truncates fileName in the recorder's directory, creating the directory if needed.
+  // Returns false without touching anything if fileName is not a plain file name.
+  bool Start(std::string_view fileName);
+  void Stop();
+
+  bool IsRecording() const { return m_recording.load(std::memory_order_relaxed); }
+  uint64_t Written() const { return m_written.load(std::memory_order_relaxed); }
+  uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+  void RecordFrame(std::string_view frame);
+  void RecordSample(const PackedSample& sample);
+
+ private:
+  struct FrameEntry {
+    int64_t timeNs;
+    uint16_t length;
+    // the longest frame a transport hands on, so frames are never cut short
+    char bytes[c_maxFrameSize];
+  };
+
+  struct SampleEntry {
+    int64_t timeNs;
+    PackedSample sample;
+  };
+
+  void WriterThread();
+  // Pops and writes everything queued, returns false if there was nothing.
+  bool WriteQueued();
+  void WriteFrame(const FrameEntry& entry);
+  void WriteSample(const SampleEntry& entry);
+
+  std::string m_directory;
+  // only the one for the recorder's content exists
+  std::unique_ptr<SpscRing<FrameEntry>> m_frames;
+  std::unique_ptr<SpscRing<SampleEntry>> m_samples;
+
+  std::atomic<bool> m_recording;
+  // wakes the writer for its last pass as soon as Stop() is called
+  ClockSignal m_stop;
+  std::thread m_writerThread;
+  FILE* m_file;
+
+  std::atomic<uint64_t> m_written;
+  std::atomic<uint64_t> m_dropped;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ConcurrencyChecks.h"
+#include "Encode/EncodingManager.h"
+#include "Encode/PackedSample.h"
+
+/**
+ * The last N samples received for one hand, in a ring that is allocated once. One thread appends,
+ * any number of threads read concurrently without locks and without ever seeing a half written
+ * sample: every slot carries a stamp that says which sample it holds and whether it is being
+ * written, and readers retry if the stamp moved while they copied.
+ *
+ * Samples must be appended in time order, which is what lets a time lookup binary search the ring.
+ **/
+class SampleHistory {
+ public:
+  // Capacity is rounded up to a power of two.
+  explicit SampleHistory(size_t capacity);
+
+  // Writer only. O(1).
+  void Append(const PackedSample& sample);
+
+  bool Latest(PackedSample& sample) const;
+
+  // The state at timeNs, interpolated between the samples either side of it. Buttons come from the
+  // earlier sample. Times after the newest sample get the newest sample, false if the time is
+  // older than anything still in the history or it is empty. O(log N).
+  bool ValueAt(int64_t timeNs, VRCommData_t& value) const;
+
+  // Copies up to maxCount of the most recent samples, oldest first, and returns how many it copied.
+  size_t CopyRecent(PackedSample* samples, size_t maxCount) const;
+
+  size_t Capacity() const { return m_mask + 1; }
+  uint64_t Appended() const { return m_count.load(std::memory_order_acquire); }
+
+ private:
+  struct Slot {
+    // 2n + 1 while sample n is being written into the slot, 2n + 2 once it is complete
+    std::atomic<uint64_t> stamp{0};
+    PackedSample sample;
+  };
+
+  bool Read(uint64_t index, PackedSample& sample) const;
+  // index of the newest sample at or before timeNs, -1 if there is none, -2 if the reader fell too
+  // far behind the writer and should try again
+  int64_t FindAtOrBefore(int64_t timeNs, uint64_t oldest, uint64_t newest) const;
+
+  std::unique_ptr<Slot[]> m_slots;
+  size_t m_mask;
+
+  std::atomic<uint64_t> m_count{0};
+
+  ExclusiveSection m_appending;
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+  int64_t m_lastTimeNs = 0;
+#endif
+};
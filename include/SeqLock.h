@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ConcurrencyChecks.h"
+
+/**
+ * Holds a small trivially copyable value that is written rarely and read on a hot path. Readers
+ * never take a lock or block the writer: they copy the value and retry if a store overlapped the
+ * copy. Stores must not run concurrently with each other.
+ **/
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied bytewise");
+
+ public:
+  explicit SeqLock(const T& value = T()) { std::memcpy(&m_value, &value, sizeof(T)); }
+
+  T Load(uint32_t* version = nullptr) const {
+    T result;
+    uint32_t before;
+    uint32_t after;
+    do {
+      before = m_sequence.load(std::memory_order_acquire);
+      CopyShared(&result, &m_value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = m_sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    if (version) *version = before;
+    return result;
+  }
+
+  // Changes with every store. Cheap enough to poll per packet to see if a reload is needed.
+  uint32_t Version() const { return m_sequence.load(std::memory_order_acquire); }
+
+  void Store(const T& value) {
+    OPENGLOVE_EXCLUSIVE(m_storing, "SeqLock stored to from two threads at once");
+
+    const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    OPENGLOVE_CHECK((sequence & 1) == 0, "SeqLock store started while another was in progress");
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    CopyShared(&m_value, &value, sizeof(T));
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<uint32_t> m_sequence{0};
+  T m_value;
+  ExclusiveSection m_storing;
+};
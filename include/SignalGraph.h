@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "DeviceConfiguration.h"
+#include "Encode/EncodingManager.h"
+#include "Simd/SimdKernels.h"
+
+// Processing stages, in the order they run on each packet. The first four work on each flexion lane
+// on its own and index SimdKernels::signalLanes.
+enum SignalStage : uint32_t {
+  SignalStage_RangeMap = 1 << 0,          // stretch the calibrated flexion range to 0..1
+  SignalStage_Filter = 1 << 1,            // exponential moving average
+  SignalStage_Deadband = 1 << 2,          // flexion deadzone
+  SignalStage_Curve = 1 << 3,             // response curve, looked up in a table
+  SignalStage_Gesture = 1 << 4,           // grab and pinch from flexion
+  SignalStage_JoystickDeadzone = 1 << 5,  // radial joystick deadzone
+};
+static constexpr uint32_t c_signalStageCount = 6;
+
+// Flexion is processed as one block of lanes, padded so the fused loop has no remainder.
+static constexpr size_t c_signalLanes = c_signalLaneCount;
+static constexpr size_t c_curveTableSize = c_signalCurveTableSize;
+static constexpr uint32_t c_signalLaneStages =
+    SignalStage_RangeMap | SignalStage_Filter | SignalStage_Deadband | SignalStage_Curve;
+
+struct SignalGraphParameters {
+  SignalLaneParameters lanes;
+  // the lane stages in the variant for this CPU
+  SignalLaneKernel laneKernel = nullptr;
+  float smoothing = 0.f;
+  float grabThreshold = 2.f;
+  float pinchThreshold = 2.f;
+  float joystickDeadzone = 0.f;
+  // pow(x, curve) sampled at c_curveTableSize intervals over 0..1
+  std::array<float, c_curveTableSize + 1> curveTable{};
+};
+
+struct SignalGraphState {
+  alignas(32) std::array<float, c_signalLanes> filtered{};
+  bool primed = false;
+};
+
+/**
+ * Per-hand input processing, configured from the input tuning. Compile() works out which stages the
+ * parameters actually use and picks a kernel instantiated for exactly that set, which runs all of
+ * them in a single pass over the flexion block, the lane stages in the bound SIMD variant. A stage
+ * that is turned off is not in the kernel at all, so the default tuning costs a copy in and out.
+ *
+ * Not thread safe, owned by whichever thread submits input.
+ **/
+class SignalGraph {
+ public:
+  SignalGraph();
+
+  // Cheap enough to call whenever the tuning changes. The filter keeps its history across calls so
+  // a live change doesn't make the fingers jump.
+  void Compile(const VRInputTuning_t& tuning);
+  // Leaves the given SignalStage bits out of the kernel whatever the tuning says, until the next
+  // call. Used to shed optional stages when the driver is over its time budget.
+  void SetBypass(uint32_t stages);
+
+  void Process(VRCommData_t& data) { m_kernel(m_parameters, m_state, data); }
+
+  // SignalStage bits of the compiled kernel
+  uint32_t Stages() const { return m_stages; }
+
+ private:
+  void Select();
+
+  using Kernel = void (*)(const SignalGraphParameters&, SignalGraphState&, VRCommData_t&);
+
+  SignalGraphParameters m_parameters;
+  SignalGraphState m_state;
+  // what the tuning asks for, what is bypassed and what actually runs
+  uint32_t m_configured = 0;
+  uint32_t m_bypass = 0;
+  uint32_t m_stages = 0;
+  Kernel m_kernel;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Numeric kernels with one variant per instruction set, picked at runtime so a single build runs
+ * on anything from an old CPU to one with AVX-512. DeviceProvider::Init detects the CPU once and
+ * binds the best variant of every kernel family; until then, and on anything but x86, the scalar
+ * reference is used.
+ *
+ * Each variant lives in its own translation unit compiled for its instruction set and must not
+ * call inline functions from other headers, which the linker could otherwise share with code built
+ * for a lesser CPU. A variant only implements the families that gain from it, anything it leaves
+ * null falls back to the next instruction set down.
+ **/
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPENGLOVE_SIMD_X86 1
+#endif
+
+enum SimdIsa : uint32_t {
+  SimdIsa_Scalar,
+  SimdIsa_Sse41,
+  SimdIsa_Avx2,
+  SimdIsa_Avx512,
+};
+static constexpr uint32_t c_simdIsaCount = 4;
+
+// Flexion is processed as one block of lanes, and the response curve is a table of
+// c_signalCurveTableSize intervals over 0..1.
+static constexpr size_t c_signalLaneCount = 8;
+static constexpr size_t c_signalCurveTableSize = 256;
+
+// What the per-lane stages of the signal graph need, see SignalGraph.
+struct SignalLaneParameters {
+  float rangeMin = 0.f;
+  float rangeScale = 1.f;
+  float deadband = 0.f;
+  float deadbandScale = 1.f;
+};
+
+// out = open + weights[bone] * (fist - open), over count bone transforms of eight floats each.
+using BoneBlendKernel = void (*)(const float* open, const float* fist, const float* weights,
+                                 float* out, size_t count);
+// out[i] = weights[0] * a[i] + weights[1] * b[i] + weights[2] * c[i] + weights[3] * d[i]
+using Blend4Kernel = void (*)(const float* a, const float* b, const float* c, const float* d,
+                              const float* weights, float* out, size_t count);
+// The per-lane stages of the signal graph over c_signalLaneCount lanes, in place. filtered is the
+// filter history and curveTable has c_signalCurveTableSize + 1 entries.
+using SignalLaneKernel = void (*)(const SignalLaneParameters& parameters, const float* curveTable,
+                                  float smoothing, float* filtered, float* lanes);
+
+struct SimdKernels {
+  SimdIsa isa;
+  BoneBlendKernel blendBones;
+  Blend4Kernel blend4;
+  // indexed by the SignalStage bits RangeMap, Filter, Deadband and Curve
+  SignalLaneKernel signalLanes[16];
+};
+
+const char* SimdIsaName(SimdIsa isa);
+bool SimdIsaFromName(std::string_view name, SimdIsa& isa);
+
+// Best instruction set the CPU and the OS both support.
+SimdIsa DetectSimdIsa();
+
+// Every kernel family at its best variant up to isa. Families with no variant at all for isa are
+// the scalar reference, so this is also what a comparison against the reference iterates over.
+SimdKernels SimdKernelsFor(SimdIsa isa);
+
+// Binds the best variant up to limit that the CPU runs and returns which that was. Call before
+// anything uses the kernels from another thread.
+SimdIsa BindSimdKernels(SimdIsa limit = SimdIsa_Avx512);
+
+const SimdKernels& Simd();
+
+// Tables of the variants built into this binary, nullptr for those that are not. One per
+// translation unit, see the comment at the top.
+const SimdKernels* SimdKernelsSse41();
+const SimdKernels* SimdKernelsAvx2();
+const SimdKernels* SimdKernelsAvx512();
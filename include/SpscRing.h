@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "CacheLine.h"
+#include "ConcurrencyChecks.h"
+
+/**
+ * Bounded wait-free queue between exactly one producer thread and one consumer thread. Capacity
+ * is rounded up to a power of two. Each side keeps a cached copy of the other side's index so the
+ * shared cache lines are only touched when the cached view says the ring is full or empty.
+ **/
+template <typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+
+    m_slots.resize(size);
+    m_mask = size - 1;
+  }
+
+  // Producer only. Returns false, leaving the ring untouched, if it is full.
+  bool TryPush(const T& value) {
+    OPENGLOVE_EXCLUSIVE(m_pushing, "SpscRing pushed to from two threads at once");
+
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cachedHead > m_mask) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      OPENGLOVE_CHECK(tail - m_cachedHead <= m_mask + 1, "SpscRing consumer ran past the producer");
+      if (tail - m_cachedHead > m_mask) return false;
+    }
+
+    m_slots[tail & m_mask] = value;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if there is nothing to pop.
+  bool TryPop(T& value) {
+    OPENGLOVE_EXCLUSIVE(m_popping, "SpscRing popped from two threads at once");
+
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      OPENGLOVE_CHECK(m_cachedTail - head <= m_mask + 1,
+                      "SpscRing producer overwrote unread slots");
+      if (head == m_cachedTail) return false;
+    }
+
+    value = m_slots[head & m_mask];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called while the other side is active.
+  size_t Size() const {
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+
+ private:
+  std::vector<T> m_slots;
+  size_t m_mask;
+
+  alignas(c_cacheLineSize) std::atomic<size_t> m_head{0};
+  size_t m_cachedTail = 0;
+  ExclusiveSection m_popping;
+
+  alignas(c_cacheLineSize) std::atomic<size_t> m_tail{0};
+  size_t m_cachedHead = 0;
+  ExclusiveSection m_pushing;
+};
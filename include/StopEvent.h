@@ -0,0 +1,69 @@
+#pragma once
+
+#include <windows.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "Clock.h"
+
+/**
+ * Manual-reset event that tells a worker thread to finish. Every blocking wait in the worker
+ * includes Handle() in the set of objects it waits on, so Set() wakes the thread wherever it is
+ * parked and the owner's join returns in bounded time.
+ **/
+class StopEvent {
+ public:
+  StopEvent() : m_event(CreateEvent(NULL, TRUE, FALSE, NULL)) {}
+  ~StopEvent() {
+    if (m_event != NULL) CloseHandle(m_event);
+  }
+
+  StopEvent(const StopEvent&) = delete;
+  StopEvent& operator=(const StopEvent&) = delete;
+
+  void Set() { SetEvent(m_event); }
+  // Re-arm before starting the next worker.
+  void Reset() { ResetEvent(m_event); }
+  bool IsSet() const { return WaitForSingleObject(m_event, 0) == WAIT_OBJECT_0; }
+
+  // Waits for duration on DriverClock(), or less if stop is requested meanwhile. Returns false if it
+  // was.
+  bool SleepFor(DriverDuration duration) const {
+    return WaitOnClock(duration, WAIT_TIMEOUT, [&](DWORD milliseconds) {
+             return WaitForSingleObject(m_event, milliseconds);
+           }) != WAIT_OBJECT_0;
+  }
+
+  HANDLE Handle() const { return m_event; }
+
+  // Repeats wait(milliseconds), a wait on OS objects that returns timedOut when its time runs out,
+  // until it returns anything else or timeout has passed on DriverClock(). No single wait is longer
+  // than DriverClock().MaxHostWait(), so a simulated clock's deadlines hold. DriverDuration::max()
+  // waits without a limit.
+  template <typename Wait>
+  static DWORD WaitOnClock(DriverDuration timeout, DWORD timedOut, Wait&& wait) {
+    const DriverTimePoint start = DriverClock().Now();
+    DriverDuration remaining = timeout;
+    while (true) {
+      const DWORD result = wait(ToWaitMilliseconds(DriverClock().MaxHostWait(remaining)));
+      if (result != timedOut) return result;
+      if (timeout == DriverDuration::max()) continue;
+
+      remaining = timeout - (DriverClock().Now() - start);
+      if (remaining <= DriverDuration::zero()) return result;
+    }
+  }
+
+  // Rounds up so a short wait never turns into a busy loop of zero-length ones.
+  static DWORD ToWaitMilliseconds(DriverDuration duration) {
+    if (duration == DriverDuration::max()) return INFINITE;
+
+    const auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(duration).count();
+    if (milliseconds <= 0) return 0;
+    return static_cast<DWORD>((std::min)(milliseconds, static_cast<long long>(INFINITE) - 1));
+  }
+
+ private:
+  HANDLE m_event;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <openvr_driver.h>
+
+/**
+ * Thumb pose as a function of two inputs: curl, and opposition (how far the thumb has swung from
+ * beside the index finger to across the palm). A single flexion value cannot tell a pinch from a
+ * thumb folded over the fingers; gloves that measure thumb splay can drive the second axis.
+ *
+ * The grid is baked once from key poses. Along curl they are the open and fist poses. Along
+ * opposition the thumb metacarpal is turned, in the wrist's frame, away from the palm at 0 and
+ * across it at 1, with the authored poses unchanged at 0.5. That is the value every encoder sends
+ * when it has no splay sensor, so those gloves look exactly as before.
+ *
+ * Evaluation is a bilinear blend of the four surrounding nodes, with no trigonometry and no
+ * normalisation, over a table small enough to stay in L1.
+ **/
+class ThumbPoseTable {
+ public:
+  // thumb metacarpal, proximal, distal, tip and the thumb aux bone
+  static constexpr int c_boneCount = 5;
+  static constexpr int c_curlSteps = 5;
+  static constexpr int c_oppositionSteps = 9;
+
+  ThumbPoseTable(const vr::VRBoneTransform_t* openPose, const vr::VRBoneTransform_t* fistPose);
+
+  // Writes the thumb bones of a full hand. Both inputs are clamped to 0..1.
+  void Evaluate(float curl, float opposition, vr::VRBoneTransform_t* handTransforms) const;
+
+ private:
+  struct Node {
+    vr::VRBoneTransform_t bones[c_boneCount];
+  };
+
+  alignas(64) Node m_nodes[c_oppositionSteps][c_curlSteps];
+};
@@ -0,0 +1,4 @@
+#pragma once
+#include <utility>
+#include <boost/asio.hpp>
+namespace asio { using namespace boost::asio; using error_code = boost::system::error_code; using system_error = boost::system::system_error; }
@@ -0,0 +1,2 @@
+#pragma once
+#define ASIO_VERSION 102800 // shim
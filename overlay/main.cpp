@@ -4,6 +4,8 @@
 #include <chrono>
 #include <thread>
 
+#include "Clock.h"
+
 std::atomic<bool> appActive = true;
 
 const std::string ourManufacturer = "LucasVRTech&Danwillm";
@@ -85,7 +87,7 @@ void DiscoverController(vr::ETrackedControllerRole role) {
       GetAndSendControllerId(curFound, role);
       lastFound = curFound;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    DriverClock().SleepFor(std::chrono::milliseconds(500));
   }
 }
 
@@ -115,7 +117,7 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdL
             return 0;
         }
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      DriverClock().SleepFor(std::chrono::milliseconds(200));
     }
   } else {
     vr::VR_Shutdown();
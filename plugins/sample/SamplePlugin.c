@@ -0,0 +1,161 @@
+/*
+ * Sample plugin, written in plain C against OpenglovePlugin.h only. It has one codec and one
+ * transport, and starting from a copy of it is the quickest way to support new hardware without
+ * touching the driver.
+ *
+ *   codec "sample-alpha"       the alpha protocol's finger, joystick and button keys.
+ *                              codec_config is the largest analog value, 1023 if empty.
+ *   transport "sample-replay"  plays a file of frames back in a loop, one per line as a glove
+ *                              sends them. left_config/right_config is its path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Plugin/OpenglovePlugin.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+static void SleepMs(uint32_t ms) { Sleep(ms); }
+#else
+#include <time.h>
+static void SleepMs(uint32_t ms) {
+  struct timespec duration = {ms / 1000, (long)(ms % 1000) * 1000000L};
+  nanosleep(&duration, NULL);
+}
+#endif
+
+/* codec */
+
+typedef struct SampleCodec {
+  float maxAnalogValue;
+} SampleCodec;
+
+static void* CodecCreate(const char* config) {
+  SampleCodec* codec = (SampleCodec*)malloc(sizeof(SampleCodec));
+  if (codec == NULL) return NULL;
+
+  codec->maxAnalogValue = config[0] != '\0' ? strtof(config, NULL) : 1023.f;
+  if (!(codec->maxAnalogValue > 0.f)) {
+    free(codec);
+    return NULL;
+  }
+  return codec;
+}
+
+static void CodecDestroy(void* codec) { free(codec); }
+
+/* Returns 0 if the frame is not valid. */
+static int DecodeFrame(const SampleCodec* codec, const OpengloveFrame* frame,
+                       OpengloveSample* sample) {
+  /* A-G carry a value, H-O are flags, only the first occurrence of a key counts */
+  float values[7] = {0};
+  uint32_t present = 0;
+
+  for (uint32_t pos = 0; pos < frame->size; pos++) {
+    const int key = frame->data[pos] - 'A';
+    if (key < 0 || key >= 15 || (present & (1u << key))) continue;
+    present |= 1u << key;
+
+    if (key >= 7) continue;
+
+    uint32_t digits = 0;
+    float value = 0.f;
+    while (pos + 1 < frame->size && frame->data[pos + 1] >= '0' && frame->data[pos + 1] <= '9') {
+      value = value * 10.f + (float)(frame->data[pos + 1] - '0');
+      pos++;
+      digits++;
+    }
+    if (digits == 0) return 0;
+    values[key] = value;
+  }
+
+  for (int i = 0; i < 5; i++) {
+    /* a finger the glove does not report reads as missing, like the built in decoder */
+    sample->flexion[i] = (present & (1u << i)) ? values[i] / codec->maxAnalogValue : -1.f;
+    sample->splay[i] = 0.5f;
+  }
+  sample->joyX = (present & (1u << 5)) ? 2.f * values[5] / codec->maxAnalogValue - 1.f : 0.f;
+  sample->joyY = (present & (1u << 6)) ? 2.f * values[6] / codec->maxAnalogValue - 1.f : 0.f;
+
+  /* H-M map onto the first six button bits in order, O is calibration and N is reserved */
+  sample->buttons = (present >> 7) & 0x3f;
+  if (present & (1u << 14)) sample->buttons |= OPENGLOVE_BUTTON_CALIBRATE;
+  return 1;
+}
+
+static uint32_t CodecDecode(void* codec, const OpengloveFrame* frames, uint32_t count,
+                            OpengloveSample* samples, uint8_t* accepted) {
+  uint32_t decoded = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    accepted[i] = (uint8_t)DecodeFrame((const SampleCodec*)codec, &frames[i], &samples[i]);
+    decoded += accepted[i];
+  }
+  return decoded;
+}
+
+static const OpengloveCodecApi c_codec = {
+    sizeof(OpengloveCodecApi), "sample-alpha", CodecCreate, CodecDestroy, CodecDecode,
+};
+
+/* transport */
+
+/* a chunk every 10ms, a few frames each, like a glove streaming at a few hundred Hz */
+static const uint32_t c_replayIntervalMs = 10;
+static const uint32_t c_replayChunkBytes = 256;
+
+typedef struct SampleReplay {
+  FILE* file;
+} SampleReplay;
+
+static void* ReplayOpen(const char* config) {
+  FILE* file = fopen(config, "rb");
+  if (file == NULL) return NULL;
+
+  SampleReplay* replay = (SampleReplay*)malloc(sizeof(SampleReplay));
+  if (replay == NULL) {
+    fclose(file);
+    return NULL;
+  }
+  replay->file = file;
+  return replay;
+}
+
+static void ReplayClose(void* transport) {
+  SampleReplay* replay = (SampleReplay*)transport;
+  fclose(replay->file);
+  free(replay);
+}
+
+static int32_t ReplayRead(void* transport, char* buffer, uint32_t capacity, uint32_t timeoutMs) {
+  SampleReplay* replay = (SampleReplay*)transport;
+
+  /* there is always data, so a read only waits for the pacing interval */
+  SleepMs(timeoutMs < c_replayIntervalMs ? timeoutMs : c_replayIntervalMs);
+
+  const size_t want = capacity < c_replayChunkBytes ? capacity : c_replayChunkBytes;
+  size_t got = fread(buffer, 1, want, replay->file);
+  if (got < want) {
+    /* an empty or unreadable file can never deliver anything */
+    rewind(replay->file);
+    if (got == 0) got = fread(buffer, 1, want, replay->file);
+    if (got == 0) return -1;
+  }
+  return (int32_t)got;
+}
+
+static const OpengloveTransportApi c_transport = {
+    sizeof(OpengloveTransportApi), "sample-replay", ReplayOpen, ReplayClose, ReplayRead, NULL,
+};
+
+/* entry point */
+
+static const OpengloveCodecApi* const c_codecs[] = {&c_codec};
+static const OpengloveTransportApi* const c_transports[] = {&c_transport};
+
+static const OpenglovePlugin c_plugin = {
+    OPENGLOVE_PLUGIN_ABI_VERSION, sizeof(OpenglovePlugin), "sample", c_codecs, 1, c_transports, 1,
+};
+
+OPENGLOVE_PLUGIN_EXPORT const OpenglovePlugin* OpenglovePluginEntry(void) { return &c_plugin; }
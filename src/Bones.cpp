@@ -1,9 +1,11 @@
 #include <Bones.h>
 #include <DriverLog.h>
+#include <ThumbPoseTable.h>
+#include <Simd/SimdKernels.h>
 
 // these poses come from Valve's Index Controllers so share the same root bone to wrist
 // geometry assumptions.
-vr::VRBoneTransform_t rightOpenPose[NUM_BONES] = {
+const vr::VRBoneTransform_t rightOpenPose[NUM_BONES] = {
 { { 0.000000f,  0.000000f,  0.000000f,  1.000000f}, { 1.000000f, -0.000000f, -0.000000f,  0.000000f} },
 { { 0.034038f,  0.036503f,  0.164722f,  1.000000f}, {-0.055147f, -0.078608f,  0.920279f, -0.379296f} },
 { { 0.012083f,  0.028070f,  0.025050f,  1.000000f}, { 0.567418f, -0.464112f,  0.623374f, -0.272106f} },
@@ -37,7 +39,7 @@ vr::VRBoneTransform_t rightOpenPose[NUM_BONES] = {
 { { 0.031806f, -0.087214f,  0.121015f,  1.000000f}, {-0.003659f,  0.758407f,  0.639342f,  0.126678f} },
 };
 
-vr::VRBoneTransform_t rightFistPose[NUM_BONES] =
+const vr::VRBoneTransform_t rightFistPose[NUM_BONES] =
 {
 { { 0.000000f,  0.000000f,  0.000000f,  1.000000f}, { 1.000000f, -0.000000f, -0.000000f,  0.000000f} },
 { { 0.034038f,  0.036503f,  0.164722f,  1.000000f}, {-0.055147f, -0.078608f,  0.920279f, -0.379296f} },
@@ -72,7 +74,7 @@ vr::VRBoneTransform_t rightFistPose[NUM_BONES] =
 { {-0.003263f, -0.034685f,  0.139926f,  1.000000f}, { 0.019690f, -0.100741f,  0.957331f,  0.270149f} },
 };
 
-vr::VRBoneTransform_t leftOpenPose[NUM_BONES] = {
+const vr::VRBoneTransform_t leftOpenPose[NUM_BONES] = {
 { { 0.000000f,  0.000000f,  0.000000f,  1.000000f}, { 1.000000f, -0.000000f, -0.000000f,  0.000000f} },
 { {-0.034038f,  0.036503f,  0.164722f,  1.000000f}, {-0.055147f, -0.078608f, -0.920279f,  0.379296f} },
 { {-0.012083f,  0.028070f,  0.025050f,  1.000000f}, { 0.464112f,  0.567418f,  0.272106f,  0.623374f} },
@@ -106,7 +108,7 @@ vr::VRBoneTransform_t leftOpenPose[NUM_BONES] = {
 { {-0.031806f, -0.087214f,  0.121015f,  1.000000f}, {-0.003659f,  0.758407f, -0.639342f, -0.126678f} },
 };
 
-vr::VRBoneTransform_t leftFistPose[NUM_BONES] = {
+const vr::VRBoneTransform_t leftFistPose[NUM_BONES] = {
 { { 0.000000f,  0.000000f,  0.000000f,  1.000000f}, { 1.000000f, -0.000000f, -0.000000f,  0.000000f} },
 { {-0.034038f,  0.036503f,  0.164722f,  1.000000f}, {-0.055147f, -0.078608f, -0.920279f,  0.379296f} },
 { {-0.016305f,  0.027529f,  0.017800f,  1.000000f}, { 0.225703f,  0.483332f,  0.126413f,  0.836342f} },
@@ -140,6 +142,10 @@ vr::VRBoneTransform_t leftFistPose[NUM_BONES] = {
 { { 0.003263f, -0.034685f,  0.139926f,  1.000000f}, { 0.019690f, -0.100741f, -0.957331f, -0.270149f} },
 };
 
+// baked once at load, from the poses above
+static const ThumbPoseTable rightThumbTable(rightOpenPose, rightFistPose);
+static const ThumbPoseTable leftThumbTable(leftOpenPose, leftFistPose);
+
 vr::HmdQuaternionf_t CalculateOrientation(const float transform, const int boneIndex, const vr::VRBoneTransform_t* openPose, const vr::VRBoneTransform_t* fistPose) {
 
 	const vr::HmdQuaternionf_t openPoseOrientation = openPose[boneIndex].orientation;
@@ -170,14 +176,44 @@ vr::HmdVector4_t CalculatePosition(const float transform, const int boneIndex, c
 //Transform should be between 0-1
 void ComputeBoneFlexion(vr::VRBoneTransform_t* bone_transform, float transform, int index, const bool isRightHand) {
 
-	vr::VRBoneTransform_t* fist_pose = isRightHand ? rightFistPose : leftFistPose;
-	vr::VRBoneTransform_t* open_pose = isRightHand ? rightOpenPose : leftOpenPose;
+	const vr::VRBoneTransform_t* fist_pose = isRightHand ? rightFistPose : leftFistPose;
+	const vr::VRBoneTransform_t* open_pose = isRightHand ? rightOpenPose : leftOpenPose;
 
 
 	bone_transform->orientation = CalculateOrientation(transform, index, open_pose, fist_pose);
 	bone_transform->position = CalculatePosition(transform, index, open_pose, fist_pose);
 }
 
+//Flexion should be between 0-1, one per finger starting at the thumb
+void ComputeFingerFlexion(vr::VRBoneTransform_t* handTransforms, const float* flexion, const bool isRightHand) {
+	static_assert(sizeof(vr::VRBoneTransform_t) == 8 * sizeof(float), "bones are blended as eight floats");
+
+	const vr::VRBoneTransform_t* fist_pose = isRightHand ? rightFistPose : leftFistPose;
+	const vr::VRBoneTransform_t* open_pose = isRightHand ? rightOpenPose : leftOpenPose;
+
+	//the finger bones are contiguous from the index metacarpal to the pinky tip, then the thumb's aux bone splits them from
+	//the other aux bones
+	const int fingerBones = eBone_PinkyFinger4 - eBone_IndexFinger0 + 1;
+	const int auxBones = eBone_Aux_PinkyFinger - eBone_Aux_IndexFinger + 1;
+	float fingerWeights[fingerBones];
+	float auxWeights[auxBones];
+	for (int i = 0; i < fingerBones; i++) fingerWeights[i] = flexion[FingerFromBone(eBone_IndexFinger0 + i)];
+	for (int i = 0; i < auxBones; i++) auxWeights[i] = flexion[FingerFromBone(eBone_Aux_IndexFinger + i)];
+
+	const BoneBlendKernel blend = Simd().blendBones;
+	blend(&open_pose[eBone_IndexFinger0].position.v[0], &fist_pose[eBone_IndexFinger0].position.v[0], fingerWeights,
+		&handTransforms[eBone_IndexFinger0].position.v[0], fingerBones);
+	blend(&open_pose[eBone_Aux_IndexFinger].position.v[0], &fist_pose[eBone_Aux_IndexFinger].position.v[0], auxWeights,
+		&handTransforms[eBone_Aux_IndexFinger].position.v[0], auxBones);
+}
+
+//Curl and opposition should be between 0-1, 0.5 opposition is the authored thumb
+void ComputeThumbPose(vr::VRBoneTransform_t* handTransforms, float curl, float opposition, const bool isRightHand) {
+	const ThumbPoseTable& table = isRightHand ? rightThumbTable : leftThumbTable;
+
+	table.Evaluate(curl, opposition, handTransforms);
+}
+
 
 float Lerp(const float a, const float b, const float f) {
 	return a + f * (b - a);
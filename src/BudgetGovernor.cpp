@@ -0,0 +1,186 @@
+#include "BudgetGovernor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "DeviceControl.h"
+#include "DriverLog.h"
+
+namespace {
+// long enough to average over a few dozen frames, short enough to react within a second
+constexpr DriverDuration c_window = std::chrono::milliseconds(500);
+
+// windows under the restore threshold before a stage comes back, doubled each time a restored
+// stage pushes the hand straight back over budget
+constexpr uint32_t c_baseHoldWindows = 4;
+constexpr uint32_t c_maxHoldWindows = 64;
+// going over budget this soon after a restore counts as the restore having been premature
+constexpr DriverDuration c_flapTime = std::chrono::seconds(5);
+// and this long without going over budget forgets about it
+constexpr DriverDuration c_settleTime = std::chrono::seconds(60);
+
+struct StageName {
+  BudgetStage stage;
+  const char* name;
+};
+constexpr StageName c_stageNames[c_budgetStageCount] = {
+    {BudgetStage_Recording, "recording"}, {BudgetStage_Diagnostics, "diagnostics"},
+    {BudgetStage_SkeletonRate, "skeleton_rate"}, {BudgetStage_Smoothing, "smoothing"},
+    {BudgetStage_Gestures, "gestures"},
+};
+
+constexpr const char* c_costNames[c_budgetCostCount] = {
+    "signal", "skeleton", "controls", "diagnostics", "recording", "pose",
+};
+
+std::string_view Trim(std::string_view text) {
+  const size_t start = text.find_first_not_of(" \t");
+  if (start == std::string_view::npos) return {};
+  return text.substr(start, text.find_last_not_of(" \t") - start + 1);
+}
+
+// "812us per frame against 500us (signal 3us, skeleton 790us, ...)"
+void FormatCosts(char* out, size_t size, double frameCostUs, double budgetUs,
+                 const double* costsUs) {
+  int written =
+      std::snprintf(out, size, "%.0fus per frame against %.0fus (", frameCostUs, budgetUs);
+  for (uint32_t i = 0; i < c_budgetCostCount; i++) {
+    if (written < 0 || static_cast<size_t>(written) >= size) return;
+    written += std::snprintf(out + written, size - written, "%s%s %.0fus", i == 0 ? "" : ", ",
+                             c_costNames[i], costsUs[i]);
+  }
+  if (written >= 0 && static_cast<size_t>(written) < size) {
+    std::snprintf(out + written, size - written, ")");
+  }
+}
+}  // namespace
+
+const char* BudgetStageName(BudgetStage stage) {
+  for (const StageName& name : c_stageNames)
+    if (name.stage == stage) return name.name;
+
+  return "unknown";
+}
+
+std::vector<BudgetStage> ParseBudgetStages(std::string_view list) {
+  std::vector<BudgetStage> stages;
+
+  while (!list.empty()) {
+    const size_t comma = std::min(list.find(','), list.size());
+    const std::string_view token = Trim(list.substr(0, comma));
+    list = list.substr(std::min(comma + 1, list.size()));
+    if (token.empty()) continue;
+
+    const auto found = std::find_if(std::begin(c_stageNames), std::end(c_stageNames),
+                                    [&](const StageName& name) { return token == name.name; });
+    if (found == std::end(c_stageNames)) {
+      DriverLog("Unknown budget stage '%.*s', ignoring it", static_cast<int>(token.size()),
+                token.data());
+      continue;
+    }
+    if (std::find(stages.begin(), stages.end(), found->stage) == stages.end())
+      stages.push_back(found->stage);
+  }
+
+  return stages;
+}
+
+BudgetGovernor::BudgetGovernor(const VRBudgetConfiguration_t& configuration, std::string name,
+                               DeviceCounters& counters)
+    : m_enabled(configuration.enabled),
+      m_budgetUs(configuration.frameBudgetUs),
+      m_restoreUs(configuration.frameBudgetUs *
+                  std::clamp(configuration.restoreHeadroom, 0.f, 1.f)),
+      m_order(ParseBudgetStages(configuration.degradeOrder)),
+      m_name(std::move(name)),
+      m_counters(counters),
+      m_holdWindows(c_baseHoldWindows) {}
+
+void BudgetGovernor::OnFrame(DriverTimePoint now) {
+  // whatever was charged before the first frame has nothing to be averaged over
+  if (m_windowStart == DriverTimePoint()) {
+    for (auto& spent : m_spentNs) spent.store(0, std::memory_order_relaxed);
+    m_windowStart = now;
+    return;
+  }
+
+  m_frames++;
+  if (now - m_windowStart < c_window) return;
+
+  Evaluate(now, now - m_windowStart);
+  m_windowStart = now;
+  m_frames = 0;
+}
+
+void BudgetGovernor::Evaluate(DriverTimePoint now, DriverDuration window) {
+  double costsUs[c_budgetCostCount];
+  double frameCostUs = 0;
+  for (uint32_t i = 0; i < c_budgetCostCount; i++) {
+    costsUs[i] = m_spentNs[i].exchange(0, std::memory_order_relaxed) * 1e-3 / m_frames;
+    frameCostUs += costsUs[i];
+  }
+
+  m_framePeriodNs.store(window.count() / m_frames, std::memory_order_relaxed);
+  m_counters.frameCostUs.store(static_cast<float>(frameCostUs), std::memory_order_relaxed);
+
+  if (!m_enabled) return;
+
+  if (m_holdWindows > c_baseHoldWindows && now - m_lastDegrade > c_settleTime)
+    m_holdWindows = c_baseHoldWindows;
+
+  if (frameCostUs > m_budgetUs) {
+    m_calmWindows = 0;
+    Degrade(now, frameCostUs, costsUs);
+    return;
+  }
+  m_exhausted = false;
+
+  if (m_degradedCount == 0 || frameCostUs >= m_restoreUs) {
+    m_calmWindows = 0;
+    return;
+  }
+  if (++m_calmWindows >= m_holdWindows) {
+    m_calmWindows = 0;
+    Restore(now, frameCostUs, costsUs);
+  }
+}
+
+void BudgetGovernor::Degrade(DriverTimePoint now, double frameCostUs, const double* costsUs) {
+  char costs[256];
+  FormatCosts(costs, sizeof(costs), frameCostUs, m_budgetUs, costsUs);
+
+  if (m_degradedCount == m_order.size()) {
+    // said once per stretch over budget, not every window
+    if (!m_exhausted)
+      DriverLog("%s is over its budget with nothing left to degrade: %s", m_name.c_str(), costs);
+    m_exhausted = true;
+    return;
+  }
+
+  if (m_lastRestore != DriverTimePoint() && now - m_lastRestore < c_flapTime)
+    m_holdWindows = std::min(m_holdWindows * 2, c_maxHoldWindows);
+  m_lastDegrade = now;
+
+  const BudgetStage stage = m_order[m_degradedCount++];
+  m_degraded.fetch_or(stage, std::memory_order_relaxed);
+  m_counters.degradedStages.store(Degraded(), std::memory_order_relaxed);
+  m_counters.budgetEvents.fetch_add(1, std::memory_order_relaxed);
+
+  DriverLog("%s is over its budget, degrading %s: %s", m_name.c_str(), BudgetStageName(stage),
+            costs);
+}
+
+void BudgetGovernor::Restore(DriverTimePoint now, double frameCostUs, const double* costsUs) {
+  char costs[256];
+  FormatCosts(costs, sizeof(costs), frameCostUs, m_budgetUs, costsUs);
+
+  m_lastRestore = now;
+
+  const BudgetStage stage = m_order[--m_degradedCount];
+  m_degraded.fetch_and(~static_cast<uint32_t>(stage), std::memory_order_relaxed);
+  m_counters.degradedStages.store(Degraded(), std::memory_order_relaxed);
+  m_counters.budgetEvents.fetch_add(1, std::memory_order_relaxed);
+
+  DriverLog("%s has headroom again, restoring %s: %s", m_name.c_str(), BudgetStageName(stage),
+            costs);
+}
@@ -0,0 +1,16 @@
+#include "ButtonEventQueue.h"
+
+ButtonEventQueue::ButtonEventQueue(size_t capacity) : m_ring(capacity) {}
+
+void ButtonEventQueue::OnSample(const PackedSample& sample) {
+  const uint16_t buttons = sample.buttons & c_eventButtons;
+  const uint16_t changed = buttons ^ m_queuedButtons;
+  if (changed == 0) return;
+
+  if (!m_ring.TryPush({sample.timeNs, buttons, changed})) {
+    m_overflows.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  m_queuedButtons = buttons;
+}
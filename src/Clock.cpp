@@ -0,0 +1,143 @@
+#include "Clock.h"
+
+#include <algorithm>
+#include <thread>
+
+// how long a simulated sleeper or a wait on an OS object goes without looking at the clock again
+static const DriverDuration c_simulatedHostSlice = std::chrono::milliseconds(1);
+
+void ClockSignal::Set() {
+  {
+    // under the mutex, so a sleeper can't miss it between checking the flag and waiting
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_set.store(true, std::memory_order_release);
+  }
+  m_wakeup.notify_all();
+}
+
+DriverTimePoint SystemClock::Now() {
+  return std::chrono::time_point_cast<DriverDuration>(std::chrono::steady_clock::now());
+}
+
+void SystemClock::SleepUntil(DriverTimePoint deadline) { std::this_thread::sleep_until(deadline); }
+
+bool SystemClock::SleepUntil(DriverTimePoint deadline, ClockSignal& cancel) {
+  std::unique_lock<std::mutex> lock(cancel.m_mutex);
+  return !cancel.m_wakeup.wait_until(lock, deadline, [&] { return cancel.IsSet(); });
+}
+
+SimulatedClock::SimulatedClock(DriverTimePoint start)
+    : m_nowNs(start.time_since_epoch().count()) {}
+
+DriverTimePoint SimulatedClock::Now() {
+  return DriverTimePoint(DriverDuration(m_nowNs.load(std::memory_order_acquire)));
+}
+
+void SimulatedClock::SleepUntil(DriverTimePoint deadline) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (Now() >= deadline) return;
+
+  // the entry is removed by whoever advances time past it, so m_deadlines only ever holds threads
+  // that are still blocked
+  m_deadlines.insert(deadline);
+  MaybeAutoAdvanceLocked();
+
+  m_wakeup.wait(lock, [&] { return Now() >= deadline; });
+}
+
+bool SimulatedClock::SleepUntil(DriverTimePoint deadline, ClockSignal& cancel) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (cancel.IsSet()) return false;
+  if (Now() >= deadline) return true;
+
+  m_deadlines.insert(deadline);
+  MaybeAutoAdvanceLocked();
+
+  // the signal can't reach this condition variable, so it is polled
+  while (Now() < deadline) {
+    if (cancel.IsSet()) {
+      m_deadlines.erase(m_deadlines.find(deadline));
+      return false;
+    }
+    m_wakeup.wait_for(lock, c_simulatedHostSlice);
+  }
+  return true;
+}
+
+DriverDuration SimulatedClock::MaxHostWait(DriverDuration remaining) {
+  return std::min(remaining, c_simulatedHostSlice);
+}
+
+void SimulatedClock::AdvanceBy(DriverDuration duration) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  AdvanceToLocked(Now() + duration);
+}
+
+void SimulatedClock::AdvanceTo(DriverTimePoint time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  AdvanceToLocked(time);
+}
+
+bool SimulatedClock::AdvanceToNextWakeup() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_deadlines.empty()) return false;
+
+  AdvanceToLocked(*m_deadlines.begin());
+  return true;
+}
+
+void SimulatedClock::SetParticipants(int participants) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_participants = participants;
+  MaybeAutoAdvanceLocked();
+}
+
+size_t SimulatedClock::SleepingCount() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_deadlines.size();
+}
+
+void SimulatedClock::AdvanceToLocked(DriverTimePoint time) {
+  // time never runs backwards, even if a caller asks it to
+  if (time <= Now()) return;
+
+  m_nowNs.store(time.time_since_epoch().count(), std::memory_order_release);
+  m_deadlines.erase(m_deadlines.begin(), m_deadlines.upper_bound(time));
+  m_wakeup.notify_all();
+}
+
+void SimulatedClock::MaybeAutoAdvanceLocked() {
+  if (m_participants <= 0 || m_deadlines.size() < static_cast<size_t>(m_participants)) return;
+
+  AdvanceToLocked(*m_deadlines.begin());
+}
+
+Ticker::Ticker(IClock& clock, DriverDuration period)
+    : m_clock(clock), m_period(period), m_nextTick(clock.Now() + period) {}
+
+void Ticker::Wait() {
+  m_clock.SleepUntil(m_nextTick);
+
+  const DriverTimePoint now = m_clock.Now();
+  m_nextTick += m_period;
+  if (m_nextTick < now) m_nextTick = now + m_period;
+}
+
+void Ticker::SetPeriod(DriverDuration period) {
+  m_nextTick += period - m_period;
+  m_period = period;
+}
+
+namespace {
+std::unique_ptr<IClock> g_ownedClock = std::make_unique<SystemClock>();
+std::atomic<IClock*> g_driverClock{g_ownedClock.get()};
+}  // namespace
+
+IClock& DriverClock() { return *g_driverClock.load(std::memory_order_acquire); }
+
+void SetDriverClock(std::unique_ptr<IClock> clock) {
+  if (!clock) clock = std::make_unique<SystemClock>();
+
+  g_driverClock.store(clock.get(), std::memory_order_release);
+  g_ownedClock = std::move(clock);
+}
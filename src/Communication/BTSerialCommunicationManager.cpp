@@ -1,12 +1,22 @@
 #include <Communication/BTSerialCommunicationManager.h>
 
+#include "Clock.h"
+
 //Adapted from Finally Functional's SerialBT implementation
 
-BTSerialCommunicationManager::BTSerialCommunicationManager(const VRBTSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager) 
+//a glove streams continuously, this long without a packet means the link is gone
+static const DriverDuration c_watchdogTimeout = std::chrono::seconds(3);
+static const DriverDuration c_connectTimeout = std::chrono::seconds(10);
+
+BTSerialCommunicationManager::BTSerialCommunicationManager(const VRBTSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager, IoReactor* ioReactor) 
 	: m_btSerialConfiguration(configuration), 
 	m_encodingManager(std::move(encodingManager)), 
-	m_isConnected(false) 
+	m_isConnected(false),
+	m_waiter(configuration.waitStrategy, m_threadActive),
+	m_ioReactor(ioReactor)
 {
+	if (m_ioReactor) m_reconnectTimer = std::make_unique<DriverTimer>(m_ioReactor->Context());
+
 	//convert the bluetooth device name from settings into wide
 	//const char* name = configuration.name.c_str();
 	//size_t newsize = strlen(name) + 1;
@@ -21,7 +31,28 @@ BTSerialCommunicationManager::BTSerialCommunicationManager(const VRBTSerialConfi
 
 };
 
+BTSerialCommunicationManager::~BTSerialCommunicationManager() {
+	StopListener();
+	if (m_readEvent != WSA_INVALID_EVENT) WSACloseEvent(m_readEvent);
+
+	//the socket has to be closed while winsock is still up
+	m_asyncReader.reset();
+	m_socket.reset();
+	closeEsp32Socket();
+	if (m_winsockStarted) WSACleanup();
+}
+
 void BTSerialCommunicationManager::Connect() {
+	if (m_ioReactor) {
+		//nothing waits on the search, which takes seconds. This can be called on the reactor thread itself
+		m_connecting = true;
+		m_ioReactor->RunSync([&]() {
+			m_asyncStopped = false;
+			StartConnecting(false);
+		});
+		return;
+	}
+
 	DriverLog("Trying to connect to bluetooth");
 	
 	//We're not yet connected
@@ -50,62 +81,284 @@ void BTSerialCommunicationManager::Connect() {
 	}
 }
 
-void BTSerialCommunicationManager::BeginListener(const std::function<void(VRCommData_t)>& callback) {
+void BTSerialCommunicationManager::BeginListener(const std::function<void(const PackedSample&)>& callback) {
 	DriverLog("Begun listener");
+	if (m_ioReactor) {
+		m_ioReactor->RunSync([&]() {
+			m_callback = callback;
+			//otherwise the connect still running starts it once the socket is up
+			if (m_isConnected && !m_asyncReader) BeginAsyncListener();
+		});
+		return;
+	}
+
+	if (m_btSerialConfiguration.pipeline.enabled) {
+		m_pipeline = std::make_unique<FramePipeline>(m_btSerialConfiguration.pipeline.ringSize, m_btSerialConfiguration.pipeline.backpressure);
+	}
+
+	//the socket stays non-blocking, the event only lets waits include the stop event
+	if (m_readEvent == WSA_INVALID_EVENT) m_readEvent = WSACreateEvent();
+	if (WSAEventSelect(m_btClientSocket, m_readEvent, FD_READ | FD_CLOSE) == SOCKET_ERROR) {
+		DriverLog("Could not select socket events. Error %ld", WSAGetLastError());
+	}
+
+	m_stopEvent.Reset();
 	m_threadActive = true;
 	m_serialThread = std::thread(&BTSerialCommunicationManager::ListenerThread, this, callback);
 }
 
-void BTSerialCommunicationManager::ListenerThread(const std::function<void(VRCommData_t)>& callback) {
+void BTSerialCommunicationManager::ListenerThread(const std::function<void(const PackedSample&)>& callback) {
 	//DebugDriverLog("In listener thread");
-	std::this_thread::sleep_for(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
+	m_stopEvent.SleepFor(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
 
-	while (m_threadActive) {
-		std::string receivedString;
-		bool readSuccessful = ReceiveNextPacket(receivedString);
-		
-		if (readSuccessful) {
-			try {
-				VRCommData_t commData = m_encodingManager->Decode(receivedString);
-				callback(commData);
+	if (m_pipeline) {
+		PipelinedListen(callback);
+	}
+	else {
+		std::string_view frame;
+		while (m_threadActive) {
+			if (ReceiveNextPacket(frame)) {
+				DecodeFrame(frame, callback);
 			}
-			catch (const std::invalid_argument& ia) {
-				DriverLog("Received error from encoding manager. Skipping...");
+			else {
+				if (m_threadActive) DriverLog("Detected that arduino has disconnected! Stopping listener...");
+				//We should probably do more logic for trying to reconnect to the arduino
+				//For now, it should be obvious to people that the arduinos have disconnected
+				m_threadActive = false;
 			}
 		}
-		else {
-			DriverLog("Detected that arduino has disconnected! Stopping listener...");
-			//We should probably do more logic for trying to reconnect to the arduino
-			//For now, it should be obvious to people that the arduinos have disconnected
+	}
+
+	const TransportWaitStats& waitStats = m_waiter.Stats();
+	DebugDriverLog("Bluetooth listener stopped. Waits: %llu, spin hits: %llu, blocks: %llu, spin time: %.1fms",
+		waitStats.waits.load(), waitStats.spinHits.load(), waitStats.blocks.load(), waitStats.spinTimeNs.load() / 1e6);
+	DebugDriverLog("Bluetooth framing: %llu oversized frames, %llu bytes dropped",
+		m_frameBuffer.OversizedFrames(), m_frameBuffer.DroppedBytes());
+}
+
+void BTSerialCommunicationManager::PipelinedListen(const std::function<void(const PackedSample&)>& callback) {
+	//decoding and the callback get their own thread, this one only moves bytes from the socket into the ring
+	std::thread decodeThread([&]() {
+		std::string_view frame;
+		while (m_pipeline->NextFrame(frame)) {
+			DecodeFrame(frame, callback);
+			m_pipeline->Release();
+		}
+	});
+
+	while (m_threadActive) {
+		size_t room = 0;
+		char* writePtr = m_pipeline->PrepareWrite(room);
+		if (writePtr == nullptr) break;
+
+		int bytesRead = 0;
+		if (!ReadAvailable(writePtr, room, bytesRead)) {
+			if (m_threadActive) DriverLog("Detected that arduino has disconnected! Stopping listener...");
 			m_threadActive = false;
+			break;
 		}
 
+		m_pipeline->Commit(bytesRead);
+		if (bytesRead > 0) m_waiter.OnArrival();
 	}
+
+	m_pipeline->Stop();
+	decodeThread.join();
+
+	const FramePipelineStats& stats = m_pipeline->Stats();
+	DebugDriverLog("Bluetooth pipeline: %llu frames, %llu dropped (%llu bytes), %llu reader stalls, ring peaked at %zu of %zu bytes",
+		stats.framesPublished.load(), stats.framesDropped.load(), stats.bytesDropped.load(), stats.readerStalls.load(),
+		stats.highWaterBytes.load(), m_pipeline->Capacity());
 }
 
-bool BTSerialCommunicationManager::ReceiveNextPacket(std::string& buff) {
-	char nextChar[1];
-	do {
-		int recievedMessageLength = 1;
-		int recieveResult = recv(m_btClientSocket, nextChar, recievedMessageLength, 0); //if your socket is blocking, this will block until a
-		if (recieveResult < 0)                                                               //a message is recieved. If not, it will return right 
-		{                                                                                    //away
-			continue;
-		}
-		buff += nextChar[0];
-	} while (nextChar[0] != '\n' || buff.length() < 1);
-	
-	//("Packet Recieved! Length: %i, %s", buff.length(), buff.c_str());
+void BTSerialCommunicationManager::DecodeFrame(std::string_view frame, const std::function<void(const PackedSample&)>& callback) {
+	try {
+		VRCommData_t commData = m_encodingManager->Decode(frame);
+		callback(PackSample(commData, m_sequence++, DriverClock().Now().time_since_epoch().count()));
+	}
+	catch (const std::invalid_argument& ia) {
+		DriverLog("Received error from encoding manager. Skipping...");
+	}
+}
+
+bool BTSerialCommunicationManager::ReceiveNextPacket(std::string_view& frame) {
+	while (!m_frameBuffer.NextFrame(frame)) {
+		int bytesRead = 0;
+		if (!ReadAvailable(m_frameBuffer.WritePtr(), m_frameBuffer.WritableBytes(), bytesRead)) return false;
+
+		m_frameBuffer.Commit(bytesRead);
+		//the arrival model is of reads, and a read can carry several frames
+		if (bytesRead > 0) m_waiter.OnArrival();
+	}
 
 	return true;
 }
 
+bool BTSerialCommunicationManager::ReadAvailable(char* buffer, size_t room, int& bytesRead) {
+	while (true) {
+		//the socket is non-blocking, so this returns right away with whatever has arrived
+		int recieveResult = recv(m_btClientSocket, buffer, (int)room, 0);
+		if (recieveResult == 0) return false; //connection was closed
+
+		if (recieveResult > 0) {
+			bytesRead = recieveResult;
+			return true;
+		}
+
+		if (WSAGetLastError() != WSAEWOULDBLOCK) return false;
+
+		//nothing to read yet, wait for more data the way the configured strategy says to
+		const bool dataReady = m_waiter.Wait(
+			[&]() { return PollBytesAvailable(); },
+			[&](DriverDuration timeout) { return WaitForBytes(timeout); });
+		if (!dataReady) return false;
+	}
+}
+
+int BTSerialCommunicationManager::PollBytesAvailable() {
+	u_long bytesAvailable = 0;
+	if (ioctlsocket(m_btClientSocket, FIONREAD, &bytesAvailable) != 0) return -1;
+
+	return bytesAvailable > 0 ? 1 : 0;
+}
+
+bool BTSerialCommunicationManager::WaitForBytes(DriverDuration timeout) {
+	const WSAEVENT events[] = { m_readEvent, m_stopEvent.Handle() };
+	const DWORD waitResult = StopEvent::WaitOnClock(timeout, WSA_WAIT_TIMEOUT, [&](DWORD milliseconds) {
+		return WSAWaitForMultipleEvents(2, events, FALSE, milliseconds, FALSE);
+	});
+
+	if (waitResult == WSA_WAIT_EVENT_0) {
+		//resets the event, recv re-arms FD_READ for the next data
+		WSANETWORKEVENTS networkEvents;
+		return WSAEnumNetworkEvents(m_btClientSocket, m_readEvent, &networkEvents) != SOCKET_ERROR;
+	}
+
+	//a timeout is fine, the waiter polls again afterwards
+	return waitResult == WSA_WAIT_TIMEOUT;
+}
+
+asio::awaitable<bool> BTSerialCommunicationManager::ConnectAsync() {
+	DriverLog("Trying to connect to bluetooth");
+	m_isConnected = false;
+
+	//inquiry takes a few seconds and has no async form
+	const bool found = co_await RunBlocking(m_ioReactor->BlockingPool(), [&]() { return getPairedEsp32BtAddress(); });
+	if (!found) {
+		DriverLog("Error getting Bluetooth address");
+		co_return false;
+	}
+	if (!startupWindowsSocket()) {
+		DriverLog("Error Initializing windows sockets");
+		co_return false;
+	}
+
+	memset(&m_btSocketAddress, 0, sizeof(m_btSocketAddress));
+	m_btSocketAddress.addressFamily = AF_BTH;
+	m_btSocketAddress.serviceClassId = RFCOMM_PROTOCOL_UUID;
+	m_btSocketAddress.port = 0;
+	m_btSocketAddress.btAddr = m_esp32BtAddress;
+	const asio::generic::stream_protocol::endpoint endpoint(&m_btSocketAddress, sizeof(m_btSocketAddress), BTHPROTO_RFCOMM);
+
+	//only handed over once connected, a Disconnect() meanwhile must not close it under the pending connect
+	auto socket = std::make_unique<asio::generic::stream_protocol::socket>(m_ioReactor->Context());
+	try {
+		socket->open(endpoint.protocol());
+		co_await AsyncConnect(*socket, endpoint, c_connectTimeout);
+	}
+	catch (const asio::system_error& e) {
+		DriverLog("Could not connect socket to ESP32. Error %s", e.what());
+		co_return false;
+	}
+
+	m_socket = std::move(socket);
+	m_isConnected = true;
+	DriverLog("Connected to bluetooth!");
+	co_return true;
+}
+
+void BTSerialCommunicationManager::StartConnecting(bool backOffFirst) {
+	//an attempt that is already running carries on, Connect() straight after Disconnect() reuses it
+	if (m_connectInFlight) return;
+	m_connectInFlight = true;
+
+	asio::co_spawn(m_ioReactor->Context(), ConnectAndListenAsync(backOffFirst), [this](std::exception_ptr) {
+		m_connectInFlight = false;
+		//a cancelled backoff ends the coroutine with operation_aborted. If Connect() came in while it was
+		//unwinding, nothing else is going to connect
+		if (!m_asyncStopped && !m_isConnected) StartConnecting(false);
+	});
+}
+
+asio::awaitable<void> BTSerialCommunicationManager::ConnectAndListenAsync(bool backOffFirst) {
+	bool backOff = backOffFirst;
+	while (true) {
+		if (backOff) co_await AsyncSleep(*m_reconnectTimer, m_reconnectBackoff.Next());
+		if (m_asyncStopped) co_return;
+		if (co_await ConnectAsync()) break;
+		//a device that isn't there yet is retried the same way as one that dropped out
+		backOff = true;
+	}
+
+	//disconnected while the last attempt was in flight
+	if (m_asyncStopped) {
+		CloseAsync();
+		co_return;
+	}
+
+	m_reconnectBackoff.Reset();
+	if (m_callback && !m_asyncReader) BeginAsyncListener();
+}
+
+void BTSerialCommunicationManager::BeginAsyncListener() {
+	m_asyncStopped = false;
+
+	m_asyncReader = std::make_shared<AsyncFrameReader<asio::generic::stream_protocol::socket>>(
+		*m_socket, m_frameBuffer, c_watchdogTimeout,
+		[&](std::string_view frame) { OnAsyncFrame(frame); },
+		[&](const asio::error_code& ec) { OnAsyncError(ec); });
+	m_asyncReader->Start(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
+}
+
+void BTSerialCommunicationManager::OnAsyncFrame(std::string_view frame) {
+	DecodeFrame(frame, m_callback);
+}
+
+void BTSerialCommunicationManager::OnAsyncError(const asio::error_code& ec) {
+	DriverLog("Bluetooth connection lost (%s). Reconnecting...", ec.message().c_str());
+	CloseAsync();
+
+	StartConnecting(true);
+}
+
+void BTSerialCommunicationManager::CloseAsync() {
+	if (m_asyncReader) {
+		m_asyncReader->Stop();
+		m_asyncReader.reset();
+	}
+
+	asio::error_code ec;
+	if (m_socket) {
+		m_socket->shutdown(asio::socket_base::shutdown_both, ec);
+		m_socket->close(ec);
+		m_socket.reset();
+	}
+	m_isConnected = false;
+}
+
 void BTSerialCommunicationManager::Disconnect() {
+	if (m_ioReactor) {
+		m_connecting = false;
+		m_ioReactor->RunSync([&]() {
+			m_asyncStopped = true;
+			m_reconnectTimer->cancel();
+			CloseAsync();
+		});
+		return;
+	}
+
 	if (m_isConnected) {
-		if (m_threadActive) {
-			m_threadActive = false;
-			m_serialThread.join();
-		}
+		StopListener();
 		m_isConnected = false;
 		//CloseHandle(m_hSerial);
 
@@ -117,10 +370,24 @@ void BTSerialCommunicationManager::Disconnect() {
 		else
 			DriverLog("Disconnected from socket successfully.");
 	}
+
+	//every reconnect creates a new socket, so this one has to be released
+	closeEsp32Socket();
 }
+
+void BTSerialCommunicationManager::StopListener() {
+	//the listener may already have stopped itself after losing the device, it still has to be joined
+	m_threadActive = false;
+	m_stopEvent.Set();
+	//the reader can also be parked waiting for ring space, the decoder for frames
+	if (m_pipeline) m_pipeline->Stop();
+
+	if (m_serialThread.joinable()) m_serialThread.join();
+}
+
 //May want to get a heartbeat here instead?
 bool BTSerialCommunicationManager::IsConnected() {
-	return m_isConnected;
+	return m_isConnected || m_connecting;
 }
 
 /// <summary>
@@ -172,8 +439,11 @@ bool BTSerialCommunicationManager::getPairedEsp32BtAddress() {
 
 /// <summary>
 /// Windows sockets need an initialization method called before they are used.
+/// Only the first call does anything, the destructor releases it again.
 /// </summary>
 bool BTSerialCommunicationManager::startupWindowsSocket() {
+	if (m_winsockStarted) return true;
+
 	WORD wVersionRequested;
 	WSADATA wsaData;
 	wVersionRequested = MAKEWORD(2, 2);
@@ -182,6 +452,7 @@ bool BTSerialCommunicationManager::startupWindowsSocket() {
 		DebugDriverLog("WSAStartup failed with error: %d", wsaStartupError);
 		return false;
 	}
+	m_winsockStarted = true;
 	return true;
 }
 
@@ -189,6 +460,8 @@ bool BTSerialCommunicationManager::startupWindowsSocket() {
 /// Sets up bluetooth socket to communicate with ESP32.
 /// </summary>
 bool BTSerialCommunicationManager::connectToEsp32() {
+	//a failed attempt leaves its socket behind for the next one to replace
+	closeEsp32Socket();
 	m_btClientSocket = socket(AF_BTH, SOCK_STREAM, BTHPROTO_RFCOMM); //initialize BT windows socket
 	memset(&m_btSocketAddress, 0, sizeof(m_btSocketAddress));
 	m_btSocketAddress.addressFamily = AF_BTH;
@@ -198,12 +471,14 @@ bool BTSerialCommunicationManager::connectToEsp32() {
 	if (connect(m_btClientSocket, (SOCKADDR*)&m_btSocketAddress, sizeof(m_btSocketAddress)) != 0) //connect to the BT device.
 	{
 		DriverLog("Could not connect socket to ESP32. Error %ld", WSAGetLastError());
+		closeEsp32Socket();
 		return false;
 	}
 	unsigned long nonBlockingMode = 1;
 	if (ioctlsocket(m_btClientSocket, FIONBIO, (unsigned long*)&nonBlockingMode) != 0) //set the socket to be non-blocking, meaning
 	{                                                                                //it will return right away when sending/recieving
 		DriverLog("Could not set socket to be non-blocking.");
+		closeEsp32Socket();
 		return false;
 	}
 	return true;
@@ -214,9 +489,15 @@ bool BTSerialCommunicationManager::sendMessageToEsp32() {
 	int sendResult = send(m_btClientSocket, message, (int)strlen(message), 0); //send your message to the BT device
 	if (sendResult == SOCKET_ERROR) {
 		DriverLog("Sending to ESP32 failed. Error code %d", WSAGetLastError());
-		closesocket(m_btClientSocket);
-		WSACleanup();
+		closeEsp32Socket();
 		return false;
 	}
 	return true;
+}
+
+void BTSerialCommunicationManager::closeEsp32Socket() {
+	if (m_btClientSocket == INVALID_SOCKET) return;
+
+	closesocket(m_btClientSocket);
+	m_btClientSocket = INVALID_SOCKET;
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "Communication/BaudProbe.h"
+
+#include <algorithm>
+#include <string_view>
+
+bool BaudProbe::Commit(size_t bytes) {
+  m_frameBuffer.Commit(bytes);
+
+  std::string_view frame;
+  while (!Matched() && m_frameBuffer.NextFrame(frame)) {
+    if (!m_skippedFirst) {
+      m_skippedFirst = true;
+      continue;
+    }
+
+    const bool printable =
+        frame.size() > 1 && std::all_of(frame.begin(), frame.end() - 1, [](char c) {
+          return (c >= 0x20 && c < 0x7f) || c == '\r';
+        });
+    m_cleanFrames = printable ? m_cleanFrames + 1 : 0;
+  }
+
+  return Matched();
+}
@@ -0,0 +1,93 @@
+#include "Communication/FrameBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameBuffer::FrameBuffer(size_t capacity, size_t maxFrameSize)
+    : m_buffer(capacity),
+      // a partial frame must never fill the buffer, or the next read would have nowhere to land
+      m_maxFrameSize(std::min(maxFrameSize, capacity - capacity / 4)) {}
+
+void FrameBuffer::Commit(size_t bytes) { m_writePos += bytes; }
+
+bool FrameBuffer::NextFrame(std::string_view& frame) {
+  if (ScanFrame(frame)) return true;
+
+  Compact();
+  return false;
+}
+
+size_t FrameBuffer::NextFrames(std::string_view* frames, size_t maxFrames) {
+  size_t count = 0;
+  while (count < maxFrames && ScanFrame(frames[count])) count++;
+
+  if (count == 0) Compact();
+  return count;
+}
+
+bool FrameBuffer::ScanFrame(std::string_view& frame) {
+  const char* begin = m_buffer.Data();
+
+  while (true) {
+    const void* terminator = std::memchr(begin + m_scanPos, '\n', m_writePos - m_scanPos);
+
+    if (terminator == nullptr) {
+      m_scanPos = m_writePos;
+      if (m_discarding || m_writePos - m_readPos > m_maxFrameSize) DropPending();
+      return false;
+    }
+
+    const size_t end = static_cast<const char*>(terminator) - begin + 1;
+    const size_t length = end - m_readPos;
+
+    m_readPos = end;
+    m_scanPos = end;
+
+    if (m_discarding || length > m_maxFrameSize) {
+      // the tail of a frame whose start was already dropped, or one that arrived in a single read
+      if (!m_discarding) m_oversizedFrames++;
+      m_droppedBytes += length;
+      m_discarding = false;
+      continue;
+    }
+
+    frame = std::string_view(begin + end - length, length);
+    return true;
+  }
+}
+
+void FrameBuffer::Clear() {
+  m_readPos = 0;
+  m_scanPos = 0;
+  m_writePos = 0;
+  m_discarding = false;
+}
+
+void FrameBuffer::DropPending() {
+  if (!m_discarding) m_oversizedFrames++;
+
+  m_droppedBytes += m_writePos - m_readPos;
+  m_readPos = 0;
+  m_scanPos = 0;
+  m_writePos = 0;
+  m_discarding = true;
+}
+
+void FrameBuffer::Compact() {
+  if (m_readPos == m_writePos) {
+    m_readPos = 0;
+    m_scanPos = 0;
+    m_writePos = 0;
+    return;
+  }
+
+  // Only pay for the move once the tail is running out of room.
+  if (WritableBytes() >= m_buffer.Size() / 4) return;
+
+  const size_t pending = m_writePos - m_readPos;
+  std::memmove(m_buffer.Data(), m_buffer.Data() + m_readPos, pending);
+
+  m_scanPos -= m_readPos;
+  m_writePos = pending;
+  m_readPos = 0;
+}
@@ -0,0 +1,197 @@
+#include "Communication/FramePipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// where reads land while the DROP policy throws data away
+constexpr size_t c_scratchSize = 4096;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t size = 1;
+  while (size < value) size <<= 1;
+  return size;
+}
+}  // namespace
+
+FramePipeline::FramePipeline(size_t capacity, VRBackpressurePolicy policy, size_t maxFrameSize)
+    : // a partial frame must never be able to fill the ring on its own
+      m_mask(RoundUpToPowerOfTwo(std::max(capacity, maxFrameSize * 4)) - 1),
+      m_maxFrameSize(maxFrameSize),
+      m_policy(policy),
+      m_data(m_mask + 1),
+      // frames are rarely shorter than this, and running out of slices only costs a wait or a drop
+      m_frames((m_mask + 1) / 16),
+      m_scratch(c_scratchSize) {}
+
+char* FramePipeline::PrepareWrite(size_t& room) {
+  while (true) {
+    const uint32_t releases = m_releases.load(std::memory_order_seq_cst);
+    if (m_stopped.load(std::memory_order_acquire)) return nullptr;
+
+    // a partial frame is sitting at the very end of the ring, move it to the front so the frame
+    // stays contiguous. This is the only copy a frame can go through
+    const size_t pending = m_writePos - m_frameStart;
+    if ((m_writePos & m_mask) == 0 && pending > 0) {
+      if (FreeBytes() >= pending) {
+        std::memcpy(m_data.Data(), m_data.Data() + (m_frameStart & m_mask), pending);
+        m_frameStart = m_writePos;
+        m_writePos += pending;
+        m_scanPos = m_writePos;
+        continue;
+      }
+    } else {
+      room = std::min(FreeBytes(), Capacity() - (m_writePos & m_mask));
+      if (room > 0) return m_data.Data() + (m_writePos & m_mask);
+    }
+
+    // full. Dropped bytes are only freed once the decoder is told about them
+    FlushSkipped();
+
+    if (m_policy == BACKPRESSURE_DROP) {
+      if (pending > 0) {
+        DropPartial();
+        continue;
+      }
+
+      m_writingScratch = true;
+      room = c_scratchSize;
+      return m_scratch.Data();
+    }
+
+    m_stats.readerStalls.fetch_add(1, std::memory_order_relaxed);
+    WaitForRelease(releases);
+  }
+}
+
+void FramePipeline::Commit(size_t bytes) {
+  if (m_writingScratch) {
+    m_writingScratch = false;
+    if (bytes == 0) return;
+
+    m_stats.bytesDropped.fetch_add(bytes, std::memory_order_relaxed);
+    m_stats.framesDropped.fetch_add(std::count(m_scratch.Data(), m_scratch.Data() + bytes, '\n'),
+                                    std::memory_order_relaxed);
+    // the frame after the last terminator lost its start as well
+    m_discarding = m_scratch.Data()[bytes - 1] != '\n';
+    return;
+  }
+
+  m_writePos += bytes;
+
+  const size_t used = m_writePos - m_readPos.load(std::memory_order_relaxed);
+  if (used > m_stats.highWaterBytes.load(std::memory_order_relaxed))
+    m_stats.highWaterBytes.store(used, std::memory_order_relaxed);
+
+  // [m_scanPos, m_writePos) is always the chunk just written, which never wraps
+  while (m_scanPos < m_writePos) {
+    const char* chunk = m_data.Data() + (m_scanPos & m_mask);
+    const void* terminator = std::memchr(chunk, '\n', m_writePos - m_scanPos);
+    if (terminator == nullptr) {
+      m_scanPos = m_writePos;
+      break;
+    }
+
+    const size_t end = m_scanPos + (static_cast<const char*>(terminator) - chunk) + 1;
+    const size_t length = end - m_frameStart;
+    m_scanPos = end;
+
+    if (m_discarding || length > m_maxFrameSize) {
+      m_stats.framesDropped.fetch_add(1, std::memory_order_relaxed);
+      m_stats.bytesDropped.fetch_add(length, std::memory_order_relaxed);
+      m_discarding = false;
+      m_frameStart = end;
+      continue;
+    }
+
+    const FrameSlice slice{m_frameStart, length, false};
+    m_frameStart = end;
+
+    while (!TryPublish(slice)) {
+      if (m_policy == BACKPRESSURE_DROP) {
+        m_stats.framesDropped.fetch_add(1, std::memory_order_relaxed);
+        m_stats.bytesDropped.fetch_add(length, std::memory_order_relaxed);
+        break;
+      }
+
+      const uint32_t releases = m_releases.load(std::memory_order_seq_cst);
+      if (m_stopped.load(std::memory_order_acquire)) return;
+      if (TryPublish(slice)) break;
+
+      m_stats.readerStalls.fetch_add(1, std::memory_order_relaxed);
+      WaitForRelease(releases);
+    }
+  }
+
+  if (m_discarding || m_writePos - m_frameStart > m_maxFrameSize) DropPartial();
+}
+
+bool FramePipeline::NextFrame(std::string_view& frame) {
+  while (true) {
+    const uint32_t published = m_published.load(std::memory_order_seq_cst);
+
+    FrameSlice slice;
+    if (m_frames.TryPop(slice)) {
+      m_releaseTo = slice.start + slice.length;
+      if (slice.skip) {
+        Release();
+        continue;
+      }
+
+      frame = std::string_view(m_data.Data() + (slice.start & m_mask), slice.length);
+      return true;
+    }
+
+    if (m_stopped.load(std::memory_order_acquire)) return false;
+
+    m_decoderWaiting.store(true, std::memory_order_seq_cst);
+    m_published.wait(published, std::memory_order_seq_cst);
+    m_decoderWaiting.store(false, std::memory_order_relaxed);
+  }
+}
+
+void FramePipeline::Release() {
+  m_readPos.store(m_releaseTo, std::memory_order_release);
+  m_releases.fetch_add(1, std::memory_order_seq_cst);
+  if (m_readerWaiting.load(std::memory_order_seq_cst)) m_releases.notify_one();
+}
+
+void FramePipeline::Stop() {
+  m_stopped.store(true, std::memory_order_release);
+
+  m_published.fetch_add(1, std::memory_order_seq_cst);
+  m_published.notify_all();
+  m_releases.fetch_add(1, std::memory_order_seq_cst);
+  m_releases.notify_all();
+}
+
+bool FramePipeline::TryPublish(const FrameSlice& slice) {
+  if (!m_frames.TryPush(slice)) return false;
+
+  m_publishedEnd = slice.start + slice.length;
+  m_stats.framesPublished.fetch_add(slice.skip ? 0 : 1, std::memory_order_relaxed);
+
+  m_published.fetch_add(1, std::memory_order_seq_cst);
+  if (m_decoderWaiting.load(std::memory_order_seq_cst)) m_published.notify_one();
+  return true;
+}
+
+void FramePipeline::FlushSkipped() {
+  if (m_frameStart > m_publishedEnd) TryPublish(FrameSlice{m_frameStart, 0, true});
+}
+
+void FramePipeline::WaitForRelease(uint32_t seen) {
+  m_readerWaiting.store(true, std::memory_order_seq_cst);
+  m_releases.wait(seen, std::memory_order_seq_cst);
+  m_readerWaiting.store(false, std::memory_order_relaxed);
+}
+
+void FramePipeline::DropPartial() {
+  const size_t pending = m_writePos - m_frameStart;
+  if (pending > 0) m_stats.bytesDropped.fetch_add(pending, std::memory_order_relaxed);
+
+  // the frame is counted once its terminator turns up
+  m_discarding = true;
+  m_writePos = m_frameStart;
+  m_scanPos = m_writePos;
+}
@@ -0,0 +1,63 @@
+#include "Communication/IoReactor.h"
+
+#include <algorithm>
+#include <future>
+
+#include "DriverLog.h"
+
+static const DriverDuration c_minReconnectDelay = std::chrono::milliseconds(500);
+static const DriverDuration c_maxReconnectDelay = std::chrono::seconds(10);
+
+IoReactor::IoReactor() : m_workGuard(asio::make_work_guard(m_context)) {}
+
+IoReactor::~IoReactor() { Stop(); }
+
+void IoReactor::Start() {
+  if (m_thread.joinable()) return;
+
+  m_thread = std::thread([this]() {
+    while (true) {
+      try {
+        m_context.run();
+        break;
+      } catch (const std::exception& e) {
+        // one misbehaving handler shouldn't take every device down with it
+        DriverLog("Exception escaped an io handler: %s", e.what());
+      }
+    }
+  });
+}
+
+void IoReactor::Stop() {
+  if (!m_thread.joinable()) return;
+
+  m_workGuard.reset();
+  m_context.stop();
+  m_thread.join();
+
+  // a blocking call can't be interrupted, wait for whatever is still running to return
+  m_blockingPool.join();
+}
+
+void IoReactor::RunSync(const std::function<void()>& fn) {
+  if (m_context.get_executor().running_in_this_thread() || !m_thread.joinable()) {
+    fn();
+    return;
+  }
+
+  std::promise<void> done;
+  asio::post(m_context, [&]() {
+    try {
+      fn();
+      done.set_value();
+    } catch (...) {
+      done.set_exception(std::current_exception());
+    }
+  });
+  done.get_future().get();
+}
+
+DriverDuration ReconnectBackoff::Next() {
+  m_delay = std::clamp(2 * m_delay, c_minReconnectDelay, c_maxReconnectDelay);
+  return m_delay;
+}
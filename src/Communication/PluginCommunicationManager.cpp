@@ -0,0 +1,96 @@
+#include "Communication/PluginCommunicationManager.h"
+
+#include <string_view>
+
+#include "DriverLog.h"
+#include "Encode/PackedSample.h"
+
+// bounds how long stopping takes when the plugin cannot interrupt a read
+static const uint32_t c_readTimeoutMs = 100;
+// frames decoded per DecodeBatch() call, a read rarely completes more
+static const size_t c_maxBatchFrames = 64;
+
+PluginCommunicationManager::PluginCommunicationManager(
+    const OpengloveTransportApi* transport, std::string config,
+    std::unique_ptr<IEncodingManager> encodingManager)
+    : m_transport(transport),
+      m_config(std::move(config)),
+      m_encodingManager(std::move(encodingManager)) {}
+
+PluginCommunicationManager::~PluginCommunicationManager() { Disconnect(); }
+
+void PluginCommunicationManager::Connect() {
+  if (m_instance != nullptr) return;
+
+  m_instance = m_transport->Open(m_config.c_str());
+  m_isConnected = m_instance != nullptr;
+
+  if (!m_isConnected) DebugDriverLog("Plugin transport %s could not connect", m_transport->name);
+}
+
+void PluginCommunicationManager::BeginListener(
+    const std::function<void(const PackedSample&)>& callback) {
+  if (m_instance == nullptr || m_thread.joinable()) return;
+
+  m_threadActive = true;
+  m_thread = std::thread(&PluginCommunicationManager::ListenerThread, this, callback);
+}
+
+bool PluginCommunicationManager::IsConnected() { return m_isConnected; }
+
+void PluginCommunicationManager::Disconnect() {
+  StopListener();
+
+  if (m_instance != nullptr) {
+    m_transport->Close(m_instance);
+    m_instance = nullptr;
+  }
+  m_isConnected = false;
+}
+
+void PluginCommunicationManager::StopListener() {
+  // the listener may already have stopped itself after losing the device, it still has to be joined
+  m_threadActive = false;
+  if (m_instance != nullptr && m_transport->Interrupt != nullptr) {
+    m_transport->Interrupt(m_instance);
+  }
+
+  if (m_thread.joinable()) m_thread.join();
+}
+
+void PluginCommunicationManager::ListenerThread(
+    const std::function<void(const PackedSample&)>& callback) {
+  std::string_view frames[c_maxBatchFrames];
+  PackedSample samples[c_maxBatchFrames];
+  uint64_t reads = 0;
+  uint64_t batches = 0;
+
+  while (m_threadActive) {
+    const int32_t bytesRead =
+        m_transport->Read(m_instance, m_frameBuffer.WritePtr(),
+                          static_cast<uint32_t>(m_frameBuffer.WritableBytes()), c_readTimeoutMs);
+    if (bytesRead < 0) {
+      if (m_threadActive) DebugDriverLog("Plugin transport %s lost the device", m_transport->name);
+      m_threadActive = false;
+      break;
+    }
+    if (bytesRead == 0) continue;
+
+    reads++;
+    m_frameBuffer.Commit(static_cast<size_t>(bytesRead));
+
+    size_t count;
+    while ((count = m_frameBuffer.NextFrames(frames, c_maxBatchFrames)) > 0) {
+      batches++;
+      const size_t decoded = m_encodingManager->DecodeBatch(frames, count, samples);
+
+      for (size_t i = 0; i < decoded; i++) {
+        samples[i].sequence = m_sequence++;
+        callback(samples[i]);
+      }
+    }
+  }
+
+  DebugDriverLog("Plugin transport %s stopped. %llu reads, %llu batches, %llu oversized frames",
+                 m_transport->name, reads, batches, m_frameBuffer.OversizedFrames());
+}
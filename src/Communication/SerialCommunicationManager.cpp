@@ -1,22 +1,65 @@
 #include <Communication/SerialCommunicationManager.h>
 
+#include <algorithm>
 #include <chrono>
+#include "Clock.h"
+#include "Communication/BaudProbe.h"
 #include "DriverLog.h"
 
+//a glove streams continuously, this long without a packet means the link is gone
+static const DriverDuration c_watchdogTimeout = std::chrono::seconds(3);
+
+//highest rate usb-serial bridges on the supported boards run reliably at
+static const DWORD c_maxBaudRate = 2000000;
+//how long to listen at each rate before trying the next
+static const DriverDuration c_baudProbeTime = std::chrono::milliseconds(300);
+static const DriverDuration c_baudProbePollInterval = std::chrono::milliseconds(5);
+//packets are tiny, so this only bounds how long a write can stall if the device stops reading
+static const DWORD c_writeTimeoutMs = 50;
+static const DWORD c_transmitBufferSize = 512;
+
+SerialCommunicationManager::SerialCommunicationManager(const VRSerialConfiguration_t& configuration, std::unique_ptr<IEncodingManager> encodingManager, IoReactor* ioReactor)
+	: m_serialConfiguration(configuration),
+	m_encodingManager(std::move(encodingManager)),
+	m_isConnected(false),
+	m_hSerial(0),
+	m_errors(0),
+	m_ioEvent(CreateEvent(NULL, TRUE, FALSE, NULL)),
+	m_waiter(configuration.waitStrategy, m_threadActive),
+	m_ioReactor(ioReactor) {
+	if (m_ioReactor) m_reconnectTimer = std::make_unique<DriverTimer>(m_ioReactor->Context());
+}
+
+SerialCommunicationManager::~SerialCommunicationManager() {
+	StopListener();
+	if (m_ioEvent != NULL) CloseHandle(m_ioEvent);
+}
+
 void SerialCommunicationManager::Connect() {
 	//We're not yet connected
 	m_isConnected = false;
 
+	m_hSerial = OpenPort();
+	if (m_hSerial == INVALID_HANDLE_VALUE) {
+		m_hSerial = 0;
+		return;
+	}
+
+	//If everything went fine we're connected
+	m_isConnected = true;
+}
+
+HANDLE SerialCommunicationManager::OpenPort() {
 	//Try to connect to the given port throuh CreateFile
-	m_hSerial = CreateFile(m_serialConfiguration.port.c_str(),
-						   GENERIC_READ | GENERIC_WRITE,
-						   0,
-						   NULL,
-						   OPEN_EXISTING,
-						   FILE_ATTRIBUTE_NORMAL,
-						   NULL);
-
-	if (this->m_hSerial == INVALID_HANDLE_VALUE) {
+	HANDLE port = CreateFile(m_serialConfiguration.port.c_str(),
+							 GENERIC_READ | GENERIC_WRITE,
+							 0,
+							 NULL,
+							 OPEN_EXISTING,
+							 FILE_FLAG_OVERLAPPED, //the reactor needs overlapped io, the listener thread uses it so it can be woken to stop
+							 NULL);
+
+	if (port == INVALID_HANDLE_VALUE) {
 		if (GetLastError() == ERROR_FILE_NOT_FOUND) {
 
 			DebugDriverLog("Serial error: Handle was not attached. Reason: not available.");
@@ -24,115 +67,389 @@ void SerialCommunicationManager::Connect() {
 		else {
 			DebugDriverLog("Serial error:Received error connecting to port");
 		}
+		return INVALID_HANDLE_VALUE;
 	}
-	else {
-		//If connected we try to set the comm parameters
-		DCB dcbSerialParams = { 0 };
 
-		//Try to get the current
-		if (!GetCommState(m_hSerial, &dcbSerialParams)) {
-			//If impossible, show an error
-			DebugDriverLog("Serial error: failed to get current serial parameters!");
+	DWORD baudRate = (DWORD)m_serialConfiguration.baudRate;
+	if (m_serialConfiguration.baudRate <= 0) {
+		baudRate = DetectBaudRate(port);
+	}
+	else if (baudRate > c_maxBaudRate) {
+		DriverLog("Serial baud rate %lu is above the supported maximum, using %lu", baudRate, c_maxBaudRate);
+		baudRate = c_maxBaudRate;
+	}
+
+	if (baudRate == 0 || !ConfigurePort(port, baudRate)) {
+		CloseHandle(port);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	m_baudRate = baudRate;
+	//Flush any remaining characters in the buffers 
+	PurgeBuffer(port);
+	return port;
+}
+
+bool SerialCommunicationManager::ConfigurePort(HANDLE port, DWORD baudRate) {
+	DCB dcbSerialParams = { 0 };
+	dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+
+	//Try to get the current
+	if (!GetCommState(port, &dcbSerialParams)) {
+		//If impossible, show an error
+		DebugDriverLog("Serial error: failed to get current serial parameters!");
+		return false;
+	}
+
+	//Define serial connection parameters for the arduino board
+	dcbSerialParams.BaudRate = baudRate;
+	dcbSerialParams.ByteSize = 8;
+	dcbSerialParams.StopBits = ONESTOPBIT;
+	dcbSerialParams.Parity = NOPARITY;
+
+	//reset upon establishing a connection
+	dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
+
+	//set the parameters and check for their proper application
+	if (!SetCommState(port, &dcbSerialParams)) {
+		DebugDriverLog("ALERT: Could not set Serial Port parameters (baud rate %lu)", baudRate);
+		return false;
+	}
+
+	//a queue that holds a few hundred packets rides out a stalled reader without overrunning
+	if (!SetupComm(port, (DWORD)m_serialConfiguration.receiveBufferSize, c_transmitBufferSize)) {
+		DebugDriverLog("Serial warning: could not set queue sizes, keeping the driver defaults");
+	}
+
+	//reads only ever ask for what is already queued, so they return as soon as that has been copied.
+	//A 1ms interval timeout is what asio expects when the reactor owns the handle
+	COMMTIMEOUTS timeouts = { 0 };
+	timeouts.ReadIntervalTimeout = 1;
+	timeouts.ReadTotalTimeoutMultiplier = 0;
+	timeouts.ReadTotalTimeoutConstant = 0;
+	timeouts.WriteTotalTimeoutMultiplier = 0;
+	timeouts.WriteTotalTimeoutConstant = c_writeTimeoutMs;
+
+	if (!SetCommTimeouts(port, &timeouts)) {
+		DebugDriverLog("ALERT: Could not set Serial Port timeouts");
+		return false;
+	}
+
+	return true;
+}
+
+DWORD SerialCommunicationManager::DetectBaudRate(HANDLE port) {
+	//opening the port resets the board, it only starts streaming once it has booted
+	DriverClock().SleepFor(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
+
+	if (m_baudRate != 0 && ProbeBaudRate(port, m_baudRate)) return m_baudRate;
+
+	for (DWORD baudRate : c_autoBaudRates) {
+		if (baudRate == m_baudRate) continue;
+
+		if (ProbeBaudRate(port, baudRate)) {
+			DriverLog("Detected serial baud rate %lu on %s", baudRate, m_serialConfiguration.port.c_str());
+			return baudRate;
 		}
-		else {
-			//Define serial connection parameters for the arduino board
-			dcbSerialParams.BaudRate = CBR_115200;
-			dcbSerialParams.ByteSize = 8;
-			dcbSerialParams.StopBits = ONESTOPBIT;
-			dcbSerialParams.Parity = NOPARITY;
-
-			//reset upon establishing a connection
-			dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
-
-			//set the parameters and check for their proper application
-			if (!SetCommState(m_hSerial, &dcbSerialParams)) {
-				DebugDriverLog("ALERT: Could not set Serial Port parameters");
-			}
-			else {
-				//If everything went fine we're connected
-				m_isConnected = true;
-				//Flush any remaining characters in the buffers 
-				PurgeComm(m_hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
-			}
+	}
+
+	DriverLog("Serial error: no supported baud rate gave clean frames on %s", m_serialConfiguration.port.c_str());
+	return 0;
+}
+
+bool SerialCommunicationManager::ProbeBaudRate(HANDLE port, DWORD baudRate) {
+	if (!ConfigurePort(port, baudRate)) return false;
+	PurgeBuffer(port);
+
+	BaudProbe probe;
+
+	const DriverTimePoint deadline = DriverClock().Now() + c_baudProbeTime;
+	while (DriverClock().Now() < deadline) {
+		if (PollBytesAvailable(port) < 0) return false;
+		if (m_errors & (CE_FRAME | CE_RXPARITY | CE_BREAK)) probe.OnLineError();
+
+		if (m_status.cbInQue == 0) {
+			DriverClock().SleepFor(c_baudProbePollInterval);
+			continue;
 		}
+
+		DWORD dwRead = 0;
+		const DWORD bytesToRead = (std::min)(m_status.cbInQue, (DWORD)probe.WritableBytes());
+		if (!ReadQueued(port, probe.WritePtr(), bytesToRead, dwRead)) return false;
+		if (probe.Commit(dwRead)) return true;
 	}
+
+	return false;
 }
 
-void SerialCommunicationManager::BeginListener(const std::function<void(VRCommData_t)>& callback) {
+bool SerialCommunicationManager::ReadQueued(HANDLE port, char* buffer, DWORD bytes, DWORD& bytesRead) {
+	bytesRead = 0;
+
+	//the port is opened for overlapped io, which needs an OVERLAPPED even for a read that completes
+	//right away
+	OVERLAPPED overlapped = { 0 };
+	overlapped.hEvent = m_ioEvent;
+
+	bool ok = ReadFile(port, buffer, bytes, NULL, &overlapped) || GetLastError() == ERROR_IO_PENDING;
+	return ok && GetOverlappedResult(port, &overlapped, &bytesRead, TRUE);
+}
+
+void SerialCommunicationManager::BeginListener(const std::function<void(const PackedSample&)>& callback) {
 	//DebugDriverLog("Begun listener");
+	if (m_ioReactor) {
+		m_callback = callback;
+		m_ioReactor->RunSync([&]() { BeginAsyncListener(); });
+		return;
+	}
+
+	if (m_serialConfiguration.pipeline.enabled) {
+		m_pipeline = std::make_unique<FramePipeline>(m_serialConfiguration.pipeline.ringSize, m_serialConfiguration.pipeline.backpressure);
+	}
+
+	m_stopEvent.Reset();
 	m_threadActive = true;
 	m_serialThread = std::thread(&SerialCommunicationManager::ListenerThread, this, callback);
 }
 
-void SerialCommunicationManager::ListenerThread(const std::function<void(VRCommData_t)>& callback) {
+void SerialCommunicationManager::ListenerThread(const std::function<void(const PackedSample&)>& callback) {
 	//DebugDriverLog("In listener thread");
-	std::this_thread::sleep_for(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
-	PurgeBuffer();
+	m_stopEvent.SleepFor(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
+	PurgeBuffer(m_hSerial);
 
-	while (m_threadActive) {
-		std::string receivedString;
-		bool readSuccessful = ReceiveNextPacket(receivedString);
-		
-
-		if (readSuccessful) {
-			try {
-				VRCommData_t commData = m_encodingManager->Decode(receivedString);
-				callback(commData);
+	if (!SetCommMask(m_hSerial, EV_RXCHAR)) {
+		DebugDriverLog("Error setting comm mask");
+	}
+
+	if (m_pipeline) {
+		PipelinedListen(callback);
+	}
+	else {
+		std::string_view frame;
+		while (m_threadActive) {
+			if (ReceiveNextPacket(frame)) {
+				DecodeFrame(frame, callback);
 			}
-			catch (const std::invalid_argument& ia) {
-				DriverLog("Received error from encoding manager. Skipping...");
+			else {
+				if (m_threadActive) DebugDriverLog("Detected that arduino has disconnected! Stopping listener...");
+				//We should probably do more logic for trying to reconnect to the arduino
+				//For now, it should be obvious to people that the arduinos have disconnected
+				m_threadActive = false;
 			}
 		}
-		else {
-			DebugDriverLog("Detected that arduino has disconnected! Stopping listener...");
-			//We should probably do more logic for trying to reconnect to the arduino
-			//For now, it should be obvious to people that the arduinos have disconnected
+	}
+
+	const TransportWaitStats& waitStats = m_waiter.Stats();
+	DebugDriverLog("Serial listener stopped. Waits: %llu, spin hits: %llu, blocks: %llu, spin time: %.1fms",
+		waitStats.waits.load(), waitStats.spinHits.load(), waitStats.blocks.load(), waitStats.spinTimeNs.load() / 1e6);
+	DebugDriverLog("Serial framing: %llu oversized frames, %llu bytes dropped",
+		m_frameBuffer.OversizedFrames(), m_frameBuffer.DroppedBytes());
+	DebugDriverLog("Serial line at %lu baud: receive queue peaked at %lu bytes, %llu polls saw line errors",
+		m_baudRate, m_queueHighWater, m_lineErrors);
+}
+
+void SerialCommunicationManager::PipelinedListen(const std::function<void(const PackedSample&)>& callback) {
+	//decoding and the callback get their own thread, this one only moves bytes from the port into the ring
+	std::thread decodeThread([&]() {
+		std::string_view frame;
+		while (m_pipeline->NextFrame(frame)) {
+			DecodeFrame(frame, callback);
+			m_pipeline->Release();
+		}
+	});
+
+	while (m_threadActive) {
+		size_t room = 0;
+		char* writePtr = m_pipeline->PrepareWrite(room);
+		if (writePtr == nullptr) break;
+
+		DWORD dwRead = 0;
+		if (!ReadAvailable(writePtr, room, dwRead)) {
+			if (m_threadActive) DebugDriverLog("Detected that arduino has disconnected! Stopping listener...");
 			m_threadActive = false;
+			break;
 		}
 
+		m_pipeline->Commit(dwRead);
+		if (dwRead > 0) m_waiter.OnArrival();
+	}
+
+	m_pipeline->Stop();
+	decodeThread.join();
+
+	const FramePipelineStats& stats = m_pipeline->Stats();
+	DebugDriverLog("Serial pipeline: %llu frames, %llu dropped (%llu bytes), %llu reader stalls, ring peaked at %zu of %zu bytes",
+		stats.framesPublished.load(), stats.framesDropped.load(), stats.bytesDropped.load(), stats.readerStalls.load(),
+		stats.highWaterBytes.load(), m_pipeline->Capacity());
+}
+
+void SerialCommunicationManager::DecodeFrame(std::string_view frame, const std::function<void(const PackedSample&)>& callback) {
+	try {
+		VRCommData_t commData = m_encodingManager->Decode(frame);
+		callback(PackSample(commData, m_sequence++, DriverClock().Now().time_since_epoch().count()));
+	}
+	catch (const std::invalid_argument& ia) {
+		DriverLog("Received error from encoding manager. Skipping...");
 	}
 }
 
-bool SerialCommunicationManager::ReceiveNextPacket(std::string& buff) {
-	DWORD dwCommEvent;
-	DWORD dwRead = 0;
+bool SerialCommunicationManager::ReceiveNextPacket(std::string_view& frame) {
+	while (!m_frameBuffer.NextFrame(frame)) {
+		DWORD dwRead = 0;
+		if (!ReadAvailable(m_frameBuffer.WritePtr(), m_frameBuffer.WritableBytes(), dwRead)) return false;
 
-	if (!SetCommMask(m_hSerial, EV_RXCHAR)) {
-		DebugDriverLog("Error setting comm mask");
-		return false;
+		m_frameBuffer.Commit(dwRead);
+		//the arrival model is of reads, and a read can carry several frames
+		if (dwRead > 0) m_waiter.OnArrival();
 	}
 
-	char nextChar;
-	int bytesRead = 0;
-	if (WaitCommEvent(m_hSerial, &dwCommEvent, NULL)) {
-		do {
-			if (ReadFile(m_hSerial, &nextChar, 1, &dwRead, NULL)) {
-				buff += nextChar;
-				bytesRead++;
-			}
-			else {
-				DebugDriverLog("Read file error");
-				return false;
-			}
-		} while (nextChar != '\n');
+	return true;
+}
+
+bool SerialCommunicationManager::ReadAvailable(char* buffer, size_t room, DWORD& bytesRead) {
+	const bool dataReady = m_waiter.Wait(
+		[&]() { return PollBytesAvailable(m_hSerial); },
+		[&](DriverDuration timeout) { return WaitForBytes(timeout); });
+
+	if (!dataReady || PollBytesAvailable(m_hSerial) < 0) {
+		//a wait cut short by Disconnect() is not an error
+		if (m_threadActive) DebugDriverLog("Error in comm event");
+		return false;
 	}
-	else {
-		DebugDriverLog("Error in comm event");
+
+	//read everything the driver has queued in one call. Reads wait for their full count, so asking
+	//for more than is queued would block until the line goes idle
+	const DWORD bytesToRead = (std::max)((DWORD)1, (std::min)(m_status.cbInQue, (DWORD)room));
+
+	if (!ReadQueued(m_hSerial, buffer, bytesToRead, bytesRead)) {
+		DebugDriverLog("Read file error");
 		return false;
 	}
 
 	return true;
 }
-bool SerialCommunicationManager::PurgeBuffer() {
-	return PurgeComm(m_hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+int SerialCommunicationManager::PollBytesAvailable(HANDLE port) {
+	if (!ClearCommError(port, &m_errors, &m_status)) return -1;
+
+	m_queueHighWater = (std::max)(m_queueHighWater, m_status.cbInQue);
+	if (m_errors & (CE_FRAME | CE_OVERRUN | CE_RXOVER | CE_RXPARITY)) m_lineErrors++;
+
+	return m_status.cbInQue > 0 ? 1 : 0;
+}
+
+bool SerialCommunicationManager::WaitForBytes(DriverDuration timeout) {
+	OVERLAPPED overlapped = { 0 };
+	overlapped.hEvent = m_ioEvent;
+	ResetEvent(m_ioEvent);
+
+	DWORD dwCommEvent = 0;
+	if (WaitCommEvent(m_hSerial, &dwCommEvent, &overlapped)) return true;
+	if (GetLastError() != ERROR_IO_PENDING) return false;
+
+	const HANDLE handles[] = { m_ioEvent, m_stopEvent.Handle() };
+	const DWORD waitResult = StopEvent::WaitOnClock(timeout, WAIT_TIMEOUT, [&](DWORD milliseconds) {
+		return WaitForMultipleObjects(2, handles, FALSE, milliseconds);
+	});
+
+	//stopped or timed out, the pending wait has to be finished before overlapped goes out of scope
+	if (waitResult != WAIT_OBJECT_0) CancelIoEx(m_hSerial, &overlapped);
+
+	DWORD transferred = 0;
+	const bool completed = GetOverlappedResult(m_hSerial, &overlapped, &transferred, TRUE);
+	if (waitResult == WAIT_OBJECT_0 + 1 || waitResult == WAIT_FAILED) return false;
+
+	//a timeout is fine, the waiter polls again afterwards
+	return completed || GetLastError() == ERROR_OPERATION_ABORTED;
+}
+bool SerialCommunicationManager::PurgeBuffer(HANDLE port) {
+	return PurgeComm(port, PURGE_RXCLEAR | PURGE_TXCLEAR);
+}
+
+void SerialCommunicationManager::BeginAsyncListener() {
+	m_asyncStopped = false;
+
+	asio::error_code ec;
+	m_serialPort = std::make_unique<asio::serial_port>(m_ioReactor->Context());
+	m_serialPort->assign(m_hSerial, ec);
+	if (ec) {
+		m_serialPort.reset();
+		OnAsyncError(ec);
+		return;
+	}
+
+	m_asyncReader = std::make_shared<AsyncFrameReader<asio::serial_port>>(
+		*m_serialPort, m_frameBuffer, c_watchdogTimeout,
+		[&](std::string_view frame) { OnAsyncFrame(frame); },
+		[&](const asio::error_code& ec) { OnAsyncError(ec); });
+	m_asyncReader->Start(std::chrono::milliseconds(ARDUINO_WAIT_TIME));
+}
+
+void SerialCommunicationManager::OnAsyncFrame(std::string_view frame) {
+	DecodeFrame(frame, m_callback);
+}
+
+void SerialCommunicationManager::OnAsyncError(const asio::error_code& ec) {
+	DriverLog("Serial connection lost (%s). Reconnecting...", ec.message().c_str());
+	CloseAsync();
+
+	//a cancelled sleep ends the coroutine with operation_aborted, nothing to report
+	asio::co_spawn(m_ioReactor->Context(), ReconnectAsync(), [](std::exception_ptr) {});
+}
+
+asio::awaitable<void> SerialCommunicationManager::ReconnectAsync() {
+	//the port is opened into a handle of its own on the pool, m_hSerial and m_isConnected only
+	//change on this thread, where Disconnect() closes them
+	HANDLE port = INVALID_HANDLE_VALUE;
+	do {
+		co_await AsyncSleep(*m_reconnectTimer, m_reconnectBackoff.Next());
+		if (m_asyncStopped) co_return;
+		//opening and configuring the port can stall on a misbehaving usb device
+		port = co_await RunBlocking(m_ioReactor->BlockingPool(), [&]() { return OpenPort(); });
+	} while (port == INVALID_HANDLE_VALUE);
+
+	//disconnected while the last attempt was in flight
+	if (m_asyncStopped) {
+		CloseHandle(port);
+		co_return;
+	}
+
+	m_hSerial = port;
+	m_isConnected = true;
+	m_reconnectBackoff.Reset();
+	BeginAsyncListener();
+}
+
+void SerialCommunicationManager::CloseAsync() {
+	if (m_asyncReader) {
+		m_asyncReader->Stop();
+		m_asyncReader.reset();
+	}
+
+	//the port owns the handle once it has been assigned
+	asio::error_code ec;
+	if (m_serialPort) {
+		m_serialPort->close(ec);
+		m_serialPort.reset();
+	}
+	else if (m_hSerial != INVALID_HANDLE_VALUE && m_hSerial != 0) {
+		CloseHandle(m_hSerial);
+	}
+	m_hSerial = 0;
+	m_isConnected = false;
 }
 
 void SerialCommunicationManager::Disconnect() {
+	if (m_ioReactor) {
+		m_ioReactor->RunSync([&]() {
+			m_asyncStopped = true;
+			m_reconnectTimer->cancel();
+			CloseAsync();
+		});
+		return;
+	}
+
 	if (m_isConnected) {
-		if (m_threadActive) {
-			m_threadActive = false;
-			m_serialThread.join();
-		}
+		StopListener();
 		m_isConnected = false;
 		CloseHandle(m_hSerial);
 
@@ -140,6 +457,17 @@ void SerialCommunicationManager::Disconnect() {
 		//Disconnect
 	}
 }
+
+void SerialCommunicationManager::StopListener() {
+	//the listener may already have stopped itself after losing the device, it still has to be joined
+	m_threadActive = false;
+	m_stopEvent.Set();
+	//the reader can also be parked waiting for ring space, the decoder for frames
+	if (m_pipeline) m_pipeline->Stop();
+
+	if (m_serialThread.joinable()) m_serialThread.join();
+}
+
 //May want to get a heartbeat here instead?
 bool SerialCommunicationManager::IsConnected() {
 	return m_isConnected;
@@ -0,0 +1,32 @@
+#include "Communication/TransportWaiter.h"
+
+#include <cstdlib>
+
+// Spin at least this long around the expected arrival, and never longer than the maximum
+static const DriverDuration c_minSpinWindow = std::chrono::microseconds(50);
+static const DriverDuration c_maxSpinWindow = std::chrono::milliseconds(2);
+// Gaps longer than this are a stall or reconnect, not the packet rate
+static const DriverDuration c_maxInterval = std::chrono::milliseconds(100);
+
+void TransportWaiter::OnArrival() {
+  const DriverTimePoint now = DriverClock().Now();
+  const int64_t interval = (now - m_lastArrival).count();
+  m_lastArrival = now;
+
+  if (interval <= 0 || interval > c_maxInterval.count()) return;
+
+  if (m_intervalNs == 0) {
+    m_intervalNs = interval;
+    return;
+  }
+
+  // exponential moving averages with a weight of 1/8
+  const int64_t error = interval - m_intervalNs;
+  m_intervalNs += error / 8;
+  m_deviationNs += (std::llabs(error) - m_deviationNs) / 8;
+}
+
+DriverDuration TransportWaiter::SpinWindow() const {
+  return std::clamp(DriverDuration(2 * m_deviationNs) + c_minSpinWindow, c_minSpinWindow,
+                    c_maxSpinWindow);
+}
@@ -0,0 +1,13 @@
+#include "ConcurrencyChecks.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "DriverLog.h"
+
+void ConcurrencyCheckFailed(const char* message, const char* file, int line) {
+  // stderr as well, the driver log is not set up outside of SteamVR
+  std::fprintf(stderr, "%s:%d: concurrency check failed: %s\n", file, line, message);
+  DriverLog("%s:%d: concurrency check failed: %s", file, line, message);
+  std::abort();
+}
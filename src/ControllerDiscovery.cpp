@@ -2,6 +2,7 @@
 
 #include <chrono>
 
+#include "Clock.h"
 #include "DriverLog.h"
 
 std::string GetLastErrorAsString() {
@@ -35,6 +36,7 @@ ControllerDiscoveryPipe::ControllerDiscoveryPipe()
 
 bool ControllerDiscoveryPipe::Start(const std::function<void(ControllerPipeData)> &callback,
                                     vr::ETrackedControllerRole role) {
+  m_stopEvent.Reset();
   m_listenerActive = true;
   m_pipeThread = std::thread(&ControllerDiscoveryPipe::PipeListenerThread, this, callback, role);
 
@@ -128,12 +130,22 @@ void ControllerDiscoveryPipe::PipeListenerThread(
 
   fPendingIO = CreateAndConnectInstance(&oConnect, pipeName);
 
+  // stop goes first, a wait on several signalled objects reports the lowest index
+  const HANDLE waitHandles[] = {m_stopEvent.Handle(), hConnectEvent};
+
   while (m_listenerActive) {
-    dwWait = WaitForSingleObjectEx(hConnectEvent,  // event object to wait for
-                                   INFINITE,       // waits indefinitely
-                                   TRUE);          // alertable wait enabled
+    dwWait = WaitForMultipleObjectsEx(2,            // stop and connect events
+                                      waitHandles,  // event objects to wait for
+                                      FALSE,        // either one wakes the thread
+                                      INFINITE,     // waits until one of them is set
+                                      TRUE);        // alertable wait enabled
     switch (dwWait) {
-      case 0: {
+      case WAIT_OBJECT_0: {
+        // Stop() was called, it closes the pipe once this thread has been joined
+        m_listenerActive = false;
+        break;
+      }
+      case WAIT_OBJECT_0 + 1: {
         if (fPendingIO) {
           fSuccess = GetOverlappedResult(m_hPipe,    // pipe handle
                                          &oConnect,  // OVERLAPPED structure
@@ -141,6 +153,7 @@ void ControllerDiscoveryPipe::PipeListenerThread(
                                          FALSE);     // does not wait
           if (!fSuccess) {
             DriverLog("ConnectNamedPipe with error: %s.\n", GetLastErrorAsString().c_str());
+            CloseHandle(hConnectEvent);
             return;
           }
         }
@@ -148,6 +161,7 @@ void ControllerDiscoveryPipe::PipeListenerThread(
 
         if (m_lpPipeInst == NULL) {
           DriverLog("GlobalAlloc failed with error: %s.\n", GetLastErrorAsString().c_str());
+          CloseHandle(hConnectEvent);
           return;
         }
 
@@ -172,31 +186,45 @@ void ControllerDiscoveryPipe::PipeListenerThread(
       }
 
       default: {
-        DriverLog("WaitForSingleObjectEx with error: %s.\n", GetLastErrorAsString().c_str());
+        DriverLog("WaitForMultipleObjectsEx with error: %s.\n", GetLastErrorAsString().c_str());
+        CloseHandle(hConnectEvent);
         return;
       }
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    m_stopEvent.SleepFor(std::chrono::milliseconds(500));
   }
+
+  CloseHandle(hConnectEvent);
 }
 
 void ControllerDiscoveryPipe::DisconnectAndClose() {
   DebugDriverLog("Closing pipe...");
   if (m_listenerActive) m_listenerActive = false;
 
-  if (!DisconnectNamedPipe(m_lpPipeInst->hPipeInst)) {
-    DebugDriverLog("DisconnectNamedPipe failed with error: %s.\n", GetLastErrorAsString().c_str());
-  }
+  // the pipe is created before any client connects, the instance only once one has
+  if (m_hPipe != 0 && m_hPipe != INVALID_HANDLE_VALUE) {
+    // a read can still be pending on the instance that is freed below
+    CancelIoEx(m_hPipe, NULL);
 
-  CloseHandle(m_lpPipeInst->hPipeInst);
+    if (!DisconnectNamedPipe(m_hPipe)) {
+      DebugDriverLog("DisconnectNamedPipe failed with error: %s.\n", GetLastErrorAsString().c_str());
+    }
+
+    CloseHandle(m_hPipe);
+  }
+  m_hPipe = 0;
 
   // Release the storage for the pipe instance.
   if (m_lpPipeInst != NULL) GlobalFree(m_lpPipeInst);
+  m_lpPipeInst = NULL;
 }
 
 void ControllerDiscoveryPipe::Stop() {
+  if (!m_pipeThread.joinable()) return;
+
   DriverLog("Disconnecting controller pipe...");
   m_listenerActive = false;
+  m_stopEvent.Set();
   m_pipeThread.join();
   DisconnectAndClose();
 }
@@ -11,7 +11,9 @@ ControllerPose::ControllerPose(vr::ETrackedControllerRole shadowDeviceOfRole,
                                VRPoseConfiguration_t poseConfiguration)
     : m_shadowDeviceOfRole(shadowDeviceOfRole),
       m_thisDeviceManufacturer(std::move(thisDeviceManufacturer)),
-      m_poseConfiguration(poseConfiguration) {
+      m_poseConfiguration(poseConfiguration),
+      m_poseBridge(FromMilliseconds(poseConfiguration.trackingLossBridgeMs),
+                   FromMilliseconds(poseConfiguration.trackingLossBlendMs)) {
 
   if (m_poseConfiguration.controllerOverrideEnabled) {
     m_shadowControllerId = m_poseConfiguration.controllerIdOverride;
@@ -45,6 +47,7 @@ vr::DriverPose_t ControllerPose::UpdatePose() {
 
   if (m_shadowControllerId != vr::k_unTrackedDeviceIndexInvalid) {
       vr::TrackedDevicePose_t controllerPose = GetControllerPose();
+      const DriverTimePoint sampledAt = DriverClock().Now();
 
     if (controllerPose.bPoseIsValid) {
       // get the matrix that represents the position of the controller that we are shadowing
@@ -84,11 +87,18 @@ vr::DriverPose_t ControllerPose::UpdatePose() {
 
       newPose.result = vr::TrackingResult_Running_OK;
 
-      newPose.poseTimeOffset = m_poseConfiguration.poseOffset;
+      // the offset is relative to when SteamVR gets the pose, which is a little after the controller
+      // pose was read
+      const DriverTimePoint now = DriverClock().Now();
+      newPose.poseTimeOffset = m_poseConfiguration.poseOffset - ToSeconds(now - sampledAt);
+
+      newPose = m_poseBridge.OnTracked(newPose, now);
     } else {
       newPose.poseIsValid = false;
       newPose.deviceIsConnected = true;
       newPose.result = vr::TrackingResult_Uninitialized;
+
+      newPose = m_poseBridge.OnLost(newPose, DriverClock().Now());
     }
 
   } else {
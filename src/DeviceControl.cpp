@@ -0,0 +1,262 @@
+#include "DeviceControl.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "BudgetGovernor.h"
+
+namespace {
+// a few seconds of packets at the rates gloves send at
+constexpr size_t c_historyCapacity = 512;
+
+struct TuningParameter {
+  const char* name;
+  float VRInputTuning_t::*member;
+  float min;
+  float max;
+};
+
+// the deadzones stop short of 1 so the rescale never divides by zero
+const TuningParameter c_tuningParameters[] = {
+    {"smoothing", &VRInputTuning_t::smoothing, 0.f, 0.99f},
+    {"flexion_curve", &VRInputTuning_t::flexionCurve, 0.1f, 10.f},
+    {"flexion_deadzone", &VRInputTuning_t::flexionDeadzone, 0.f, 0.95f},
+    {"joystick_deadzone", &VRInputTuning_t::joystickDeadzone, 0.f, 0.95f},
+    {"flexion_min", &VRInputTuning_t::flexionMin, 0.f, 0.9f},
+    {"flexion_max", &VRInputTuning_t::flexionMax, 0.1f, 1.f},
+    {"grab_threshold", &VRInputTuning_t::grabThreshold, 0.f, 1.f},
+    {"pinch_threshold", &VRInputTuning_t::pinchThreshold, 0.f, 1.f},
+};
+
+const TuningParameter* FindParameter(std::string_view name) {
+  for (const TuningParameter& parameter : c_tuningParameters)
+    if (name == parameter.name) return &parameter;
+
+  return nullptr;
+}
+
+std::string_view TrimLeft(std::string_view text) {
+  const size_t start = text.find_first_not_of(" \t\r\n");
+  return start == std::string_view::npos ? std::string_view() : text.substr(start);
+}
+
+std::string_view TrimRight(std::string_view text) {
+  const size_t end = text.find_last_not_of(" \t\r\n");
+  return end == std::string_view::npos ? std::string_view() : text.substr(0, end + 1);
+}
+
+// Splits off the first word; text is left holding the rest.
+std::string_view NextToken(std::string_view& text) {
+  text = TrimLeft(text);
+
+  const size_t end = std::min(text.find_first_of(" \t\r\n"), text.size());
+  const std::string_view token = text.substr(0, end);
+  text = TrimLeft(text.substr(end));
+
+  return token;
+}
+
+// "recording,smoothing", or "none"
+void FormatStages(uint32_t stages, char* out, size_t size) {
+  size_t written = 0;
+  out[0] = '\0';
+  for (uint32_t i = 0; i < c_budgetStageCount; i++) {
+    if ((stages & (1u << i)) == 0 || written >= size) continue;
+
+    const int length = std::snprintf(out + written, size - written, "%s%s", written == 0 ? "" : ",",
+                                     BudgetStageName(static_cast<BudgetStage>(1u << i)));
+    if (length > 0) written += static_cast<size_t>(length);
+  }
+  if (written == 0) std::snprintf(out, size, "none");
+}
+
+void Reply(char* response, uint32_t responseSize, const char* format, ...) {
+  if (responseSize == 0) return;
+
+  va_list args;
+  va_start(args, format);
+  std::vsnprintf(response, responseSize, format, args);
+  va_end(args);
+}
+}  // namespace
+
+DeviceControl::DeviceControl(const VRInputTuning_t& tuning, const std::string& recordingDirectory)
+    : m_capture(recordingDirectory, RecorderContent_Frames),
+      m_recording(recordingDirectory, RecorderContent_Samples),
+      m_history(c_historyCapacity) {
+  VRInputTuning_t clamped = tuning;
+  for (const TuningParameter& parameter : c_tuningParameters)
+    clamped.*parameter.member =
+        std::clamp(clamped.*parameter.member, parameter.min, parameter.max);
+
+  m_tuning.Store(clamped);
+}
+
+void DeviceControl::SetReconnectHandler(std::function<void()> reconnect) {
+  std::lock_guard<std::mutex> lock(m_commandMutex);
+  m_reconnect = std::move(reconnect);
+}
+
+void DeviceControl::HandleRequest(std::string_view request, char* response,
+                                  uint32_t responseSize) {
+  std::lock_guard<std::mutex> lock(m_commandMutex);
+  if (responseSize > 0) response[0] = 0;
+
+  std::string_view arguments = request;
+  const std::string_view command = NextToken(arguments);
+
+  if (command == "stats") return HandleStats(response, responseSize);
+  if (command == "get") return HandleGet(arguments, response, responseSize);
+  if (command == "set") return HandleSet(arguments, response, responseSize);
+  if (command == "capture") return HandleRecorder(m_capture, arguments, response, responseSize);
+  if (command == "record") return HandleRecorder(m_recording, arguments, response, responseSize);
+  if (command == "history") return HandleHistory(arguments, response, responseSize);
+
+  if (command == "reconnect") {
+    if (!m_reconnect) return Reply(response, responseSize, "error: device can't reconnect");
+
+    m_counters.reconnects.fetch_add(1, std::memory_order_relaxed);
+    m_reconnect();
+    return Reply(response, responseSize, "ok");
+  }
+
+  Reply(response, responseSize,
+        "error: unknown command '%.*s'. commands: stats, get, set, capture, record, reconnect, "
+        "history",
+        static_cast<int>(command.size()), command.data());
+}
+
+void DeviceControl::HandleStats(char* response, uint32_t responseSize) {
+  char degraded[96];
+  FormatStages(m_counters.degradedStages.load(), degraded, sizeof(degraded));
+
+  Reply(response, responseSize,
+        "packets=%llu decode_errors=%llu submitted=%llu reconnects=%llu latency_mean_ms=%.2f "
+        "latency_jitter_ms=%.2f capture=%s capture_dropped=%llu record=%s record_dropped=%llu "
+        "frame_cost_us=%.0f degraded=%s budget_events=%llu",
+        static_cast<unsigned long long>(m_counters.packets.load()),
+        static_cast<unsigned long long>(m_counters.decodeErrors.load()),
+        static_cast<unsigned long long>(m_counters.submitted.load()),
+        static_cast<unsigned long long>(m_counters.reconnects.load()),
+        m_counters.latencyMeanMs.load(), m_counters.latencyJitterMs.load(),
+        m_capture.IsRecording() ? "on" : "off",
+        static_cast<unsigned long long>(m_capture.Dropped()),
+        m_recording.IsRecording() ? "on" : "off",
+        static_cast<unsigned long long>(m_recording.Dropped()), m_counters.frameCostUs.load(),
+        degraded, static_cast<unsigned long long>(m_counters.budgetEvents.load()));
+}
+
+void DeviceControl::HandleGet(std::string_view arguments, char* response, uint32_t responseSize) {
+  const VRInputTuning_t tuning = m_tuning.Load();
+  const std::string_view name = NextToken(arguments);
+
+  if (!name.empty()) {
+    const TuningParameter* parameter = FindParameter(name);
+    if (!parameter)
+      return Reply(response, responseSize, "error: unknown parameter '%.*s'",
+                   static_cast<int>(name.size()), name.data());
+
+    return Reply(response, responseSize, "%s=%g", parameter->name, tuning.*parameter->member);
+  }
+
+  // all of them, as far as they fit
+  uint32_t written = 0;
+  for (const TuningParameter& parameter : c_tuningParameters) {
+    if (written >= responseSize) break;
+
+    const int length = std::snprintf(response + written, responseSize - written, "%s%s=%g",
+                                     written == 0 ? "" : " ", parameter.name,
+                                     tuning.*parameter.member);
+    if (length < 0) break;
+    written += static_cast<uint32_t>(length);
+  }
+}
+
+void DeviceControl::HandleSet(std::string_view arguments, char* response, uint32_t responseSize) {
+  const std::string_view name = NextToken(arguments);
+  const std::string_view valueText = NextToken(arguments);
+
+  const TuningParameter* parameter = FindParameter(name);
+  if (!parameter)
+    return Reply(response, responseSize, "error: unknown parameter '%.*s'",
+                 static_cast<int>(name.size()), name.data());
+
+  float value;
+  const auto result = std::from_chars(valueText.data(), valueText.data() + valueText.size(), value);
+  if (result.ec != std::errc() || result.ptr != valueText.data() + valueText.size())
+    return Reply(response, responseSize, "error: '%.*s' is not a number",
+                 static_cast<int>(valueText.size()), valueText.data());
+
+  if (value < parameter->min || value > parameter->max)
+    return Reply(response, responseSize, "error: %s must be between %g and %g", parameter->name,
+                 parameter->min, parameter->max);
+
+  // the command mutex makes this the only writer
+  VRInputTuning_t tuning = m_tuning.Load();
+  tuning.*parameter->member = value;
+  m_tuning.Store(tuning);
+
+  Reply(response, responseSize, "ok %s=%g", parameter->name, value);
+}
+
+void DeviceControl::HandleHistory(std::string_view arguments, char* response,
+                                  uint32_t responseSize) {
+  const std::string_view agoText = NextToken(arguments);
+
+  float agoMs = 0.f;
+  if (!agoText.empty()) {
+    const auto result = std::from_chars(agoText.data(), agoText.data() + agoText.size(), agoMs);
+    if (result.ec != std::errc() || result.ptr != agoText.data() + agoText.size() || agoMs < 0.f)
+      return Reply(response, responseSize, "error: '%.*s' is not a number of milliseconds",
+                   static_cast<int>(agoText.size()), agoText.data());
+  }
+
+  const int64_t timeNs = DriverClock().Now().time_since_epoch().count() -
+                         static_cast<int64_t>(agoMs * 1e6f);
+  VRCommData_t value = UnpackSample(PackedSample{});
+  if (!m_history.ValueAt(timeNs, value))
+    return Reply(response, responseSize, "error: nothing received %gms ago (%llu samples held)",
+                 agoMs,
+                 static_cast<unsigned long long>(
+                     std::min<uint64_t>(m_history.Appended(), m_history.Capacity() - 1)));
+
+  Reply(response, responseSize,
+        "flexion=%.3f,%.3f,%.3f,%.3f,%.3f splay=%.3f,%.3f,%.3f,%.3f,%.3f joystick=%.3f,%.3f",
+        value.flexion[0], value.flexion[1], value.flexion[2], value.flexion[3], value.flexion[4],
+        value.splay[0], value.splay[1], value.splay[2], value.splay[3], value.splay[4], value.joyX,
+        value.joyY);
+}
+
+void DeviceControl::HandleRecorder(Recorder& recorder, std::string_view arguments,
+                                   char* response, uint32_t responseSize) {
+  const std::string_view action = NextToken(arguments);
+
+  if (action == "stop") {
+    if (!recorder.IsRecording()) return Reply(response, responseSize, "error: not running");
+
+    recorder.Stop();
+    return Reply(response, responseSize, "ok written=%llu dropped=%llu",
+                 static_cast<unsigned long long>(recorder.Written()),
+                 static_cast<unsigned long long>(recorder.Dropped()));
+  }
+
+  if (action == "start") {
+    // a name only, the recorder decides where it goes
+    const std::string_view fileName = TrimRight(arguments);
+    if (!IsPlainFileName(fileName))
+      return Reply(response, responseSize,
+                   "error: expected a file name of letters, digits, '.', '-' and '_'");
+    if (recorder.IsRecording()) return Reply(response, responseSize, "error: already running");
+
+    if (!recorder.Start(fileName))
+      return Reply(response, responseSize, "error: could not open %.*s",
+                   static_cast<int>(fileName.size()), fileName.data());
+
+    return Reply(response, responseSize, "ok");
+  }
+
+  Reply(response, responseSize, "error: expected start <file name> or stop");
+}
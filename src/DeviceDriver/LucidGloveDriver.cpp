@@ -29,12 +29,20 @@ enum ComponentIndex : int {
 	COMP_TRG_PINKY = 13
 };
 
-LucidGloveDeviceDriver::LucidGloveDeviceDriver(VRDeviceConfiguration_t configuration, std::unique_ptr<ICommunicationManager> communicationManager, std::string serialNumber)
+//room for a few frames of button changes from even the fastest glove
+static const size_t c_buttonEventCapacity = 256;
+//frames between diagnostics snapshots while that stage is degraded
+static const int c_degradedPublishFrames = 4;
+
+LucidGloveDeviceDriver::LucidGloveDeviceDriver(VRDeviceConfiguration_t configuration, std::unique_ptr<ICommunicationManager> communicationManager, std::shared_ptr<DeviceControl> control, std::string serialNumber)
 	: m_configuration(configuration),
 	m_communicationManager(std::move(communicationManager)),
+	m_control(std::move(control)),
 	m_serialNumber(serialNumber),
 	m_driverId(-1),
-	m_hasActivated(false) {
+	m_hasActivated(false),
+	m_buttonEvents(c_buttonEventCapacity),
+	m_budget(m_configuration.budgetConfiguration, m_serialNumber, m_control->Counters()) {
 
 	//copy a default bone transform to our hand transform for use in finger positioning later
 	std::copy(
@@ -42,6 +50,8 @@ LucidGloveDeviceDriver::LucidGloveDeviceDriver(VRDeviceConfiguration_t configura
 		std::end(m_configuration.role == vr::TrackedControllerRole_RightHand ? rightOpenPose : leftOpenPose),
 		std::begin(m_handTransforms)
 	);
+
+	m_control->SetReconnectHandler([&]() { Reconnect(); });
 }
 
 bool LucidGloveDeviceDriver::IsRightHand() const {
@@ -108,6 +118,9 @@ vr::EVRInitError LucidGloveDeviceDriver::Activate(uint32_t unObjectId) {
 		DebugDriverLog("CreateSkeletonComponent failed.  Error: %s\n", error);
 	}
 
+	//created whether or not the device is connected yet, so a later reconnect still submits on the
+	//late latch. The transport thread reads the pointer without a lock, it must not change after this
+	if (m_configuration.lateLatchConfiguration.enabled) StartLateLatch();
 	StartDevice();
 
 	m_hasActivated = true;
@@ -115,45 +128,26 @@ vr::EVRInitError LucidGloveDeviceDriver::Activate(uint32_t unObjectId) {
 	return vr::VRInitError_None;
 }
 
+void LucidGloveDeviceDriver::StartLateLatch() {
+	const float displayFrequency = vr::VRProperties()->GetFloatProperty(
+		vr::VRProperties()->TrackedDeviceToPropertyContainer(vr::k_unTrackedDeviceIndex_Hmd), vr::Prop_DisplayFrequency_Float);
+	const DriverDuration framePeriod = std::chrono::duration_cast<DriverDuration>(
+		std::chrono::duration<float>(1.f / (displayFrequency > 0 ? displayFrequency : 90.f)));
+	const DriverDuration margin = std::chrono::duration_cast<DriverDuration>(
+		std::chrono::duration<float, std::milli>(m_configuration.lateLatchConfiguration.marginMs));
+
+	m_lateLatchScheduler = std::make_unique<LateLatchScheduler>(framePeriod, margin);
+	m_lateLatchScheduler->Start([&]() { SubmitLatestInput(); });
+}
+
 //This could do with a rename, its a bit vague as to what it does
 void LucidGloveDeviceDriver::StartDevice() {
 	m_communicationManager->Connect();
 	//DebugDriverLog("Getting ready to connect:");
+	m_control->Counters().connected = m_communicationManager->IsConnected();
 	if (m_communicationManager->IsConnected()) {
 		//DebugDriverLog("Connected successfully");
-		m_communicationManager->BeginListener([&](VRCommData_t datas) {
-			try {
-				//Compute each finger transform
-				for (int i = 0; i < NUM_BONES; i++) {
-					int fingerNum = FingerFromBone(i);
-					if (fingerNum != -1) {
-						ComputeBoneFlexion(&m_handTransforms[i], datas.flexion[fingerNum], i, IsRightHand());
-					}
-				}
-				vr::VRDriverInput()->UpdateSkeletonComponent(m_skeletalComponentHandle, vr::VRSkeletalMotionRange_WithoutController, m_handTransforms, NUM_BONES);
-				vr::VRDriverInput()->UpdateSkeletonComponent(m_skeletalComponentHandle, vr::VRSkeletalMotionRange_WithController, m_handTransforms, NUM_BONES);
-
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_X], datas.joyX, 0);
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_Y], datas.joyY, 0);
-
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_BTN], datas.joyButton, 0);
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_TRG], datas.trgButton, 0);
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_A], datas.aButton, 0);
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_B], datas.bButton, 0);
-
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_GES_GRAB], datas.grab, 0);
-				vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_GES_PINCH], datas.pinch, 0);
-
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_THUMB], datas.flexion[0], 0);
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_INDEX], datas.flexion[1], 0);
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_MIDDLE], datas.flexion[2], 0);
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_RING], datas.flexion[3], 0);
-				vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_PINKY], datas.flexion[4], 0);
-			}
-			catch (const std::exception& e) {
-				DebugDriverLog("Exception caught while parsing comm data");
-			}
-		});
+		m_communicationManager->BeginListener([&](const PackedSample& sample) { OnPacket(sample); });
 
 	}
 	else {
@@ -162,6 +156,124 @@ void LucidGloveDeviceDriver::StartDevice() {
 	}
 }
 
+void LucidGloveDeviceDriver::OnPacket(const PackedSample& sample) {
+	m_control->History().Append(sample);
+
+	if (m_lateLatchScheduler) {
+		m_buttonEvents.OnSample(sample);
+
+		//only keep the freshest data, it gets submitted right before the next frame
+		std::lock_guard<std::mutex> lock(m_latestInputMutex);
+		m_latestInput = sample;
+		return;
+	}
+
+	HandleInput(sample);
+}
+
+void LucidGloveDeviceDriver::Reconnect() {
+	DriverLog("Reconnecting %s", m_serialNumber.c_str());
+	m_communicationManager->Disconnect();
+	m_communicationManager->Connect();
+
+	m_control->Counters().connected = m_communicationManager->IsConnected();
+	if (m_communicationManager->IsConnected())
+		m_communicationManager->BeginListener([&](const PackedSample& sample) { OnPacket(sample); });
+}
+
+void LucidGloveDeviceDriver::HandleInput(const PackedSample& sample) {
+	const DriverTimePoint start = DriverClock().Now();
+	BudgetTimer budget(m_budget, start);
+	VRCommData_t datas = UnpackSample(sample);
+
+	//pick up parameters changed through the control plane, and stages the budget governor shed or gave back
+	const SeqLock<VRInputTuning_t>& tuning = m_control->Tuning();
+	if (tuning.Version() != m_tuningVersion) m_signalGraph.Compile(tuning.Load(&m_tuningVersion));
+
+	const uint32_t degraded = m_budget.Degraded();
+	if (degraded != m_appliedDegradation) {
+		m_signalGraph.SetBypass(BypassedSignalStages(degraded));
+		m_appliedDegradation = degraded;
+	}
+
+	m_signalGraph.Process(datas);
+	budget.Charge(BudgetCost_Signal);
+
+	try {
+		//over budget, packets arriving faster than frames only update the controls in between. A little under a frame apart,
+		//so jitter never leaves a frame without a new skeleton
+		if (!(degraded & BudgetStage_SkeletonRate) || start - m_lastSkeletonSubmit >= m_budget.FramePeriod() * 3 / 4) {
+			m_lastSkeletonSubmit = start;
+
+			ComputeFingerFlexion(m_handTransforms, datas.flexion.data(), IsRightHand());
+			//the thumb also swings across the palm, driven by its splay
+			ComputeThumbPose(m_handTransforms, datas.flexion[0], datas.splay[0], IsRightHand());
+			vr::VRDriverInput()->UpdateSkeletonComponent(m_skeletalComponentHandle, vr::VRSkeletalMotionRange_WithoutController, m_handTransforms, NUM_BONES);
+			vr::VRDriverInput()->UpdateSkeletonComponent(m_skeletalComponentHandle, vr::VRSkeletalMotionRange_WithController, m_handTransforms, NUM_BONES);
+		}
+		budget.Charge(BudgetCost_Skeleton);
+
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_X], datas.joyX, 0);
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_Y], datas.joyY, 0);
+
+		//with the late latch only the latest analog state is applied, RunFrame replays every button change instead
+		if (!m_lateLatchScheduler) SubmitButtons(sample.buttons, c_eventButtons, 0.f);
+
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_GES_GRAB], datas.grab, 0);
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_GES_PINCH], datas.pinch, 0);
+
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_THUMB], datas.flexion[0], 0);
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_INDEX], datas.flexion[1], 0);
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_MIDDLE], datas.flexion[2], 0);
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_RING], datas.flexion[3], 0);
+		vr::VRDriverInput()->UpdateScalarComponent(m_inputComponentHandles[ComponentIndex::COMP_TRG_PINKY], datas.flexion[4], 0);
+
+		budget.Charge(BudgetCost_Controls);
+		const DriverTimePoint submitted = budget.Mark();
+		m_latencyStats.OnSubmit(submitted);
+
+		DeviceCounters& counters = m_control->Counters();
+		counters.submitted.fetch_add(1, std::memory_order_relaxed);
+		counters.submitLatency.Observe(submitted - start);
+		const PackedSample submittedSample = PackSample(datas, sample.sequence, sample.timeNs);
+		//over budget, diagnostics and OSC get a fresh snapshot every few frames
+		if (!(degraded & BudgetStage_Diagnostics) || submitted - m_lastPublish >= c_degradedPublishFrames * m_budget.FramePeriod()) {
+			m_lastPublish = submitted;
+			m_control->PublishSkeleton(m_handTransforms);
+			m_control->PublishSample(submittedSample);
+		}
+		budget.Charge(BudgetCost_Diagnostics);
+
+		if (!(degraded & BudgetStage_Recording)) m_control->Recording().RecordSample(submittedSample);
+		budget.Charge(BudgetCost_Recording);
+	}
+	catch (const std::exception& e) {
+		DebugDriverLog("Exception caught while parsing comm data");
+	}
+}
+
+void LucidGloveDeviceDriver::SubmitButtons(uint16_t buttons, uint16_t changed, float timeOffset) {
+	if (changed & PackedButton_Joystick)
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_JOY_BTN], buttons & PackedButton_Joystick, timeOffset);
+	if (changed & PackedButton_Trigger)
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_TRG], buttons & PackedButton_Trigger, timeOffset);
+	if (changed & PackedButton_A)
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_A], buttons & PackedButton_A, timeOffset);
+	if (changed & PackedButton_B)
+		vr::VRDriverInput()->UpdateBooleanComponent(m_inputComponentHandles[ComponentIndex::COMP_BTN_B], buttons & PackedButton_B, timeOffset);
+}
+
+void LucidGloveDeviceDriver::SubmitLatestInput() {
+	std::optional<PackedSample> sample;
+	{
+		std::lock_guard<std::mutex> lock(m_latestInputMutex);
+		sample.swap(m_latestInput);
+	}
+
+	//nothing new since the last frame, SteamVR keeps the previous state
+	if (sample) HandleInput(*sample);
+}
+
 vr::DriverPose_t LucidGloveDeviceDriver::GetPose() {
 	if (m_hasActivated) return m_controllerPose->UpdatePose();
 
@@ -171,15 +283,45 @@ vr::DriverPose_t LucidGloveDeviceDriver::GetPose() {
 
 void LucidGloveDeviceDriver::RunFrame() {
 	if (m_hasActivated) {
+		const DriverTimePoint start = DriverClock().Now();
+		m_budget.OnFrame(start);
+		BudgetTimer budget(m_budget, start);
+
+		if (m_lateLatchScheduler) {
+			m_lateLatchScheduler->OnRunFrame();
+
+			//in order and at the time they happened, a tap between two frames is a press and a release in the same frame
+			const int64_t nowNs = DriverClock().Now().time_since_epoch().count();
+			m_buttonEvents.Drain([&](const ButtonEvent& event) {
+				SubmitButtons(event.buttons, event.changed, (float)ToSeconds(DriverDuration(event.timeNs - nowNs)));
+			});
+		}
+
+		const bool reportLatency = m_latencyStats.OnFrame(DriverClock().Now());
+		if (m_latencyStats.Samples() > 0) m_control->Counters().frameAge.Observe(m_latencyStats.LastAge());
+
+		if (reportLatency) {
+			DebugDriverLog("Skeleton data age at frame (%s): mean %.2fms, jitter %.2fms",
+				m_lateLatchScheduler ? "late latch" : "per packet", m_latencyStats.MeanMs(), m_latencyStats.JitterMs());
+			m_control->Counters().latencyMeanMs.store((float)m_latencyStats.MeanMs(), std::memory_order_relaxed);
+			m_control->Counters().latencyJitterMs.store((float)m_latencyStats.JitterMs(), std::memory_order_relaxed);
+			m_latencyStats.Reset();
+		}
+
 		vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_driverId, m_controllerPose->UpdatePose(), sizeof(vr::DriverPose_t));
+		budget.Charge(BudgetCost_Pose);
 	}
 }
 
 
 void LucidGloveDeviceDriver::Deactivate() {
 	if (m_hasActivated) {
+		if (m_lateLatchScheduler) m_lateLatchScheduler->Stop();
 		m_communicationManager->Disconnect();
+		m_control->Counters().connected = false;
 		m_driverId = vr::k_unTrackedDeviceIndexInvalid;
+		//Cleanup() deactivates again when vrserver did not
+		m_hasActivated = false;
 	}
 }
 
@@ -190,7 +332,5 @@ void* LucidGloveDeviceDriver::GetComponent(const char* pchComponentNameAndVersio
 void LucidGloveDeviceDriver::EnterStandby() {}
 
 void LucidGloveDeviceDriver::DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) {
-	if (unResponseBufferSize >= 1) {
-		pchResponseBuffer[0] = 0;
-	}
+	m_control->HandleRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
 }
\ No newline at end of file
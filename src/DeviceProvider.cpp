@@ -4,16 +4,23 @@
 #include <string>
 
 #include "Communication/BTSerialCommunicationManager.h"
+#include "Communication/PluginCommunicationManager.h"
 #include "Communication/SerialCommunicationManager.h"
 #include "DeviceDriver/KnuckleDriver.h"
 #include "DeviceDriver/LucidGloveDriver.h"
 #include "DriverLog.h"
 #include "Encode/AlphaEncodingManager.h"
+#include "Encode/InstrumentedEncodingManager.h"
 #include "Encode/LegacyEncodingManager.h"
+#include "Encode/PluginEncodingManager.h"
 #include "Quaternion.h"
+#include "Simd/SimdKernels.h"
 
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 
+// a shutdown step taking longer than this is reported
+static const double c_slowCleanupStepMs = 100.0;
+
 std::string GetDriverPath() {
   char path[MAX_PATH];
   HMODULE hm = NULL;
@@ -64,33 +71,96 @@ vr::EVRInitError DeviceProvider::Init(vr::IVRDriverContext* pDriverContext) {
   InitDriverLog(vr::VRDriverLog());
   DebugDriverLog("OpenGlove is running in DEBUG mode");
 
+  // before anything that runs the numeric kernels is created
+  char simdLimit[32];
+  vr::VRSettings()->GetString(c_driverSettingsSection, "simd_limit", simdLimit, sizeof(simdLimit));
+  SimdIsa limit = SimdIsa_Avx512;
+  if (simdLimit[0] != '\0' && !SimdIsaFromName(simdLimit, limit))
+    DriverLog("Unknown simd_limit '%s', using the best the CPU supports", simdLimit);
+  const SimdIsa bound = BindSimdKernels(limit);
+  DriverLog("Numeric kernels use %s, the CPU supports %s", SimdIsaName(bound),
+            SimdIsaName(DetectSimdIsa()));
+
   if (!CreateBackgroundProcess()) {
     DriverLog("Could not create background process");
     return vr::VRInitError_Init_FileNotFound;
   }
-  
+
+  if (vr::VRSettings()->GetBool(c_driverSettingsSection, "io_reactor_enabled")) {
+    m_ioReactor = std::make_unique<IoReactor>();
+    m_ioReactor->Start();
+  }
+
+  if (vr::VRSettings()->GetBool(c_driverSettingsSection, "diagnostics_enabled")) {
+    m_diagnosticsServer = std::make_unique<DiagnosticsServer>(
+        static_cast<uint16_t>(
+            vr::VRSettings()->GetInt32(c_driverSettingsSection, "diagnostics_port")),
+        vr::VRSettings()->GetFloat(c_driverSettingsSection, "diagnostics_stream_hz"));
+  }
+
+  if (vr::VRSettings()->GetBool(c_driverSettingsSection, "osc_output_enabled")) {
+    char host[256];
+    vr::VRSettings()->GetString(c_driverSettingsSection, "osc_output_host", host, sizeof(host));
+    m_oscSender = std::make_unique<OscSkeletonSender>(
+        host,
+        static_cast<uint16_t>(
+            vr::VRSettings()->GetInt32(c_driverSettingsSection, "osc_output_port")),
+        vr::VRSettings()->GetFloat(c_driverSettingsSection, "osc_output_rate_hz"));
+  }
+
   VRDeviceConfiguration_t leftConfiguration =
       GetDeviceConfiguration(vr::TrackedControllerRole_LeftHand);
   VRDeviceConfiguration_t rightConfiguration =
       GetDeviceConfiguration(vr::TrackedControllerRole_RightHand);
 
+  const auto usesPlugins = [](const VRDeviceConfiguration_t& configuration) {
+    return configuration.enabled &&
+           (configuration.encodingProtocol == VREncodingProtocol::PLUGIN_CODEC ||
+            configuration.communicationProtocol == VRCommunicationProtocol::PLUGIN_TRANSPORT);
+  };
+  if (usesPlugins(leftConfiguration) || usesPlugins(rightConfiguration)) {
+    char directory[MAX_PATH];
+    vr::VRSettings()->GetString(c_pluginSettingsSection, "directory", directory,
+                                sizeof(directory));
+
+    m_pluginRegistry = std::make_unique<PluginRegistry>();
+    m_pluginRegistry->LoadDirectory(directory[0] != '\0' ? std::string(directory)
+                                                         : GetDriverPath() + "\\plugins");
+  }
+
+  const std::string recordingDirectory = GetDriverPath() + "\\recordings";
+
   if (leftConfiguration.enabled) {
-    m_leftHand = InstantiateDeviceDriver(leftConfiguration);
+    auto control =
+        std::make_shared<DeviceControl>(leftConfiguration.inputTuning, recordingDirectory);
+    if (m_diagnosticsServer) m_diagnosticsServer->AddDevice("left", control);
+    if (m_oscSender) m_oscSender->AddDevice(control, false);
+
+    m_leftHand = InstantiateDeviceDriver(leftConfiguration, std::move(control));
     vr::VRServerDriverHost()->TrackedDeviceAdded(
         m_leftHand->GetSerialNumber().c_str(), vr::TrackedDeviceClass_Controller, m_leftHand.get());
   }
   if (rightConfiguration.enabled) {
-    m_rightHand = InstantiateDeviceDriver(rightConfiguration);
+    auto control =
+        std::make_shared<DeviceControl>(rightConfiguration.inputTuning, recordingDirectory);
+    if (m_diagnosticsServer) m_diagnosticsServer->AddDevice("right", control);
+    if (m_oscSender) m_oscSender->AddDevice(control, true);
+
+    m_rightHand = InstantiateDeviceDriver(rightConfiguration, std::move(control));
     vr::VRServerDriverHost()->TrackedDeviceAdded(m_rightHand->GetSerialNumber().c_str(),
                                                  vr::TrackedDeviceClass_Controller,
                                                  m_rightHand.get());
   }
 
+  // diagnostics are optional, the driver runs the same without them
+  if (m_diagnosticsServer && !m_diagnosticsServer->Start()) m_diagnosticsServer.reset();
+  if (m_oscSender && !m_oscSender->Start()) m_oscSender.reset();
+
   return vr::VRInitError_None;
 }
 
 std::unique_ptr<IDeviceDriver> DeviceProvider::InstantiateDeviceDriver(
-    VRDeviceConfiguration_t configuration) {
+    VRDeviceConfiguration_t configuration, std::shared_ptr<DeviceControl> control) {
   std::unique_ptr<ICommunicationManager> communicationManager;
   std::unique_ptr<IEncodingManager> encodingManager;
 
@@ -109,17 +179,71 @@ std::unique_ptr<IDeviceDriver> DeviceProvider::InstantiateDeviceDriver(
       encodingManager = std::make_unique<AlphaEncodingManager>(maxAnalogValue);
       break;
     }
+    case VREncodingProtocol::PLUGIN_CODEC: {
+      char name[64];
+      char config[256];
+      vr::VRSettings()->GetString(c_pluginSettingsSection, "codec", name, sizeof(name));
+      vr::VRSettings()->GetString(c_pluginSettingsSection, "codec_config", config, sizeof(config));
+
+      const OpengloveCodecApi* codec = m_pluginRegistry->FindCodec(name);
+      auto pluginEncodingManager =
+          codec ? std::make_unique<PluginEncodingManager>(codec, config) : nullptr;
+      if (pluginEncodingManager && pluginEncodingManager->IsValid()) {
+        DriverLog("Encoding with plugin codec %s", name);
+        encodingManager = std::move(pluginEncodingManager);
+      } else {
+        DriverLog("Plugin codec %s is not available. Using alpha.", name);
+        encodingManager = std::make_unique<AlphaEncodingManager>(
+            vr::VRSettings()->GetInt32("encoding_alpha", "max_analog_value"));
+      }
+      break;
+    }
+  }
+
+  encodingManager =
+      std::make_unique<InstrumentedEncodingManager>(std::move(encodingManager), control);
+
+  const auto waitStrategy =
+      (VRWaitStrategy)vr::VRSettings()->GetInt32(c_driverSettingsSection, "wait_strategy");
+
+  const VRPipelineConfiguration_t pipeline(
+      vr::VRSettings()->GetBool(c_driverSettingsSection, "pipeline_enabled"),
+      vr::VRSettings()->GetInt32(c_driverSettingsSection, "pipeline_ring_size"),
+      (VRBackpressurePolicy)vr::VRSettings()->GetInt32(c_driverSettingsSection,
+                                                       "pipeline_backpressure"));
+
+  VRCommunicationProtocol communicationProtocol = configuration.communicationProtocol;
+  const OpengloveTransportApi* pluginTransport = nullptr;
+  if (communicationProtocol == VRCommunicationProtocol::PLUGIN_TRANSPORT) {
+    char name[64];
+    vr::VRSettings()->GetString(c_pluginSettingsSection, "transport", name, sizeof(name));
+
+    pluginTransport = m_pluginRegistry->FindTransport(name);
+    if (pluginTransport == nullptr) {
+      DriverLog("Plugin transport %s is not available. Using serial.", name);
+      communicationProtocol = VRCommunicationProtocol::SERIAL;
+    }
   }
 
-  switch (configuration.communicationProtocol) {
+  switch (communicationProtocol) {
+    case VRCommunicationProtocol::PLUGIN_TRANSPORT: {
+      DriverLog("Communication set to plugin transport %s", pluginTransport->name);
+      char config[256];
+      vr::VRSettings()->GetString(c_pluginSettingsSection,
+                                  isRightHand ? "right_config" : "left_config", config,
+                                  sizeof(config));
+      communicationManager = std::make_unique<PluginCommunicationManager>(
+          pluginTransport, config, std::move(encodingManager));
+      break;
+    }
     case VRCommunicationProtocol::BTSERIAL: {
       DriverLog("Communication set to BTSerial");
       char name[248];
       vr::VRSettings()->GetString("communication_btserial",
                                   isRightHand ? "right_name" : "left_name", name, sizeof(name));
-      VRBTSerialConfiguration_t btSerialSettings(name);
+      VRBTSerialConfiguration_t btSerialSettings(name, waitStrategy, pipeline);
       communicationManager = std::make_unique<BTSerialCommunicationManager>(
-          btSerialSettings, std::move(encodingManager));
+          btSerialSettings, std::move(encodingManager), m_ioReactor.get());
       break;
     }
     default:
@@ -128,10 +252,12 @@ std::unique_ptr<IDeviceDriver> DeviceProvider::InstantiateDeviceDriver(
       char port[16];
       vr::VRSettings()->GetString("communication_serial", isRightHand ? "right_port" : "left_port",
                                   port, sizeof(port));
-      VRSerialConfiguration_t serialSettings(port);
+      VRSerialConfiguration_t serialSettings(
+          port, waitStrategy, vr::VRSettings()->GetInt32("communication_serial", "baud_rate"),
+          vr::VRSettings()->GetInt32("communication_serial", "receive_buffer_size"), pipeline);
 
-      communicationManager =
-          std::make_unique<SerialCommunicationManager>(serialSettings, std::move(encodingManager));
+      communicationManager = std::make_unique<SerialCommunicationManager>(
+          serialSettings, std::move(encodingManager), m_ioReactor.get());
       break;
   }
 
@@ -143,7 +269,7 @@ std::unique_ptr<IDeviceDriver> DeviceProvider::InstantiateDeviceDriver(
                                   serialNumber, sizeof(serialNumber));
 
       return std::make_unique<KnuckleDeviceDriver>(configuration, std::move(communicationManager),
-                                                   serialNumber);
+                                                   std::move(control), serialNumber);
     }
 
     default:
@@ -155,7 +281,7 @@ std::unique_ptr<IDeviceDriver> DeviceProvider::InstantiateDeviceDriver(
                                   serialNumber, sizeof(serialNumber));
 
       return std::make_unique<LucidGloveDeviceDriver>(
-          configuration, std::move(communicationManager), serialNumber);
+          configuration, std::move(communicationManager), std::move(control), serialNumber);
     }
   }
 }
@@ -197,6 +323,34 @@ VRDeviceConfiguration_t DeviceProvider::GetDeviceConfiguration(vr::ETrackedContr
                                                                   : "controller_override_left")
           : -1;
 
+  const float trackingLossBridgeMs =
+      vr::VRSettings()->GetFloat(c_poseSettingsSection, "tracking_loss_bridge_ms");
+  const float trackingLossBlendMs =
+      vr::VRSettings()->GetFloat(c_poseSettingsSection, "tracking_loss_blend_ms");
+
+  const bool lateLatchEnabled =
+      vr::VRSettings()->GetBool(c_driverSettingsSection, "late_latch_enabled");
+  const float lateLatchMarginMs =
+      vr::VRSettings()->GetFloat(c_driverSettingsSection, "late_latch_margin_ms");
+
+  char degradeOrder[256];
+  vr::VRSettings()->GetString(c_budgetSettingsSection, "degrade_order", degradeOrder,
+                              sizeof(degradeOrder));
+  const VRBudgetConfiguration_t budgetConfiguration(
+      vr::VRSettings()->GetBool(c_budgetSettingsSection, "enabled"),
+      vr::VRSettings()->GetFloat(c_budgetSettingsSection, "frame_budget_us"),
+      vr::VRSettings()->GetFloat(c_budgetSettingsSection, "restore_headroom"), degradeOrder);
+
+  const VRInputTuning_t inputTuning(
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "smoothing"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "flexion_curve"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "flexion_deadzone"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "joystick_deadzone"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "flexion_min"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "flexion_max"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "grab_threshold"),
+      vr::VRSettings()->GetFloat(c_inputTuningSettingsSection, "pinch_threshold"));
+
   const vr::HmdVector3_t offsetVector = {offsetXPos, offsetYPos, offsetZPos};
 
   // Convert the rotation to a quaternion
@@ -206,11 +360,55 @@ VRDeviceConfiguration_t DeviceProvider::GetDeviceConfiguration(vr::ETrackedContr
   return VRDeviceConfiguration_t(
       role, isEnabled,
       VRPoseConfiguration_t(offsetVector, angleOffsetQuaternion, poseOffset,
-                            controllerOverrideEnabled, controllerIdOverride),
-      encodingProtocol, communicationProtocol, deviceDriver);
+                            controllerOverrideEnabled, controllerIdOverride,
+                            trackingLossBridgeMs, trackingLossBlendMs),
+      VRLateLatchConfiguration_t(lateLatchEnabled, lateLatchMarginMs), budgetConfiguration,
+      inputTuning, encodingProtocol, communicationProtocol, deviceDriver);
 }
 
-void DeviceProvider::Cleanup() {}
+void DeviceProvider::Cleanup() {
+  // every worker the driver started is stopped and joined here, so vrserver never waits on a wedged
+  // thread while unloading. Steps that still take noticeably long get logged.
+  const auto timed = [](const char* step, const auto& action) {
+    const DriverTimePoint start = DriverClock().Now();
+    action();
+    const double elapsedMs = ToSeconds(DriverClock().Now() - start) * 1000.0;
+    if (elapsedMs > c_slowCleanupStepMs) DriverLog("Cleanup: %s took %.1fms", step, elapsedMs);
+  };
+
+  // these hold references to both hands' controls
+  if (m_diagnosticsServer) timed("diagnostics server", [&]() { m_diagnosticsServer->Stop(); });
+  m_diagnosticsServer.reset();
+  if (m_oscSender) timed("osc output", [&]() { m_oscSender->Stop(); });
+  m_oscSender.reset();
+
+  // before the hands: a reconnect can be running on the blocking pool or suspended on the reactor
+  // with a pointer to a hand's transport, Stop() returns once neither will touch it again. The
+  // transports then close whatever is left inline
+  if (m_ioReactor) timed("io reactor", [&]() { m_ioReactor->Stop(); });
+
+  // vrserver does not always deactivate devices before unloading, deactivating twice is harmless
+  if (m_leftHand) {
+    timed("left hand", [&]() {
+      m_leftHand->Deactivate();
+      m_leftHand.reset();
+    });
+  }
+  if (m_rightHand) {
+    timed("right hand", [&]() {
+      m_rightHand->Deactivate();
+      m_rightHand.reset();
+    });
+  }
+
+  // the hands' transports hold its sockets and timers, so it goes after them
+  m_ioReactor.reset();
+  // only once no codec or transport from a plugin is left
+  m_pluginRegistry.reset();
+
+  CleanupDriverLog();
+  VR_CLEANUP_SERVER_DRIVER_CONTEXT();
+}
 
 const char* const* DeviceProvider::GetInterfaceVersions() { return vr::k_InterfaceVersions; }
 
@@ -0,0 +1,448 @@
+#include "Diagnostics/DiagnosticsServer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <string_view>
+
+#include "DriverLog.h"
+#include "DriverTimer.h"
+
+static constexpr int c_maxClients = 8;
+static constexpr size_t c_maxRequestBytes = 4096;
+static constexpr std::string_view c_webSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC11B65";
+
+static void AppendFormat(std::string& out, const char* format, ...) {
+  char line[256];
+
+  va_list args;
+  va_start(args, format);
+  const int length = std::vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+
+  if (length > 0) out.append(line, std::min<size_t>(length, sizeof(line) - 1));
+}
+
+// Only needed for the WebSocket handshake, which hashes the client key with SHA-1 (RFC 6455 4.2.2).
+static std::array<uint8_t, 20> Sha1(std::string_view data) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  auto rotl = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+
+  std::string message(data);
+  const uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+  message.push_back(static_cast<char>(0x80));
+  while (message.size() % 64 != 56) message.push_back(0);
+  for (int i = 7; i >= 0; i--) message.push_back(static_cast<char>(bitLength >> (i * 8)));
+
+  for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const auto* p = reinterpret_cast<const uint8_t*>(message.data() + chunk + i * 4);
+      w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+
+      const uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = temp;
+    }
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+
+  std::array<uint8_t, 20> digest;
+  for (int i = 0; i < 20; i++) digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+  return digest;
+}
+
+static std::string Base64(const uint8_t* data, size_t size) {
+  static constexpr char c_alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  std::string out;
+  for (size_t i = 0; i < size; i += 3) {
+    const uint32_t triple = (uint32_t(data[i]) << 16) | (i + 1 < size ? data[i + 1] << 8 : 0) |
+                            (i + 2 < size ? data[i + 2] : 0);
+    out.push_back(c_alphabet[(triple >> 18) & 0x3F]);
+    out.push_back(c_alphabet[(triple >> 12) & 0x3F]);
+    out.push_back(i + 1 < size ? c_alphabet[(triple >> 6) & 0x3F] : '=');
+    out.push_back(i + 2 < size ? c_alphabet[triple & 0x3F] : '=');
+  }
+  return out;
+}
+
+// Case-insensitive lookup of a header in a raw request, empty if it is not there.
+static std::string_view HeaderValue(std::string_view request, std::string_view name) {
+  size_t lineStart = request.find("\r\n");
+  while (lineStart != std::string_view::npos) {
+    lineStart += 2;
+    const size_t lineEnd = request.find("\r\n", lineStart);
+    const std::string_view line = request.substr(lineStart, lineEnd - lineStart);
+
+    const size_t colon = line.find(':');
+    if (colon == name.size() &&
+        std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) {
+          return std::tolower(static_cast<unsigned char>(a)) ==
+                 std::tolower(static_cast<unsigned char>(b));
+        })) {
+      std::string_view value = line.substr(colon + 1);
+      while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+      while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+      return value;
+    }
+
+    lineStart = lineEnd;
+  }
+  return {};
+}
+
+static std::string PlainResponse(const char* status, std::string_view body) {
+  std::string response = "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: text/plain; charset=utf-8\r\nConnection: close\r\n\r\n";
+  response += body;
+  return response;
+}
+
+// Single unmasked, unfragmented text frame, which is all a server ever needs to send here.
+static void AppendTextFrame(std::string& out, std::string_view payload) {
+  out.push_back(static_cast<char>(0x81));
+  if (payload.size() < 126) {
+    out.push_back(static_cast<char>(payload.size()));
+  } else {
+    out.push_back(126);
+    out.push_back(static_cast<char>(payload.size() >> 8));
+    out.push_back(static_cast<char>(payload.size() & 0xFF));
+  }
+  out += payload;
+}
+
+DiagnosticsServer::DiagnosticsServer(uint16_t port, float streamRateHz)
+    : m_port(port),
+      m_streamPeriod(std::chrono::duration_cast<DriverDuration>(
+          std::chrono::duration<float>(1.f / std::clamp(streamRateHz, 1.f, 120.f)))) {}
+
+DiagnosticsServer::~DiagnosticsServer() { Stop(); }
+
+void DiagnosticsServer::AddDevice(std::string name, std::shared_ptr<DeviceControl> control) {
+  m_devices.push_back({std::move(name), std::move(control)});
+}
+
+bool DiagnosticsServer::Start() {
+  if (m_thread.joinable()) return true;
+
+  // loopback only, this exposes device state and is not meant to be reachable from the network
+  const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), m_port);
+  asio::ip::tcp::acceptor acceptor(m_context);
+  asio::error_code ec;
+  acceptor.open(endpoint.protocol(), ec);
+  if (!ec) acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+  if (!ec) acceptor.bind(endpoint, ec);
+  if (!ec) acceptor.listen(c_maxClients, ec);
+  if (ec) {
+    DriverLog("Diagnostics server could not listen on port %d: %s", m_port, ec.message().c_str());
+    return false;
+  }
+
+  asio::co_spawn(m_context, Listen(std::move(acceptor)), asio::detached);
+
+  m_thread = std::thread([this]() {
+    while (true) {
+      try {
+        m_context.run();
+        break;
+      } catch (const std::exception& e) {
+        DriverLog("Exception escaped a diagnostics handler: %s", e.what());
+      }
+    }
+  });
+
+  DriverLog("Diagnostics server listening on http://127.0.0.1:%d", m_port);
+  return true;
+}
+
+void DiagnosticsServer::Stop() {
+  if (!m_thread.joinable()) return;
+
+  m_context.stop();
+  m_thread.join();
+}
+
+asio::awaitable<void> DiagnosticsServer::Listen(asio::ip::tcp::acceptor acceptor) {
+  while (true) {
+    asio::error_code ec;
+    asio::ip::tcp::socket socket =
+        co_await acceptor.async_accept(asio::redirect_error(asio::use_awaitable, ec));
+    if (ec == asio::error::operation_aborted) co_return;
+    if (ec) continue;
+
+    if (m_clients >= c_maxClients) {
+      socket.close(ec);
+      continue;
+    }
+
+    asio::co_spawn(acceptor.get_executor(), Serve(std::move(socket)), asio::detached);
+  }
+}
+
+asio::awaitable<void> DiagnosticsServer::Serve(asio::ip::tcp::socket socket) {
+  m_clients++;
+  struct ClientSlot {
+    int& clients;
+    ~ClientSlot() { clients--; }
+  } slot{m_clients};
+
+  asio::error_code ec;
+  std::string request;
+  co_await asio::async_read_until(socket, asio::dynamic_buffer(request, c_maxRequestBytes),
+                                  "\r\n\r\n", asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) co_return;
+
+  // "GET /path HTTP/1.1"
+  const std::string_view view(request);
+  const std::string_view requestLine = view.substr(0, view.find("\r\n"));
+  const size_t pathStart = requestLine.find(' ') + 1;
+  const std::string_view method = requestLine.substr(0, pathStart - 1);
+  const std::string_view path =
+      requestLine.substr(pathStart, requestLine.find(' ', pathStart) - pathStart);
+
+  std::string response;
+  if (method != "GET") {
+    response = PlainResponse("405 Method Not Allowed", "");
+  } else if (path == "/metrics") {
+    std::string body;
+    WriteMetrics(body);
+
+    response =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n";
+    response += body;
+  } else if (path == "/stream") {
+    const std::string_view key = HeaderValue(view, "Sec-WebSocket-Key");
+    if (key.empty()) {
+      response = PlainResponse("400 Bad Request", "expected a WebSocket upgrade\n");
+    } else {
+      const auto digest = Sha1(std::string(key) + std::string(c_webSocketGuid));
+      response =
+          "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+          "Sec-WebSocket-Accept: " +
+          Base64(digest.data(), digest.size()) + "\r\n\r\n";
+
+      co_await asio::async_write(socket, asio::buffer(response),
+                                 asio::redirect_error(asio::use_awaitable, ec));
+      if (ec) co_return;
+
+      co_await StreamSnapshots(std::make_shared<asio::ip::tcp::socket>(std::move(socket)));
+      co_return;
+    }
+  } else {
+    response = PlainResponse("404 Not Found", "try /metrics or /stream\n");
+  }
+
+  co_await asio::async_write(socket, asio::buffer(response),
+                             asio::redirect_error(asio::use_awaitable, ec));
+  socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+}
+
+asio::awaitable<void> DiagnosticsServer::StreamSnapshots(
+    std::shared_ptr<asio::ip::tcp::socket> socket) {
+  auto open = std::make_shared<bool>(true);
+
+  // Nothing the client sends matters except that it wants to close, so its frames are read and
+  // dropped. Only the first frame header in each read is looked at, which is enough to catch the
+  // close frame browsers send when the page goes away.
+  asio::co_spawn(
+      socket->get_executor(),
+      [socket, open]() -> asio::awaitable<void> {
+        char buffer[512];
+        asio::error_code ec;
+        while (*open) {
+          const size_t bytesRead = co_await socket->async_read_some(
+              asio::buffer(buffer), asio::redirect_error(asio::use_awaitable, ec));
+          if (ec || (bytesRead > 0 && (buffer[0] & 0x0F) == 0x8)) break;
+        }
+        *open = false;
+      },
+      asio::detached);
+
+  DriverTimer timer(socket->get_executor());
+  std::string json;
+  std::string frame;
+  asio::error_code ec;
+  while (*open) {
+    json.clear();
+    WriteSnapshots(json);
+    frame.clear();
+    AppendTextFrame(frame, json);
+
+    // a slow client only slows down its own stream
+    co_await asio::async_write(*socket, asio::buffer(frame),
+                               asio::redirect_error(asio::use_awaitable, ec));
+    if (ec) break;
+
+    timer.expires_after(m_streamPeriod);
+    co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+  }
+
+  *open = false;
+  socket->close(ec);
+}
+
+void DiagnosticsServer::WriteMetrics(std::string& out) const {
+  const int64_t nowNs = DriverClock().Now().time_since_epoch().count();
+
+  struct Counter {
+    const char* name;
+    const char* help;
+    std::atomic<uint64_t> DeviceCounters::*value;
+  };
+  static constexpr Counter c_counters[] = {
+      {"openglove_packets_total", "Packets received from the device", &DeviceCounters::packets},
+      {"openglove_decode_errors_total", "Packets the decoder rejected",
+       &DeviceCounters::decodeErrors},
+      {"openglove_submitted_total", "Input updates submitted to SteamVR",
+       &DeviceCounters::submitted},
+      {"openglove_reconnects_total", "Reconnects requested through the control plane",
+       &DeviceCounters::reconnects},
+      {"openglove_budget_events_total", "Optional stages degraded or restored by the time budget",
+       &DeviceCounters::budgetEvents},
+  };
+
+  for (const Counter& counter : c_counters) {
+    AppendFormat(out, "# HELP %s %s\n# TYPE %s counter\n", counter.name, counter.help,
+                 counter.name);
+    for (const Device& device : m_devices) {
+      const auto& value = device.control->Counters().*counter.value;
+      AppendFormat(out, "%s{hand=\"%s\"} %llu\n", counter.name, device.name.c_str(),
+                   static_cast<unsigned long long>(value.load(std::memory_order_relaxed)));
+    }
+  }
+
+  out += "# HELP openglove_connected Whether the device is active\n";
+  out += "# TYPE openglove_connected gauge\n";
+  for (const Device& device : m_devices) {
+    AppendFormat(out, "openglove_connected{hand=\"%s\"} %d\n", device.name.c_str(),
+                 device.control->Counters().connected.load(std::memory_order_relaxed) ? 1 : 0);
+  }
+
+  out += "# HELP openglove_frame_cost_seconds Driver time one frame cost over the last window\n";
+  out += "# TYPE openglove_frame_cost_seconds gauge\n";
+  for (const Device& device : m_devices) {
+    AppendFormat(out, "openglove_frame_cost_seconds{hand=\"%s\"} %.6f\n", device.name.c_str(),
+                 device.control->Counters().frameCostUs.load(std::memory_order_relaxed) * 1e-6);
+  }
+
+  out += "# HELP openglove_degraded_stages Optional stages the time budget has degraded, as bits\n";
+  out += "# TYPE openglove_degraded_stages gauge\n";
+  for (const Device& device : m_devices) {
+    AppendFormat(out, "openglove_degraded_stages{hand=\"%s\"} %u\n", device.name.c_str(),
+                 device.control->Counters().degradedStages.load(std::memory_order_relaxed));
+  }
+
+  out += "# HELP openglove_last_packet_age_seconds Time since the last packet arrived\n";
+  out += "# TYPE openglove_last_packet_age_seconds gauge\n";
+  for (const Device& device : m_devices) {
+    const int64_t lastPacketNs =
+        device.control->Counters().lastPacketNs.load(std::memory_order_relaxed);
+    if (lastPacketNs == 0) continue;
+
+    AppendFormat(out, "openglove_last_packet_age_seconds{hand=\"%s\"} %.6f\n",
+                 device.name.c_str(), (nowNs - lastPacketNs) * 1e-9);
+  }
+
+  struct Stage {
+    const char* name;
+    LatencyHistogram DeviceCounters::*histogram;
+  };
+  static constexpr Stage c_stages[] = {
+      {"decode", &DeviceCounters::decodeLatency},
+      {"submit", &DeviceCounters::submitLatency},
+      {"frame_age", &DeviceCounters::frameAge},
+  };
+
+  out += "# HELP openglove_stage_latency_seconds Time spent in each stage of the input path\n";
+  out += "# TYPE openglove_stage_latency_seconds histogram\n";
+  for (const Device& device : m_devices) {
+    for (const Stage& stage : c_stages) {
+      const LatencyHistogram& histogram = device.control->Counters().*stage.histogram;
+
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i < LatencyHistogram::c_bucketCount; i++) {
+        cumulative += histogram.BucketCount(i);
+
+        char bound[32] = "+Inf";
+        if (i < LatencyHistogram::c_bucketBoundsUs.size()) {
+          std::snprintf(bound, sizeof(bound), "%g", LatencyHistogram::c_bucketBoundsUs[i] * 1e-6);
+        }
+        AppendFormat(out,
+                     "openglove_stage_latency_seconds_bucket{hand=\"%s\",stage=\"%s\",le=\"%s\"} "
+                     "%llu\n",
+                     device.name.c_str(), stage.name, bound,
+                     static_cast<unsigned long long>(cumulative));
+      }
+
+      AppendFormat(out, "openglove_stage_latency_seconds_sum{hand=\"%s\",stage=\"%s\"} %.9f\n",
+                   device.name.c_str(), stage.name, histogram.SumSeconds());
+      // buckets are read one by one while packets keep arriving, keep the count consistent with them
+      AppendFormat(out, "openglove_stage_latency_seconds_count{hand=\"%s\",stage=\"%s\"} %llu\n",
+                   device.name.c_str(), stage.name, static_cast<unsigned long long>(cumulative));
+    }
+  }
+}
+
+void DiagnosticsServer::WriteSnapshots(std::string& out) const {
+  const int64_t nowNs = DriverClock().Now().time_since_epoch().count();
+
+  out += "{\"hands\":[";
+  for (size_t i = 0; i < m_devices.size(); i++) {
+    const Device& device = m_devices[i];
+    const DeviceCounters& counters = device.control->Counters();
+    const PackedSample packed = device.control->Snapshot();
+    const VRCommData_t snapshot = UnpackSample(packed);
+
+    if (i > 0) out += ',';
+    AppendFormat(out, "{\"hand\":\"%s\",\"connected\":%s,\"packets\":%llu,\"decode_errors\":%llu,",
+                 device.name.c_str(),
+                 counters.connected.load(std::memory_order_relaxed) ? "true" : "false",
+                 static_cast<unsigned long long>(counters.packets.load(std::memory_order_relaxed)),
+                 static_cast<unsigned long long>(
+                     counters.decodeErrors.load(std::memory_order_relaxed)));
+    AppendFormat(out, "\"latency_ms\":%.3f,\"jitter_ms\":%.3f,\"sample_age_ms\":%.1f,",
+                 counters.latencyMeanMs.load(std::memory_order_relaxed),
+                 counters.latencyJitterMs.load(std::memory_order_relaxed),
+                 packed.timeNs == 0 ? -1.0 : (nowNs - packed.timeNs) * 1e-6);
+    AppendFormat(out, "\"flexion\":[%.3f,%.3f,%.3f,%.3f,%.3f],", snapshot.flexion[0],
+                 snapshot.flexion[1], snapshot.flexion[2], snapshot.flexion[3],
+                 snapshot.flexion[4]);
+    AppendFormat(out, "\"splay\":[%.3f,%.3f,%.3f,%.3f,%.3f],", snapshot.splay[0], snapshot.splay[1],
+                 snapshot.splay[2], snapshot.splay[3], snapshot.splay[4]);
+    AppendFormat(out, "\"joystick\":[%.3f,%.3f],\"buttons\":%u,\"sequence\":%u}", snapshot.joyX,
+                 snapshot.joyY, static_cast<unsigned>(packed.buttons), packed.sequence);
+  }
+  out += "]}";
+}
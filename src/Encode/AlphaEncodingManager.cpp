@@ -1,8 +1,9 @@
 #include <Encode/AlphaEncodingManager.h>
 
-#include <sstream>
-#include <vector>
-#include "DriverLog.h"
+#include <stdexcept>
+#include <string_view>
+
+#include "Encode/AnalogValue.h"
 
 
 /* Alpha encoding uses the wasted data in the delimiter from legacy to allow for optional arguments and redundancy over smaller packets
@@ -24,17 +25,7 @@
 * 
 */
 
-std::string AlphaEncodingManager::getArgumentSubstring(std::string str, char del) { 
-    int start = str.find(del);
-    if (start == std::string::npos)
-        return NULL;
-    int end = str.find_first_of(alphabet, start + 1); //characters may not necessarily be in order, so end at any letter
-    return str.substr(start, end - start);
-}
-
-bool argValid(std::string str, char del) { return str.find(del) != std::string::npos; }
-
-VRCommData_t AlphaEncodingManager::Decode(std::string input) {
+VRCommData_t AlphaEncodingManager::Decode(std::string_view input) {
 
     std::array<float, 5> flexion;
     std::array<float, 5> splay;
@@ -44,43 +35,50 @@ VRCommData_t AlphaEncodingManager::Decode(std::string input) {
         splay[i] = 0.5;
     }
 
-    if (argValid(input, 'A'))
-      flexion[0] =
-          stof(getArgumentSubstring(input, 'A').substr(1, std::string::npos)) / m_maxAnalogValue;
-    if (argValid(input, 'B'))
-      flexion[1] =
-          stof(getArgumentSubstring(input, 'B').substr(1, std::string::npos)) / m_maxAnalogValue;
-    if (argValid(input, 'C'))
-      flexion[2] =
-          stof(getArgumentSubstring(input, 'C').substr(1, std::string::npos)) / m_maxAnalogValue;
-    if (argValid(input, 'D'))
-      flexion[3] =
-          stof(getArgumentSubstring(input, 'D').substr(1, std::string::npos)) / m_maxAnalogValue;
-    if (argValid(input, 'E'))
-      flexion[4] =
-          stof(getArgumentSubstring(input, 'E').substr(1, std::string::npos)) / m_maxAnalogValue;
+    //one pass over the input. Only the first occurrence of a key counts, the value runs until the next key
+    std::array<float, c_argumentCount> values{};
+    uint32_t present = 0;
+
+    for (size_t pos = 0; pos < input.size(); pos++) {
+        const char key = input[pos];
+        if (key < 'A' || key >= 'A' + c_argumentCount) continue;
+
+        const int argument = key - 'A';
+        if (present & (1u << argument)) continue;
+        present |= 1u << argument;
+
+        if (argument >= c_analogArgumentCount) continue;
+
+        const size_t used = ParseAnalogValue(input.substr(pos + 1), values[argument]);
+        if (used == 0) throw std::invalid_argument("Alpha packet has an analog key without a value");
+
+        pos += used;
+    }
+
+    auto has = [present](char key) { return (present & (1u << (key - 'A'))) != 0; };
+
+    for (int i = 0; i < 5; i++)
+        if (has('A' + i)) flexion[i] = values[i] / m_maxAnalogValue;
 
     float joyX = 0;
     float joyY = 0;
 
-    if (argValid(input, 'F'))
-      joyX = 2 * stof(getArgumentSubstring(input, 'F').substr(1, std::string::npos)) / m_maxAnalogValue - 1;
-    if (argValid(input, 'G'))
-      joyY = 2 * stof(getArgumentSubstring(input, 'G').substr(1, std::string::npos)) / m_maxAnalogValue - 1;
+    if (has('F')) joyX = 2 * values['F' - 'A'] / m_maxAnalogValue - 1;
+    if (has('G')) joyY = 2 * values['G' - 'A'] / m_maxAnalogValue - 1;
 
     VRCommData_t commData(
         flexion,
         splay,
         joyX,
         joyY,
-        argValid(input, 'H'), //joystick click
-        argValid(input, 'I'), //trigger
-        argValid(input, 'J'), //A button
-        argValid(input, 'K'), //B button
-        argValid(input, 'L'), //grab
-        argValid(input, 'M'), //pinch
-        argValid(input, 'O')  //calibration (N reserved for menu btn)
+        has('H'), //joystick click
+        has('I'), //trigger
+        has('J'), //A button
+        has('K'), //B button
+        has('L'), //grab
+        has('M'), //pinch
+        has('O')  //calibration (N reserved for menu btn)
     );
 
     return commData;
-}
\ No newline at end of file
+}
@@ -0,0 +1,48 @@
+#include "Encode/AnalogValue.h"
+
+#include <cstdint>
+
+namespace {
+// more fraction digits than this are past float precision for any value the firmware sends
+constexpr int c_maxFractionDigits = 6;
+}  // namespace
+
+size_t ParseAnalogValue(std::string_view text, float& value) {
+  size_t pos = 0;
+  while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) pos++;
+
+  bool negative = false;
+  if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) negative = text[pos++] == '-';
+
+  const uint64_t saturation = static_cast<uint64_t>(c_maxAnalogMagnitude);
+  uint64_t whole = 0;
+  bool sawDigit = false;
+
+  for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++) {
+    sawDigit = true;
+    if (whole < saturation) whole = whole * 10 + (text[pos] - '0');
+  }
+
+  uint32_t fraction = 0;
+  uint32_t scale = 1;
+
+  if (pos < text.size() && text[pos] == '.') {
+    pos++;
+    for (int digits = 0; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++) {
+      sawDigit = true;
+      if (digits++ < c_maxFractionDigits) {
+        fraction = fraction * 10 + (text[pos] - '0');
+        scale *= 10;
+      }
+    }
+  }
+
+  if (!sawDigit) return 0;
+
+  const float magnitude = whole >= saturation
+                        ? c_maxAnalogMagnitude
+                        : static_cast<float>(whole) + static_cast<float>(fraction) / scale;
+
+  value = negative ? -magnitude : magnitude;
+  return pos;
+}
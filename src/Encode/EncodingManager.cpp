@@ -0,0 +1,23 @@
+#include "Encode/EncodingManager.h"
+
+#include <stdexcept>
+
+#include "Clock.h"
+#include "Encode/PackedSample.h"
+
+size_t IEncodingManager::DecodeBatch(const std::string_view* frames, size_t count, PackedSample* samples) {
+	//every frame in a batch came in with the same read
+	const int64_t nowNs = DriverClock().Now().time_since_epoch().count();
+	size_t decoded = 0;
+	for (size_t i = 0; i < count; i++) {
+		try {
+			samples[decoded] = PackSample(Decode(frames[i]), 0, nowNs);
+			decoded++;
+		}
+		catch (const std::invalid_argument&) {
+			//the frame is left out, InstrumentedEncodingManager counts it
+		}
+	}
+
+	return decoded;
+}
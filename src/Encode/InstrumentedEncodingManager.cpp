@@ -0,0 +1,43 @@
+#include <Encode/InstrumentedEncodingManager.h>
+
+#include <stdexcept>
+
+InstrumentedEncodingManager::InstrumentedEncodingManager(std::unique_ptr<IEncodingManager> encodingManager, std::shared_ptr<DeviceControl> control)
+	: m_encodingManager(std::move(encodingManager)), m_control(std::move(control)) {}
+
+VRCommData_t InstrumentedEncodingManager::Decode(std::string_view input) {
+	DeviceCounters& counters = m_control->Counters();
+	counters.packets.fetch_add(1, std::memory_order_relaxed);
+
+	const DriverTimePoint start = DriverClock().Now();
+	counters.lastPacketNs.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+
+	m_control->Capture().RecordFrame(input);
+
+	try {
+		VRCommData_t commData = m_encodingManager->Decode(input);
+		counters.decodeLatency.Observe(DriverClock().Now() - start);
+		return commData;
+	}
+	catch (const std::invalid_argument&) {
+		counters.decodeErrors.fetch_add(1, std::memory_order_relaxed);
+		throw;
+	}
+}
+
+size_t InstrumentedEncodingManager::DecodeBatch(const std::string_view* frames, size_t count, PackedSample* samples) {
+	DeviceCounters& counters = m_control->Counters();
+	counters.packets.fetch_add(count, std::memory_order_relaxed);
+
+	const DriverTimePoint start = DriverClock().Now();
+	counters.lastPacketNs.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+
+	for (size_t i = 0; i < count; i++) m_control->Capture().RecordFrame(frames[i]);
+
+	const size_t decoded = m_encodingManager->DecodeBatch(frames, count, samples);
+	if (decoded < count) counters.decodeErrors.fetch_add(count - decoded, std::memory_order_relaxed);
+
+	//the histogram is per frame, a batch counts as one observation of its average
+	if (count > 0) counters.decodeLatency.Observe((DriverClock().Now() - start) / count);
+	return decoded;
+}
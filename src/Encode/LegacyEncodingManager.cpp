@@ -1,20 +1,23 @@
 #include <Encode/LegacyEncodingManager.h>
 
-#include <sstream>
-#include <vector>
-#include "DriverLog.h"
+#include <stdexcept>
+#include <string_view>
 
-VRCommData_t LegacyEncodingManager::Decode(std::string input) {
-    std::string buf;
-    std::stringstream ss(input);
+#include "Encode/AnalogValue.h"
 
-    std::vector<float> tokens(VRCommDataInputPosition::MAX);
-    std::fill(tokens.begin(), tokens.begin() + VRCommDataInputPosition::MAX, 0.0f);
+VRCommData_t LegacyEncodingManager::Decode(std::string_view input) {
+    std::array<float, VRCommDataInputPosition::MAX> tokens{};
 
-    short i = 0;
-    while (getline(ss, buf, '&')) {
-        tokens[i] = std::stof(buf);
-        i++;
+    //fields past the last known position are ignored rather than written past the end
+    size_t start = 0;
+    for (int i = 0; i < VRCommDataInputPosition::MAX && start < input.size(); i++) {
+        size_t end = input.find('&', start);
+        if (end == std::string_view::npos) end = input.size();
+
+        if (ParseAnalogValue(input.substr(start, end - start), tokens[i]) == 0)
+            throw std::invalid_argument("Legacy packet has an empty or non-numeric field");
+
+        start = end + 1;
     }
 
     std::array<float, 5> flexion;
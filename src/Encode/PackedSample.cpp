@@ -0,0 +1,72 @@
+#include "Encode/PackedSample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr float c_unitScale = 65535.f;
+static constexpr float c_axisScale = 32767.f;
+
+// Flexion and splay convert together as one block, padded to a whole number of vector registers
+// so the branch-free loops vectorise without a scalar tail.
+static constexpr size_t c_fingerLanes = 16;
+
+PackedSample PackSample(const VRCommData_t& data, uint32_t sequence, int64_t timeNs) {
+  PackedSample sample{};
+  sample.timeNs = timeNs;
+  sample.sequence = sequence;
+
+  float lanes[c_fingerLanes] = {};
+  for (size_t i = 0; i < 5; i++) {
+    lanes[i] = data.flexion[i];
+    lanes[i + 5] = data.splay[i];
+  }
+
+  // Clamped in float before converting, the conversion is undefined for anything out of range and
+  // decoders can hand on NaN or saturated values. The operand order makes a NaN come out as 0,
+  // which packs as open.
+  uint16_t packed[c_fingerLanes];
+  for (size_t i = 0; i < c_fingerLanes; i++) {
+    const float value = std::min(c_unitScale, std::max(0.f, lanes[i] * c_unitScale));
+    packed[i] = static_cast<uint16_t>(static_cast<int32_t>(value + 0.5f));
+  }
+
+  std::memcpy(sample.flexion, packed, sizeof(sample.flexion));
+  std::memcpy(sample.splay, packed + 5, sizeof(sample.splay));
+
+  // round half away from zero so the axes stay symmetric, a NaN axis packs as centred
+  const float joyX = (std::isnan(data.joyX) ? 0.f : std::clamp(data.joyX, -1.f, 1.f)) * c_axisScale;
+  const float joyY = (std::isnan(data.joyY) ? 0.f : std::clamp(data.joyY, -1.f, 1.f)) * c_axisScale;
+  sample.joyX = static_cast<int16_t>(joyX + (joyX < 0.f ? -0.5f : 0.5f));
+  sample.joyY = static_cast<int16_t>(joyY + (joyY < 0.f ? -0.5f : 0.5f));
+
+  sample.buttons = static_cast<uint16_t>(
+      (data.joyButton ? PackedButton_Joystick : 0) | (data.trgButton ? PackedButton_Trigger : 0) |
+      (data.aButton ? PackedButton_A : 0) | (data.bButton ? PackedButton_B : 0) |
+      (data.grab ? PackedButton_Grab : 0) | (data.pinch ? PackedButton_Pinch : 0) |
+      (data.calibrate ? PackedButton_Calibrate : 0));
+
+  return sample;
+}
+
+VRCommData_t UnpackSample(const PackedSample& sample) {
+  uint16_t packed[c_fingerLanes] = {};
+  std::memcpy(packed, sample.flexion, sizeof(sample.flexion));
+  std::memcpy(packed + 5, sample.splay, sizeof(sample.splay));
+
+  float lanes[c_fingerLanes];
+  for (size_t i = 0; i < c_fingerLanes; i++) lanes[i] = packed[i] * (1.f / c_unitScale);
+
+  std::array<float, 5> flexion;
+  std::array<float, 5> splay;
+  for (size_t i = 0; i < 5; i++) {
+    flexion[i] = lanes[i];
+    splay[i] = lanes[i + 5];
+  }
+
+  return VRCommData_t(flexion, splay, sample.joyX * (1.f / c_axisScale),
+                      sample.joyY * (1.f / c_axisScale), sample.buttons & PackedButton_Joystick,
+                      sample.buttons & PackedButton_Trigger, sample.buttons & PackedButton_A,
+                      sample.buttons & PackedButton_B, sample.buttons & PackedButton_Grab,
+                      sample.buttons & PackedButton_Pinch, sample.buttons & PackedButton_Calibrate);
+}
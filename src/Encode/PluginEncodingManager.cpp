@@ -0,0 +1,85 @@
+#include "Encode/PluginEncodingManager.h"
+
+#include <stdexcept>
+
+#include "Clock.h"
+#include "Encode/PackedSample.h"
+
+static constexpr bool SameBit(int pluginButton, PackedButton packedButton) {
+  return pluginButton == packedButton;
+}
+static_assert(SameBit(OPENGLOVE_BUTTON_JOYSTICK, PackedButton_Joystick) &&
+                  SameBit(OPENGLOVE_BUTTON_TRIGGER, PackedButton_Trigger) &&
+                  SameBit(OPENGLOVE_BUTTON_A, PackedButton_A) &&
+                  SameBit(OPENGLOVE_BUTTON_B, PackedButton_B) &&
+                  SameBit(OPENGLOVE_BUTTON_GRAB, PackedButton_Grab) &&
+                  SameBit(OPENGLOVE_BUTTON_PINCH, PackedButton_Pinch) &&
+                  SameBit(OPENGLOVE_BUTTON_CALIBRATE, PackedButton_Calibrate),
+              "plugin button bits are the packed ones");
+
+// room for a full receive buffer of short frames, so a batch rarely has to grow the arrays
+static const size_t c_initialBatchSize = 256;
+
+static VRCommData_t FromPluginSample(const OpengloveSample& sample) {
+  std::array<float, 5> flexion;
+  std::array<float, 5> splay;
+  for (size_t i = 0; i < 5; i++) {
+    flexion[i] = sample.flexion[i];
+    splay[i] = sample.splay[i];
+  }
+
+  const uint32_t buttons = sample.buttons;
+  return VRCommData_t(flexion, splay, sample.joyX, sample.joyY, buttons & PackedButton_Joystick,
+                      buttons & PackedButton_Trigger, buttons & PackedButton_A,
+                      buttons & PackedButton_B, buttons & PackedButton_Grab,
+                      buttons & PackedButton_Pinch, buttons & PackedButton_Calibrate);
+}
+
+PluginEncodingManager::PluginEncodingManager(const OpengloveCodecApi* codec,
+                                             const std::string& config)
+    : m_codec(codec),
+      m_instance(codec->Create(config.c_str())),
+      m_frames(c_initialBatchSize),
+      m_samples(c_initialBatchSize),
+      m_accepted(c_initialBatchSize) {}
+
+PluginEncodingManager::~PluginEncodingManager() {
+  if (m_instance != nullptr) m_codec->Destroy(m_instance);
+}
+
+VRCommData_t PluginEncodingManager::Decode(std::string_view input) {
+  DecodeFrames(&input, 1);
+  if (!m_accepted[0]) throw std::invalid_argument("frame rejected by plugin codec");
+
+  return FromPluginSample(m_samples[0]);
+}
+
+size_t PluginEncodingManager::DecodeBatch(const std::string_view* frames, size_t count,
+                                          PackedSample* samples) {
+  DecodeFrames(frames, count);
+
+  const int64_t nowNs = DriverClock().Now().time_since_epoch().count();
+  size_t decoded = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (m_accepted[i]) samples[decoded++] = PackSample(FromPluginSample(m_samples[i]), 0, nowNs);
+  }
+
+  return decoded;
+}
+
+void PluginEncodingManager::DecodeFrames(const std::string_view* frames, size_t count) {
+  if (count > m_frames.size()) {
+    m_frames.resize(count);
+    m_samples.resize(count);
+    m_accepted.resize(count);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    m_frames[i] = {frames[i].data(), static_cast<uint32_t>(frames[i].size())};
+    m_accepted[i] = 0;
+  }
+
+  if (m_instance == nullptr || count == 0) return;
+  m_codec->Decode(m_instance, m_frames.data(), static_cast<uint32_t>(count), m_samples.data(),
+                  m_accepted.data());
+}
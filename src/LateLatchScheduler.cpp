@@ -0,0 +1,115 @@
+#include "LateLatchScheduler.h"
+
+#include <cmath>
+
+// Gains of the loop that tracks RunFrame. Period adapts slowly, phase a little faster so a
+// re-projected or dropped frame doesn't throw the schedule off.
+static const double c_periodGain = 0.02;
+static const double c_phaseGain = 0.1;
+static const int64_t c_noPhase = INT64_MIN;
+
+void SubmissionLatencyStats::OnSubmit(DriverTimePoint time) {
+  m_lastSubmitNs.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool SubmissionLatencyStats::OnFrame(DriverTimePoint time) {
+  const int64_t lastSubmit = m_lastSubmitNs.load(std::memory_order_relaxed);
+  if (lastSubmit == c_noPhase) return false;
+
+  m_lastAge = time.time_since_epoch() - DriverDuration(lastSubmit);
+  const double age = ToSeconds(m_lastAge);
+
+  // Welford's online algorithm
+  m_count++;
+  const double delta = age - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (age - m_mean);
+
+  return m_count % reportInterval == 0;
+}
+
+void SubmissionLatencyStats::Reset() {
+  m_count = 0;
+  m_mean = 0;
+  m_m2 = 0;
+}
+
+double SubmissionLatencyStats::JitterMs() const {
+  if (m_count < 2) return 0;
+  return std::sqrt(m_m2 / (m_count - 1)) * 1000.0;
+}
+
+LateLatchScheduler::LateLatchScheduler(DriverDuration initialPeriod, DriverDuration margin)
+    : m_periodNs(initialPeriod.count()),
+      m_phaseNs(c_noPhase),
+      m_margin(margin),
+      m_threadActive(false) {}
+
+LateLatchScheduler::~LateLatchScheduler() { Stop(); }
+
+void LateLatchScheduler::Start(const std::function<void()>& submit) {
+  if (m_threadActive) return;
+
+  m_threadActive = true;
+  m_stop.Reset();
+  m_submitThread = std::thread(&LateLatchScheduler::SubmitThread, this, submit);
+}
+
+void LateLatchScheduler::Stop() {
+  if (!m_threadActive) return;
+
+  m_threadActive = false;
+  m_stop.Set();
+  if (m_submitThread.joinable()) m_submitThread.join();
+}
+
+void LateLatchScheduler::OnRunFrame() {
+  const int64_t now = DriverClock().Now().time_since_epoch().count();
+  const int64_t phase = m_phaseNs.load(std::memory_order_relaxed);
+  int64_t period = m_periodNs.load(std::memory_order_relaxed);
+
+  if (phase == c_noPhase) {
+    m_phaseNs.store(now, std::memory_order_release);
+    return;
+  }
+
+  const int64_t elapsed = now - phase;
+  const int64_t frames = (elapsed + period / 2) / period;
+
+  // We lost track (driver stalled, SteamVR paused). Re-sync phase and keep the learned period.
+  if (frames < 1 || frames > 4) {
+    m_phaseNs.store(now, std::memory_order_release);
+    return;
+  }
+
+  const int64_t error = now - (phase + frames * period);
+  period += static_cast<int64_t>(c_periodGain * error / frames);
+
+  m_periodNs.store(period, std::memory_order_relaxed);
+  m_phaseNs.store(phase + frames * period + static_cast<int64_t>(c_phaseGain * error),
+                  std::memory_order_release);
+}
+
+DriverTimePoint LateLatchScheduler::NextDeadline(DriverTimePoint now) const {
+  const int64_t period = m_periodNs.load(std::memory_order_relaxed);
+  const int64_t phase = m_phaseNs.load(std::memory_order_acquire);
+
+  // No frame seen yet, just run at the expected rate.
+  if (phase == c_noPhase) return now + DriverDuration(period);
+
+  const int64_t nowNs = now.time_since_epoch().count();
+  const int64_t margin = m_margin.count();
+
+  int64_t frames = (nowNs + margin - phase) / period + 1;
+  if (frames < 1) frames = 1;
+
+  return DriverTimePoint(DriverDuration(phase + frames * period - margin));
+}
+
+void LateLatchScheduler::SubmitThread(const std::function<void()>& submit) {
+  while (m_threadActive) {
+    if (!DriverClock().SleepUntil(NextDeadline(DriverClock().Now()), m_stop)) break;
+
+    submit();
+  }
+}
@@ -0,0 +1,16 @@
+#include "LatencyHistogram.h"
+
+void LatencyHistogram::Observe(DriverDuration latency) {
+  const int64_t latencyNs = latency.count();
+
+  size_t bucket = 0;
+  while (bucket < c_bucketBoundsUs.size() && latencyNs > c_bucketBoundsUs[bucket] * 1000) bucket++;
+
+  m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sumNs.fetch_add(latencyNs, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::SumSeconds() const {
+  return ToSeconds(DriverDuration(m_sumNs.load(std::memory_order_relaxed)));
+}
@@ -0,0 +1,162 @@
+#include "Output/OscSkeletonSender.h"
+
+#include <algorithm>
+
+#include "DriverLog.h"
+#include "DriverTimer.h"
+
+// even with nothing changing, receivers drop a source that stays silent for too long
+static const DriverDuration c_keepAlivePeriod = std::chrono::seconds(1);
+
+struct VmcBone {
+  HandSkeletonBone bone;
+  const char* left;
+  const char* right;
+};
+
+// Unity's humanoid thumb starts at the metacarpal, the other fingers at the proximal phalanx
+static constexpr VmcBone c_vmcBones[] = {
+    {eBone_Thumb0, "LeftThumbProximal", "RightThumbProximal"},
+    {eBone_Thumb1, "LeftThumbIntermediate", "RightThumbIntermediate"},
+    {eBone_Thumb2, "LeftThumbDistal", "RightThumbDistal"},
+    {eBone_IndexFinger1, "LeftIndexProximal", "RightIndexProximal"},
+    {eBone_IndexFinger2, "LeftIndexIntermediate", "RightIndexIntermediate"},
+    {eBone_IndexFinger3, "LeftIndexDistal", "RightIndexDistal"},
+    {eBone_MiddleFinger1, "LeftMiddleProximal", "RightMiddleProximal"},
+    {eBone_MiddleFinger2, "LeftMiddleIntermediate", "RightMiddleIntermediate"},
+    {eBone_MiddleFinger3, "LeftMiddleDistal", "RightMiddleDistal"},
+    {eBone_RingFinger1, "LeftRingProximal", "RightRingProximal"},
+    {eBone_RingFinger2, "LeftRingIntermediate", "RightRingIntermediate"},
+    {eBone_RingFinger3, "LeftRingDistal", "RightRingDistal"},
+    {eBone_PinkyFinger1, "LeftLittleProximal", "RightLittleProximal"},
+    {eBone_PinkyFinger2, "LeftLittleIntermediate", "RightLittleIntermediate"},
+    {eBone_PinkyFinger3, "LeftLittleDistal", "RightLittleDistal"},
+};
+
+OscSkeletonSender::OscSkeletonSender(std::string host, uint16_t port, float rateHz)
+    : m_host(std::move(host)),
+      m_port(port),
+      m_period(std::chrono::duration_cast<DriverDuration>(
+          std::chrono::duration<float>(1.f / std::clamp(rateHz, 1.f, 240.f)))),
+      m_socket(m_context),
+      m_writer(m_buffer.data(), m_buffer.size()) {}
+
+OscSkeletonSender::~OscSkeletonSender() { Stop(); }
+
+void OscSkeletonSender::AddDevice(std::shared_ptr<DeviceControl> control, bool isRightHand) {
+  const uint32_t version = control->Skeleton().Version();
+  m_devices.push_back({std::move(control), isRightHand, version});
+}
+
+bool OscSkeletonSender::Start() {
+  if (m_thread.joinable()) return true;
+
+  asio::error_code ec;
+  asio::ip::udp::resolver resolver(m_context);
+  const auto endpoints =
+      resolver.resolve(asio::ip::udp::v4(), m_host, std::to_string(m_port), ec);
+  if (!ec && endpoints.empty()) ec = asio::error::host_not_found;
+  if (!ec) m_endpoint = *endpoints.begin();
+  if (!ec) m_socket.open(asio::ip::udp::v4(), ec);
+  if (ec) {
+    DriverLog("OSC output could not reach %s:%d: %s", m_host.c_str(), m_port,
+              ec.message().c_str());
+    return false;
+  }
+
+  m_startTime = DriverClock().Now();
+  asio::co_spawn(m_context, SendLoop(), asio::detached);
+
+  m_thread = std::thread([this]() { m_context.run(); });
+
+  DriverLog("Sending finger bones over OSC to %s:%d", m_host.c_str(), m_port);
+  return true;
+}
+
+void OscSkeletonSender::Stop() {
+  if (!m_thread.joinable()) return;
+
+  m_context.stop();
+  m_thread.join();
+
+  DebugDriverLog("OSC output stopped. %llu datagrams sent, %llu send errors", m_datagrams,
+                 m_sendErrors);
+}
+
+asio::awaitable<void> OscSkeletonSender::SendLoop() {
+  DriverTimer timer(m_context);
+  asio::error_code ec;
+  DriverTimePoint lastSent = DriverClock().Now();
+
+  while (true) {
+    const DriverTimePoint now = DriverClock().Now();
+    if (WriteBundle(now - lastSent >= c_keepAlivePeriod)) {
+      // the receiver is usually on the same machine, a failed send only loses this tick
+      co_await m_socket.async_send_to(asio::buffer(m_writer.Data(), m_writer.Size()), m_endpoint,
+                                      asio::redirect_error(asio::use_awaitable, ec));
+      if (ec) {
+        m_sendErrors++;
+      } else {
+        m_datagrams++;
+      }
+      lastSent = now;
+    }
+
+    timer.expires_after(m_period);
+    co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+  }
+}
+
+bool OscSkeletonSender::WriteBundle(bool force) {
+  bool changed = force;
+  for (const Device& device : m_devices) {
+    changed |= device.control->Skeleton().Version() != device.sentVersion;
+  }
+  if (!changed) return false;
+
+  m_writer.Reset();
+  m_writer.BeginBundle();
+
+  m_writer.BeginMessage("/VMC/Ext/OK", "i");
+  m_writer.AddInt(1);
+  m_writer.EndMessage();
+
+  m_writer.BeginMessage("/VMC/Ext/T", "f");
+  m_writer.AddFloat(static_cast<float>(ToSeconds(DriverClock().Now() - m_startTime)));
+  m_writer.EndMessage();
+
+  for (Device& device : m_devices) {
+    if (!device.control->Counters().connected.load(std::memory_order_relaxed)) continue;
+
+    const HandSkeleton skeleton = device.control->Skeleton().Load(&device.sentVersion);
+    const VRCommData_t sample = UnpackSample(device.control->Snapshot());
+
+    for (const VmcBone& vmcBone : c_vmcBones) {
+      const vr::VRBoneTransform_t& transform = skeleton.bones[vmcBone.bone];
+
+      // OpenVR is right-handed and Unity left-handed, z flips
+      m_writer.BeginMessage("/VMC/Ext/Bone/Pos", "sfffffff");
+      m_writer.AddString(device.isRightHand ? vmcBone.right : vmcBone.left);
+      m_writer.AddFloat(transform.position.v[0]);
+      m_writer.AddFloat(transform.position.v[1]);
+      m_writer.AddFloat(-transform.position.v[2]);
+      m_writer.AddFloat(-transform.orientation.x);
+      m_writer.AddFloat(-transform.orientation.y);
+      m_writer.AddFloat(transform.orientation.z);
+      m_writer.AddFloat(transform.orientation.w);
+      m_writer.EndMessage();
+    }
+
+    m_writer.BeginMessage(device.isRightHand ? "/openglove/right/curl" : "/openglove/left/curl",
+                          "fffff");
+    for (float flexion : sample.flexion) m_writer.AddFloat(flexion);
+    m_writer.EndMessage();
+  }
+
+  if (m_writer.Overflowed()) {
+    DriverLog("OSC bundle did not fit in %zu bytes, not sending it", m_buffer.size());
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,75 @@
+#include "Output/OscWriter.h"
+
+#include <cstring>
+
+OscWriter::OscWriter(char* buffer, size_t capacity) : m_buffer(buffer), m_capacity(capacity) {}
+
+void OscWriter::Reset() {
+  m_size = 0;
+  m_overflowed = false;
+  m_inBundle = false;
+}
+
+void OscWriter::BeginBundle(uint64_t timeTag) {
+  WritePadded("#bundle");
+  WriteBigEndian(static_cast<uint32_t>(timeTag >> 32));
+  WriteBigEndian(static_cast<uint32_t>(timeTag));
+  m_inBundle = true;
+}
+
+void OscWriter::BeginMessage(std::string_view address, std::string_view typeTags) {
+  if (m_inBundle) {
+    m_elementStart = m_size;
+    WriteBigEndian(0);
+  }
+
+  WritePadded(address);
+
+  // ',' and the tags are written as one padded string
+  const size_t tagsStart = m_size;
+  Write(",", 1);
+  Write(typeTags.data(), typeTags.size());
+  const size_t padding = 4 - (m_size - tagsStart) % 4;
+  Write("\0\0\0\0", padding);
+}
+
+void OscWriter::AddInt(int32_t value) { WriteBigEndian(static_cast<uint32_t>(value)); }
+
+void OscWriter::AddFloat(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  WriteBigEndian(bits);
+}
+
+void OscWriter::AddString(std::string_view value) { WritePadded(value); }
+
+void OscWriter::EndMessage() {
+  if (!m_inBundle || m_overflowed) return;
+
+  const uint32_t elementSize = static_cast<uint32_t>(m_size - m_elementStart - 4);
+  const size_t end = m_size;
+  m_size = m_elementStart;
+  WriteBigEndian(elementSize);
+  m_size = end;
+}
+
+void OscWriter::Write(const void* data, size_t size) {
+  if (m_overflowed || size > m_capacity - m_size) {
+    m_overflowed = true;
+    return;
+  }
+
+  std::memcpy(m_buffer + m_size, data, size);
+  m_size += size;
+}
+
+void OscWriter::WriteBigEndian(uint32_t value) {
+  const char bytes[4] = {static_cast<char>(value >> 24), static_cast<char>(value >> 16),
+                         static_cast<char>(value >> 8), static_cast<char>(value)};
+  Write(bytes, sizeof(bytes));
+}
+
+void OscWriter::WritePadded(std::string_view value) {
+  Write(value.data(), value.size());
+  Write("\0\0\0\0", 4 - value.size() % 4);
+}
@@ -0,0 +1,135 @@
+#include "Plugin/PluginRegistry.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include "DriverLog.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static const char* c_libraryExtension = ".dll";
+
+static void* OpenLibrary(const std::string& path) { return LoadLibraryA(path.c_str()); }
+static void* FindSymbol(void* library, const char* name) {
+  return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library), name));
+}
+static void CloseLibrary(void* library) { FreeLibrary(static_cast<HMODULE>(library)); }
+#else
+#include <dlfcn.h>
+
+static const char* c_libraryExtension = ".so";
+
+static void* OpenLibrary(const std::string& path) { return dlopen(path.c_str(), RTLD_NOW); }
+static void* FindSymbol(void* library, const char* name) { return dlsym(library, name); }
+static void CloseLibrary(void* library) { dlclose(library); }
+#endif
+
+// the smallest struct sizes version 1 of the ABI had, anything shorter is not a plugin of ours
+static constexpr uint32_t c_minPluginSize = sizeof(OpenglovePlugin);
+static constexpr uint32_t c_minCodecSize = sizeof(OpengloveCodecApi);
+static constexpr uint32_t c_minTransportSize = sizeof(OpengloveTransportApi);
+
+static bool IsValid(const OpengloveCodecApi* codec) {
+  return codec != nullptr && codec->structSize >= c_minCodecSize && codec->name != nullptr &&
+         codec->Create != nullptr && codec->Destroy != nullptr && codec->Decode != nullptr;
+}
+
+static bool IsValid(const OpengloveTransportApi* transport) {
+  return transport != nullptr && transport->structSize >= c_minTransportSize &&
+         transport->name != nullptr && transport->Open != nullptr && transport->Close != nullptr &&
+         transport->Read != nullptr;
+}
+
+PluginRegistry::~PluginRegistry() {
+  for (void* library : m_libraries) CloseLibrary(library);
+}
+
+int PluginRegistry::LoadDirectory(const std::string& directory) {
+  std::error_code ec;
+  std::filesystem::directory_iterator it(directory, ec);
+  if (ec) {
+    DriverLog("Could not open plugin directory %s: %s", directory.c_str(), ec.message().c_str());
+    return 0;
+  }
+
+  // sorted, so which of two plugins claiming the same name wins does not depend on the file system
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : it) {
+    if (entry.is_regular_file(ec) && entry.path().extension() == c_libraryExtension) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+
+  int loaded = 0;
+  for (const auto& path : paths) loaded += Load(path.string()) ? 1 : 0;
+  return loaded;
+}
+
+bool PluginRegistry::Load(const std::string& path) {
+  void* library = OpenLibrary(path);
+  if (library == nullptr) {
+    DriverLog("Could not load plugin %s", path.c_str());
+    return false;
+  }
+
+  const auto entry =
+      reinterpret_cast<OpenglovePluginEntryFn>(FindSymbol(library, OPENGLOVE_PLUGIN_ENTRY_NAME));
+  const OpenglovePlugin* plugin = entry != nullptr ? entry() : nullptr;
+
+  if (plugin == nullptr || plugin->structSize < c_minPluginSize) {
+    DriverLog("%s does not export %s, not loading it", path.c_str(), OPENGLOVE_PLUGIN_ENTRY_NAME);
+    CloseLibrary(library);
+    return false;
+  }
+  if (plugin->abiVersion != OPENGLOVE_PLUGIN_ABI_VERSION) {
+    DriverLog("Plugin %s was built for ABI version %u, the driver has version %u. Not loading it",
+              path.c_str(), plugin->abiVersion, OPENGLOVE_PLUGIN_ABI_VERSION);
+    CloseLibrary(library);
+    return false;
+  }
+
+  // checked as a whole, so a plugin is either fully available or not at all
+  for (uint32_t i = 0; i < plugin->codecCount; i++) {
+    const OpengloveCodecApi* codec = plugin->codecs[i];
+    if (!IsValid(codec) || FindCodec(codec->name) != nullptr) {
+      DriverLog("Plugin %s has an invalid or duplicate codec, not loading it", path.c_str());
+      CloseLibrary(library);
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < plugin->transportCount; i++) {
+    const OpengloveTransportApi* transport = plugin->transports[i];
+    if (!IsValid(transport) || FindTransport(transport->name) != nullptr) {
+      DriverLog("Plugin %s has an invalid or duplicate transport, not loading it", path.c_str());
+      CloseLibrary(library);
+      return false;
+    }
+  }
+
+  m_libraries.push_back(library);
+  m_codecs.insert(m_codecs.end(), plugin->codecs, plugin->codecs + plugin->codecCount);
+  m_transports.insert(m_transports.end(), plugin->transports,
+                      plugin->transports + plugin->transportCount);
+
+  DriverLog("Loaded plugin %s from %s: %u codecs, %u transports",
+            plugin->name != nullptr ? plugin->name : "(unnamed)", path.c_str(), plugin->codecCount,
+            plugin->transportCount);
+  return true;
+}
+
+const OpengloveCodecApi* PluginRegistry::FindCodec(std::string_view name) const {
+  for (const OpengloveCodecApi* codec : m_codecs) {
+    if (name == codec->name) return codec;
+  }
+  return nullptr;
+}
+
+const OpengloveTransportApi* PluginRegistry::FindTransport(std::string_view name) const {
+  for (const OpengloveTransportApi* transport : m_transports) {
+    if (name == transport->name) return transport;
+  }
+  return nullptr;
+}
@@ -0,0 +1,126 @@
+#include "PoseBridge.h"
+
+#include <cmath>
+
+#include "Quaternion.h"
+
+namespace {
+// splits a unit quaternion into an axis and an angle in [0, pi]
+void ToAxisAngle(vr::HmdQuaternion_t q, double axis[3], double& angle) {
+  if (q.w < 0) q = {-q.w, -q.x, -q.y, -q.z};
+
+  const double sinHalf = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+  angle = 2.0 * std::atan2(sinHalf, q.w);
+
+  if (sinHalf < 1e-9) {
+    axis[0] = 1;
+    axis[1] = axis[2] = 0;
+    angle = 0;
+    return;
+  }
+
+  axis[0] = q.x / sinHalf;
+  axis[1] = q.y / sinHalf;
+  axis[2] = q.z / sinHalf;
+}
+}  // namespace
+
+PoseBridge::PoseBridge(DriverDuration window, DriverDuration blend)
+    : m_window(window), m_blend(blend) {}
+
+vr::DriverPose_t PoseBridge::OnTracked(const vr::DriverPose_t& pose, DriverTimePoint now) {
+  if (m_bridging) {
+    m_bridging = false;
+
+    if (m_blend.count() > 0) {
+      for (int i = 0; i < 3; i++)
+        m_blendPosition[i] = m_lastPose.vecPosition[i] - pose.vecPosition[i];
+
+      ToAxisAngle(MultiplyQuaternion(m_lastPose.qRotation, QuatConjugate(pose.qRotation)),
+                  m_blendAxis, m_blendAngle);
+
+      m_blendStart = now;
+      m_blending = true;
+    }
+  }
+
+  vr::DriverPose_t result = pose;
+
+  if (m_blending) {
+    const double progress = ToSeconds(now - m_blendStart) / ToSeconds(m_blend);
+
+    if (progress >= 1.0) {
+      m_blending = false;
+    } else {
+      // ease out so the correction is gentle at both ends
+      const double remaining = 1.0 - progress * progress * (3.0 - 2.0 * progress);
+
+      for (int i = 0; i < 3; i++) result.vecPosition[i] += m_blendPosition[i] * remaining;
+
+      result.qRotation = MultiplyQuaternion(
+          QuaternionFromAngle(m_blendAxis[0], m_blendAxis[1], m_blendAxis[2],
+                              m_blendAngle * remaining),
+          pose.qRotation);
+    }
+  }
+
+  m_lastPose = result;
+  m_lastTrackedAt = now;
+  m_hasPose = true;
+
+  return result;
+}
+
+vr::DriverPose_t PoseBridge::OnLost(const vr::DriverPose_t& invalidPose, DriverTimePoint now) {
+  if (!m_hasPose || m_window.count() <= 0) return invalidPose;
+
+  if (!m_bridging) {
+    // start from whatever was last shown, which may have been partway through a blend
+    m_anchor = m_lastPose;
+    m_lostAt = m_lastTrackedAt;
+    m_bridging = true;
+    m_blending = false;
+  }
+
+  if (now - m_lostAt >= m_window) {
+    // stayed lost too long to guess, hand out the invalid pose and snap back when tracking returns
+    m_hasPose = false;
+    m_bridging = false;
+    return invalidPose;
+  }
+
+  const double window = ToSeconds(m_window);
+  const double elapsed = ToSeconds(now - m_lostAt);
+
+  // velocities fall off linearly to zero at the end of the window, this is their integral
+  const double travel = elapsed - elapsed * elapsed / (2.0 * window);
+  const double velocityScale = 1.0 - elapsed / window;
+
+  vr::DriverPose_t result = m_anchor;
+
+  for (int i = 0; i < 3; i++) {
+    result.vecPosition[i] = m_anchor.vecPosition[i] + m_anchor.vecVelocity[i] * travel;
+    result.vecVelocity[i] = m_anchor.vecVelocity[i] * velocityScale;
+    result.vecAngularVelocity[i] = m_anchor.vecAngularVelocity[i] * velocityScale;
+  }
+
+  const double* omega = m_anchor.vecAngularVelocity;
+  const double angularSpeed =
+      std::sqrt(omega[0] * omega[0] + omega[1] * omega[1] + omega[2] * omega[2]);
+
+  if (angularSpeed > 1e-6) {
+    // angular velocity is in world space, so the increment is applied on the left
+    result.qRotation =
+        MultiplyQuaternion(QuaternionFromAngle(omega[0] / angularSpeed, omega[1] / angularSpeed,
+                                               omega[2] / angularSpeed, angularSpeed * travel),
+                           m_anchor.qRotation);
+  }
+
+  result.poseIsValid = true;
+  result.deviceIsConnected = invalidPose.deviceIsConnected;
+  result.result = vr::TrackingResult_Fallback_RotationOnly;
+
+  m_lastPose = result;
+
+  return result;
+}
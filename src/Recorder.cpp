@@ -0,0 +1,168 @@
+#include "Recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "DriverLog.h"
+
+// the writer empties the ring every c_writerInterval. A little over a kilobyte each for frames
+static const size_t c_ringEntries = 256;
+static const DriverDuration c_writerInterval = std::chrono::milliseconds(10);
+
+static const size_t c_maxFileNameLength = 128;
+
+bool IsPlainFileName(std::string_view name) {
+  // Windows drops trailing dots, and a leading one covers "." and ".."
+  if (name.empty() || name.size() > c_maxFileNameLength || name.front() == '.' ||
+      name.back() == '.')
+    return false;
+
+  // no separators, drive letters or stream names, whatever the platform
+  const bool plain = std::all_of(name.begin(), name.end(), [](char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '.' || c == '-' || c == '_';
+  });
+  if (!plain) return false;
+
+  // Windows opens a device instead of a file for these, with any extension
+  std::string stem(name.substr(0, name.find('.')));
+  std::transform(stem.begin(), stem.end(), stem.begin(),
+                 [](char c) { return static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c); });
+  if (stem == "CON" || stem == "PRN" || stem == "AUX" || stem == "NUL") return false;
+  if (stem.size() == 4 && (stem.compare(0, 3, "COM") == 0 || stem.compare(0, 3, "LPT") == 0) &&
+      stem[3] >= '0' && stem[3] <= '9')
+    return false;
+
+  return true;
+}
+
+Recorder::Recorder(std::string directory, RecorderContent content)
+    : m_directory(std::move(directory)),
+      m_recording(false),
+      m_file(nullptr),
+      m_written(0),
+      m_dropped(0) {
+  if (content == RecorderContent_Frames)
+    m_frames = std::make_unique<SpscRing<FrameEntry>>(c_ringEntries);
+  else
+    m_samples = std::make_unique<SpscRing<SampleEntry>>(c_ringEntries);
+}
+
+Recorder::~Recorder() { Stop(); }
+
+bool Recorder::Start(std::string_view fileName) {
+  if (m_writerThread.joinable() || !IsPlainFileName(fileName)) return false;
+
+  std::error_code error;
+  std::filesystem::create_directories(m_directory, error);
+
+  const std::filesystem::path path = std::filesystem::path(m_directory) / fileName;
+  m_file = std::fopen(path.string().c_str(), "w");
+  if (m_file == nullptr) {
+    DriverLog("Could not open %s for recording", path.string().c_str());
+    return false;
+  }
+
+  // a producer that saw the last session still recording can have pushed after its final pass.
+  // Nothing else pops while the writer is stopped
+  FrameEntry frame;
+  SampleEntry sample;
+  while (m_frames && m_frames->TryPop(frame)) {
+  }
+  while (m_samples && m_samples->TryPop(sample)) {
+  }
+
+  m_written = 0;
+  m_dropped = 0;
+  m_recording = true;
+  m_stop.Reset();
+  m_writerThread = std::thread(&Recorder::WriterThread, this);
+
+  return true;
+}
+
+void Recorder::Stop() {
+  if (!m_writerThread.joinable()) return;
+
+  m_recording = false;
+  m_stop.Set();
+  m_writerThread.join();
+
+  std::fclose(m_file);
+  m_file = nullptr;
+}
+
+void Recorder::RecordFrame(std::string_view frame) {
+  if (!m_frames || !IsRecording()) return;
+
+  // frames keep their terminator on the way in, the writer adds its own
+  if (!frame.empty() && frame.back() == '\n') frame.remove_suffix(1);
+
+  FrameEntry entry;
+  entry.timeNs = DriverClock().Now().time_since_epoch().count();
+  entry.length = static_cast<uint16_t>(std::min(frame.size(), c_maxFrameSize));
+  std::memcpy(entry.bytes, frame.data(), entry.length);
+
+  if (!m_frames->TryPush(entry)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Recorder::RecordSample(const PackedSample& sample) {
+  if (!m_samples || !IsRecording()) return;
+
+  const SampleEntry entry = {DriverClock().Now().time_since_epoch().count(), sample};
+  if (!m_samples->TryPush(entry)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Recorder::WriterThread() {
+  bool recording = true;
+
+  while (recording) {
+    // read the flag first so everything pushed before Stop() is drained on the last pass
+    recording = m_recording;
+
+    if (WriteQueued()) std::fflush(m_file);
+
+    if (recording) DriverClock().SleepFor(c_writerInterval, m_stop);
+  }
+}
+
+bool Recorder::WriteQueued() {
+  bool wrote = false;
+  if (m_frames) {
+    FrameEntry entry;
+    while (m_frames->TryPop(entry)) {
+      WriteFrame(entry);
+      wrote = true;
+    }
+  } else {
+    SampleEntry entry;
+    while (m_samples->TryPop(entry)) {
+      WriteSample(entry);
+      wrote = true;
+    }
+  }
+  return wrote;
+}
+
+void Recorder::WriteFrame(const FrameEntry& entry) {
+  const long long timeUs = entry.timeNs / 1000;
+  std::fprintf(m_file, "%lld %.*s\n", timeUs, static_cast<int>(entry.length), entry.bytes);
+  m_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Recorder::WriteSample(const SampleEntry& entry) {
+  const long long timeUs = entry.timeNs / 1000;
+  const PackedSample& packed = entry.sample;
+  const VRCommData_t s = UnpackSample(packed);
+
+  std::fprintf(m_file,
+               "%lld,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,"
+               "%d,%d,%d,%d,%d,%d,%d\n",
+               timeUs, packed.sequence, s.flexion[0], s.flexion[1], s.flexion[2], s.flexion[3], s.flexion[4],
+               s.splay[0], s.splay[1], s.splay[2], s.splay[3], s.splay[4], s.joyX, s.joyY,
+               s.joyButton, s.trgButton, s.aButton, s.bButton, s.grab, s.pinch, s.calibrate);
+  m_written.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,128 @@
+#include "SampleHistory.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Readers that keep getting lapped by the writer give up rather than spin forever.
+static constexpr int c_maxReadAttempts = 4;
+
+SampleHistory::SampleHistory(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity) size <<= 1;
+
+  m_slots = std::make_unique<Slot[]>(size);
+  m_mask = size - 1;
+}
+
+void SampleHistory::Append(const PackedSample& sample) {
+  OPENGLOVE_EXCLUSIVE(m_appending, "SampleHistory appended to from two threads at once");
+
+  const uint64_t index = m_count.load(std::memory_order_relaxed);
+  Slot& slot = m_slots[index & m_mask];
+  OPENGLOVE_CHECK(index == 0 || sample.timeNs >= m_lastTimeNs,
+                  "SampleHistory appended out of time order");
+#if defined(OPENGLOVE_CHECK_CONCURRENCY)
+  m_lastTimeNs = sample.timeNs;
+#endif
+
+  slot.stamp.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  CopyShared(&slot.sample, &sample, sizeof(PackedSample));
+
+  slot.stamp.store(2 * index + 2, std::memory_order_release);
+  m_count.store(index + 1, std::memory_order_release);
+}
+
+bool SampleHistory::Read(uint64_t index, PackedSample& sample) const {
+  const Slot& slot = m_slots[index & m_mask];
+  const uint64_t expected = 2 * index + 2;
+
+  if (slot.stamp.load(std::memory_order_acquire) != expected) return false;
+  CopyShared(&sample, &slot.sample, sizeof(PackedSample));
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  return slot.stamp.load(std::memory_order_relaxed) == expected;
+}
+
+bool SampleHistory::Latest(PackedSample& sample) const {
+  for (int attempt = 0; attempt < c_maxReadAttempts; attempt++) {
+    const uint64_t count = m_count.load(std::memory_order_acquire);
+    if (count == 0) return false;
+    if (Read(count - 1, sample)) return true;
+  }
+  return false;
+}
+
+int64_t SampleHistory::FindAtOrBefore(int64_t timeNs, uint64_t oldest, uint64_t newest) const {
+  PackedSample probe;
+  if (!Read(oldest, probe)) return -2;
+  if (probe.timeNs > timeNs) return -1;
+
+  // invariant: oldest is at or before timeNs
+  uint64_t low = oldest;
+  uint64_t high = newest + 1;
+  while (high - low > 1) {
+    const uint64_t middle = low + (high - low) / 2;
+    if (!Read(middle, probe)) return -2;
+
+    if (probe.timeNs <= timeNs)
+      low = middle;
+    else
+      high = middle;
+  }
+  return static_cast<int64_t>(low);
+}
+
+bool SampleHistory::ValueAt(int64_t timeNs, VRCommData_t& value) const {
+  for (int attempt = 0; attempt < c_maxReadAttempts; attempt++) {
+    const uint64_t count = m_count.load(std::memory_order_acquire);
+    if (count == 0) return false;
+
+    // keep one slot clear of the writer so the oldest sample survives the search
+    const uint64_t newest = count - 1;
+    const uint64_t oldest = count > m_mask ? count - m_mask : 0;
+
+    const int64_t found = FindAtOrBefore(timeNs, oldest, newest);
+    if (found == -1) return false;
+    if (found == -2) continue;
+
+    PackedSample before;
+    if (!Read(static_cast<uint64_t>(found), before)) continue;
+    if (static_cast<uint64_t>(found) == newest) {
+      value = UnpackSample(before);
+      return true;
+    }
+
+    PackedSample after;
+    if (!Read(static_cast<uint64_t>(found) + 1, after)) continue;
+
+    value = UnpackSample(before);
+    const VRCommData_t next = UnpackSample(after);
+    const int64_t span = after.timeNs - before.timeNs;
+    const float t = span > 0 ? static_cast<float>(timeNs - before.timeNs) / span : 0.f;
+
+    for (size_t i = 0; i < value.flexion.size(); i++) {
+      value.flexion[i] += (next.flexion[i] - value.flexion[i]) * t;
+      value.splay[i] += (next.splay[i] - value.splay[i]) * t;
+    }
+    value.joyX += (next.joyX - value.joyX) * t;
+    value.joyY += (next.joyY - value.joyY) * t;
+    return true;
+  }
+  return false;
+}
+
+size_t SampleHistory::CopyRecent(PackedSample* samples, size_t maxCount) const {
+  for (int attempt = 0; attempt < c_maxReadAttempts; attempt++) {
+    const uint64_t count = m_count.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(count, m_mask);
+    const size_t copied = static_cast<size_t>(std::min<uint64_t>(available, maxCount));
+
+    bool torn = false;
+    for (size_t i = 0; i < copied && !torn; i++) torn = !Read(count - copied + i, samples[i]);
+
+    if (!torn) return copied;
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include "SignalGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// SimdKernels::signalLanes is indexed by these bits
+static_assert(c_signalLaneStages == 0xf);
+
+namespace {
+template <uint32_t Stages>
+void RunStages(const SignalGraphParameters& parameters, SignalGraphState& state,
+               VRCommData_t& data) {
+  alignas(32) std::array<float, c_signalLanes> block{};
+  std::copy(data.flexion.begin(), data.flexion.end(), block.begin());
+
+  // the first packet seeds the filter instead of being pulled towards zero
+  const float smoothing = state.primed ? parameters.smoothing : 0.f;
+
+  if constexpr ((Stages & c_signalLaneStages) != 0)
+    parameters.laneKernel(parameters.lanes, parameters.curveTable.data(), smoothing,
+                          state.filtered.data(), block.data());
+  if constexpr ((Stages & SignalStage_Filter) != 0) state.primed = true;
+
+  std::copy(block.begin(), block.begin() + data.flexion.size(), data.flexion.begin());
+
+  if constexpr ((Stages & SignalStage_Gesture) != 0) {
+    // a button the glove sends itself always wins
+    // lanes are thumb, index, middle, ring, pinky, the order the drivers use
+    data.grab = data.grab || (block[2] + block[3] + block[4]) / 3.f >= parameters.grabThreshold;
+    data.pinch = data.pinch || std::min(block[0], block[1]) >= parameters.pinchThreshold;
+  }
+
+  if constexpr ((Stages & SignalStage_JoystickDeadzone) != 0) {
+    // radial, so the direction is kept and only the length is remapped. Both axes can read full
+    // scale at once on the diagonal, the remapped length is capped at 1 like a round gate would.
+    const float magnitude = std::hypot(data.joyX, data.joyY);
+    const float scale = magnitude <= parameters.joystickDeadzone
+                            ? 0.f
+                            : std::min((magnitude - parameters.joystickDeadzone) /
+                                           (1.f - parameters.joystickDeadzone),
+                                       1.f) /
+                                  magnitude;
+
+    data.joyX *= scale;
+    data.joyY *= scale;
+  }
+}
+
+template <size_t... StageSets>
+constexpr auto MakeKernelTable(std::index_sequence<StageSets...>) {
+  return std::array<void (*)(const SignalGraphParameters&, SignalGraphState&, VRCommData_t&),
+                    sizeof...(StageSets)>{&RunStages<static_cast<uint32_t>(StageSets)>...};
+}
+
+// one kernel for every combination of stages
+constexpr auto c_kernels = MakeKernelTable(std::make_index_sequence<1 << c_signalStageCount>());
+}  // namespace
+
+SignalGraph::SignalGraph() { Compile(VRInputTuning_t()); }
+
+void SignalGraph::Compile(const VRInputTuning_t& tuning) {
+  uint32_t stages = 0;
+
+  if (tuning.flexionMin != 0.f || tuning.flexionMax != 1.f) {
+    stages |= SignalStage_RangeMap;
+    m_parameters.lanes.rangeMin = tuning.flexionMin;
+    m_parameters.lanes.rangeScale = 1.f / std::max(tuning.flexionMax - tuning.flexionMin, 0.01f);
+  }
+
+  if (tuning.smoothing > 0.f) {
+    stages |= SignalStage_Filter;
+    m_parameters.smoothing = tuning.smoothing;
+  }
+
+  if (tuning.flexionDeadzone > 0.f) {
+    stages |= SignalStage_Deadband;
+    m_parameters.lanes.deadband = tuning.flexionDeadzone;
+    m_parameters.lanes.deadbandScale = 1.f / (1.f - tuning.flexionDeadzone);
+  }
+
+  if (tuning.flexionCurve != 1.f) {
+    stages |= SignalStage_Curve;
+    for (size_t i = 0; i <= c_curveTableSize; i++)
+      m_parameters.curveTable[i] =
+          std::pow(static_cast<float>(i) / c_curveTableSize, tuning.flexionCurve);
+  }
+
+  if (tuning.grabThreshold > 0.f || tuning.pinchThreshold > 0.f) {
+    stages |= SignalStage_Gesture;
+    // a threshold of 0 turns that gesture off, flexion never gets past 2
+    m_parameters.grabThreshold = tuning.grabThreshold > 0.f ? tuning.grabThreshold : 2.f;
+    m_parameters.pinchThreshold = tuning.pinchThreshold > 0.f ? tuning.pinchThreshold : 2.f;
+  }
+
+  if (tuning.joystickDeadzone > 0.f) {
+    stages |= SignalStage_JoystickDeadzone;
+    m_parameters.joystickDeadzone = tuning.joystickDeadzone;
+  }
+
+  m_configured = stages;
+  Select();
+}
+
+void SignalGraph::SetBypass(uint32_t stages) {
+  m_bypass = stages;
+  Select();
+}
+
+void SignalGraph::Select() {
+  const uint32_t stages = m_configured & ~m_bypass;
+  // the history is stale if the filter wasn't running
+  if ((stages & SignalStage_Filter) != 0 && (m_stages & SignalStage_Filter) == 0)
+    m_state.primed = false;
+
+  m_stages = stages;
+  m_kernel = c_kernels[stages];
+  m_parameters.laneKernel = Simd().signalLanes[stages & c_signalLaneStages];
+}
@@ -0,0 +1,178 @@
+#include "Simd/SimdKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#if defined(OPENGLOVE_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// The scalar reference, which every other variant has to match.
+namespace {
+void BlendBones(const float* open, const float* fist, const float* weights, float* out,
+                size_t count) {
+  for (size_t bone = 0; bone < count; bone++) {
+    const float weight = weights[bone];
+    for (size_t i = bone * 8; i < bone * 8 + 8; i++)
+      out[i] = open[i] + weight * (fist[i] - open[i]);
+  }
+}
+
+void Blend4(const float* a, const float* b, const float* c, const float* d, const float* weights,
+            float* out, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    out[i] = weights[0] * a[i] + weights[1] * b[i] + weights[2] * c[i] + weights[3] * d[i];
+}
+
+// bit values of SignalStage, which this file does not include
+constexpr uint32_t c_rangeMap = 1 << 0;
+constexpr uint32_t c_filter = 1 << 1;
+constexpr uint32_t c_deadband = 1 << 2;
+constexpr uint32_t c_curve = 1 << 3;
+
+template <uint32_t Stages>
+void SignalLanes(const SignalLaneParameters& parameters, const float* curveTable, float smoothing,
+                 float* filtered, float* lanes) {
+  for (size_t i = 0; i < c_signalLaneCount; i++) {
+    float value = lanes[i];
+
+    if constexpr ((Stages & c_rangeMap) != 0)
+      value = std::clamp((value - parameters.rangeMin) * parameters.rangeScale, 0.f, 1.f);
+
+    if constexpr ((Stages & c_filter) != 0) {
+      value += (filtered[i] - value) * smoothing;
+      filtered[i] = value;
+    }
+
+    if constexpr ((Stages & c_deadband) != 0)
+      value = std::max(0.f, (value - parameters.deadband) * parameters.deadbandScale);
+
+    if constexpr ((Stages & c_curve) != 0) {
+      const float position = std::clamp(value, 0.f, 1.f) * c_signalCurveTableSize;
+      const size_t index = std::min(static_cast<size_t>(position), c_signalCurveTableSize - 1);
+      const float fraction = position - static_cast<float>(index);
+      value = curveTable[index] + (curveTable[index + 1] - curveTable[index]) * fraction;
+    }
+
+    lanes[i] = value;
+  }
+}
+
+template <size_t... StageSets>
+constexpr SimdKernels MakeScalarKernels(std::index_sequence<StageSets...>) {
+  return {SimdIsa_Scalar, &BlendBones, &Blend4,
+          {&SignalLanes<static_cast<uint32_t>(StageSets)>...}};
+}
+
+constexpr SimdKernels c_scalarKernels = MakeScalarKernels(std::make_index_sequence<16>());
+
+constexpr const char* c_isaNames[c_simdIsaCount] = {"scalar", "sse4.1", "avx2", "avx512"};
+
+// what Simd() hands out, the scalar table until something is bound
+SimdKernels s_boundKernels;
+std::atomic<const SimdKernels*> s_kernels{&c_scalarKernels};
+
+#if defined(OPENGLOVE_SIMD_X86)
+struct CpuidRegisters {
+  uint32_t eax, ebx, ecx, edx;
+};
+
+CpuidRegisters Cpuid(uint32_t leaf, uint32_t subleaf) {
+  CpuidRegisters registers{};
+#if defined(_MSC_VER)
+  int values[4];
+  __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+  registers = {static_cast<uint32_t>(values[0]), static_cast<uint32_t>(values[1]),
+               static_cast<uint32_t>(values[2]), static_cast<uint32_t>(values[3])};
+#else
+  __cpuid_count(leaf, subleaf, registers.eax, registers.ebx, registers.ecx, registers.edx);
+#endif
+  return registers;
+}
+
+// register state the OS saves on a context switch, only valid with OSXSAVE
+uint64_t EnabledXsaveState() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t low, high;
+  __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+#endif
+}  // namespace
+
+const char* SimdIsaName(SimdIsa isa) {
+  return isa < c_simdIsaCount ? c_isaNames[isa] : "unknown";
+}
+
+bool SimdIsaFromName(std::string_view name, SimdIsa& isa) {
+  for (uint32_t i = 0; i < c_simdIsaCount; i++) {
+    if (name == c_isaNames[i]) {
+      isa = static_cast<SimdIsa>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+SimdIsa DetectSimdIsa() {
+#if defined(OPENGLOVE_SIMD_X86)
+  const uint32_t maxLeaf = Cpuid(0, 0).eax;
+  if (maxLeaf < 1) return SimdIsa_Scalar;
+
+  const CpuidRegisters features = Cpuid(1, 0);
+  if ((features.ecx & (1u << 19)) == 0) return SimdIsa_Scalar;
+
+  // AVX needs the OS to save the wider registers as well as the CPU to have them
+  const bool osxsave = (features.ecx & (1u << 27)) != 0;
+  const bool avx = (features.ecx & (1u << 28)) != 0;
+  if (!osxsave || !avx || maxLeaf < 7) return SimdIsa_Sse41;
+
+  const uint64_t xsaveState = EnabledXsaveState();
+  const CpuidRegisters extended = Cpuid(7, 0);
+  // SSE and AVX state, then the opmask and both halves of the upper ZMM state on top
+  const bool ymmState = (xsaveState & 0x06) == 0x06;
+  const bool zmmState = (xsaveState & 0xe6) == 0xe6;
+  const bool avx2 = (extended.ebx & (1u << 5)) != 0;
+  const bool avx512f = (extended.ebx & (1u << 16)) != 0;
+
+  if (!ymmState || !avx2) return SimdIsa_Sse41;
+  if (!zmmState || !avx512f) return SimdIsa_Avx2;
+  return SimdIsa_Avx512;
+#else
+  return SimdIsa_Scalar;
+#endif
+}
+
+SimdKernels SimdKernelsFor(SimdIsa isa) {
+  SimdKernels kernels = c_scalarKernels;
+
+  const SimdKernels* const variants[] = {SimdKernelsSse41(), SimdKernelsAvx2(),
+                                         SimdKernelsAvx512()};
+  for (const SimdKernels* variant : variants) {
+    if (variant == nullptr || variant->isa > isa) continue;
+
+    kernels.isa = variant->isa;
+    if (variant->blendBones != nullptr) kernels.blendBones = variant->blendBones;
+    if (variant->blend4 != nullptr) kernels.blend4 = variant->blend4;
+    for (size_t i = 0; i < std::size(kernels.signalLanes); i++)
+      if (variant->signalLanes[i] != nullptr) kernels.signalLanes[i] = variant->signalLanes[i];
+  }
+
+  return kernels;
+}
+
+SimdIsa BindSimdKernels(SimdIsa limit) {
+  s_boundKernels = SimdKernelsFor(std::min(limit, DetectSimdIsa()));
+  s_kernels.store(&s_boundKernels, std::memory_order_release);
+  return s_boundKernels.isa;
+}
+
+const SimdKernels& Simd() { return *s_kernels.load(std::memory_order_acquire); }
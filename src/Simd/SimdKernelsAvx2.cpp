@@ -0,0 +1,115 @@
+#include "Simd/SimdKernels.h"
+
+// Built with AVX2 enabled, see the comment in SimdKernels.h about what may be called from here.
+#if defined(OPENGLOVE_SIMD_X86) && defined(__AVX2__)
+#include <immintrin.h>
+
+#include <utility>
+
+namespace {
+// a bone transform is exactly one register
+void BlendBones(const float* open, const float* fist, const float* weights, float* out,
+                size_t count) {
+  for (size_t bone = 0; bone < count; bone++) {
+    const __m256 weight = _mm256_set1_ps(weights[bone]);
+    const __m256 from = _mm256_loadu_ps(open + bone * 8);
+    const __m256 to = _mm256_loadu_ps(fist + bone * 8);
+    _mm256_storeu_ps(out + bone * 8,
+                     _mm256_add_ps(from, _mm256_mul_ps(weight, _mm256_sub_ps(to, from))));
+  }
+}
+
+void Blend4(const float* a, const float* b, const float* c, const float* d, const float* weights,
+            float* out, size_t count) {
+  const __m256 wa = _mm256_set1_ps(weights[0]);
+  const __m256 wb = _mm256_set1_ps(weights[1]);
+  const __m256 wc = _mm256_set1_ps(weights[2]);
+  const __m256 wd = _mm256_set1_ps(weights[3]);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 sum = _mm256_mul_ps(wa, _mm256_loadu_ps(a + i));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(wb, _mm256_loadu_ps(b + i)));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(wc, _mm256_loadu_ps(c + i)));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(wd, _mm256_loadu_ps(d + i)));
+    _mm256_storeu_ps(out + i, sum);
+  }
+  for (; i < count; i++)
+    out[i] = weights[0] * a[i] + weights[1] * b[i] + weights[2] * c[i] + weights[3] * d[i];
+}
+
+constexpr uint32_t c_rangeMap = 1 << 0;
+constexpr uint32_t c_filter = 1 << 1;
+constexpr uint32_t c_deadband = 1 << 2;
+constexpr uint32_t c_curve = 1 << 3;
+
+static_assert(c_signalLaneCount == 8, "the lanes are one register");
+
+// Operand order matches the scalar clamp and max, NaN included.
+template <uint32_t Stages>
+void SignalLanes(const SignalLaneParameters& parameters, const float* curveTable, float smoothing,
+                 float* filtered, float* lanes) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.f);
+  __m256 value = _mm256_loadu_ps(lanes);
+
+  if constexpr ((Stages & c_rangeMap) != 0) {
+    value = _mm256_mul_ps(_mm256_sub_ps(value, _mm256_set1_ps(parameters.rangeMin)),
+                          _mm256_set1_ps(parameters.rangeScale));
+    value = _mm256_max_ps(zero, _mm256_min_ps(one, value));
+  }
+
+  if constexpr ((Stages & c_filter) != 0) {
+    const __m256 history = _mm256_loadu_ps(filtered);
+    value = _mm256_add_ps(value,
+                          _mm256_mul_ps(_mm256_sub_ps(history, value), _mm256_set1_ps(smoothing)));
+    _mm256_storeu_ps(filtered, value);
+  }
+
+  if constexpr ((Stages & c_deadband) != 0) {
+    value = _mm256_mul_ps(_mm256_sub_ps(value, _mm256_set1_ps(parameters.deadband)),
+                          _mm256_set1_ps(parameters.deadbandScale));
+    value = _mm256_max_ps(value, zero);
+  }
+
+  if constexpr ((Stages & c_curve) != 0) {
+    const __m256 position =
+        _mm256_mul_ps(_mm256_max_ps(zero, _mm256_min_ps(one, value)),
+                      _mm256_set1_ps(static_cast<float>(c_signalCurveTableSize)));
+    // NaN truncates to INT_MIN, the lower bound keeps it inside the table
+    const __m256i index = _mm256_max_epi32(
+        _mm256_setzero_si256(),
+        _mm256_min_epi32(_mm256_cvttps_epi32(position),
+                         _mm256_set1_epi32(static_cast<int>(c_signalCurveTableSize - 1))));
+    const __m256 fraction = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+
+    // plain loads, a gather is slower than eight of them on CPUs with the gather data sampling fix
+    alignas(32) int32_t indices[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(indices), index);
+    const __m256 low = _mm256_set_ps(curveTable[indices[7]], curveTable[indices[6]],
+                                     curveTable[indices[5]], curveTable[indices[4]],
+                                     curveTable[indices[3]], curveTable[indices[2]],
+                                     curveTable[indices[1]], curveTable[indices[0]]);
+    const __m256 high = _mm256_set_ps(curveTable[indices[7] + 1], curveTable[indices[6] + 1],
+                                      curveTable[indices[5] + 1], curveTable[indices[4] + 1],
+                                      curveTable[indices[3] + 1], curveTable[indices[2] + 1],
+                                      curveTable[indices[1] + 1], curveTable[indices[0] + 1]);
+    value = _mm256_add_ps(low, _mm256_mul_ps(_mm256_sub_ps(high, low), fraction));
+  }
+
+  _mm256_storeu_ps(lanes, value);
+}
+
+template <size_t... StageSets>
+constexpr SimdKernels MakeKernels(std::index_sequence<StageSets...>) {
+  return {SimdIsa_Avx2, &BlendBones, &Blend4,
+          {&SignalLanes<static_cast<uint32_t>(StageSets)>...}};
+}
+
+constexpr SimdKernels c_kernels = MakeKernels(std::make_index_sequence<16>());
+}  // namespace
+
+const SimdKernels* SimdKernelsAvx2() { return &c_kernels; }
+#else
+const SimdKernels* SimdKernelsAvx2() { return nullptr; }
+#endif
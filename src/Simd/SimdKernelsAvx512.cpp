@@ -0,0 +1,56 @@
+#include "Simd/SimdKernels.h"
+
+// Built with AVX-512F enabled, see the comment in SimdKernels.h about what may be called from here.
+// The signal lanes fit one AVX2 register and are left to that variant.
+#if defined(OPENGLOVE_SIMD_X86) && defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace {
+// two bone transforms per register, the odd one out in the lower half
+void BlendBones(const float* open, const float* fist, const float* weights, float* out,
+                size_t count) {
+  size_t bone = 0;
+  for (; bone + 2 <= count; bone += 2) {
+    const __m512 weight = _mm512_mask_blend_ps(0xff00, _mm512_set1_ps(weights[bone]),
+                                               _mm512_set1_ps(weights[bone + 1]));
+    const __m512 from = _mm512_loadu_ps(open + bone * 8);
+    const __m512 to = _mm512_loadu_ps(fist + bone * 8);
+    _mm512_storeu_ps(out + bone * 8,
+                     _mm512_add_ps(from, _mm512_mul_ps(weight, _mm512_sub_ps(to, from))));
+  }
+  if (bone < count) {
+    const __mmask16 half = 0x00ff;
+    const __m512 weight = _mm512_set1_ps(weights[bone]);
+    const __m512 from = _mm512_maskz_loadu_ps(half, open + bone * 8);
+    const __m512 to = _mm512_maskz_loadu_ps(half, fist + bone * 8);
+    _mm512_mask_storeu_ps(out + bone * 8, half,
+                          _mm512_add_ps(from, _mm512_mul_ps(weight, _mm512_sub_ps(to, from))));
+  }
+}
+
+void Blend4(const float* a, const float* b, const float* c, const float* d, const float* weights,
+            float* out, size_t count) {
+  const __m512 wa = _mm512_set1_ps(weights[0]);
+  const __m512 wb = _mm512_set1_ps(weights[1]);
+  const __m512 wc = _mm512_set1_ps(weights[2]);
+  const __m512 wd = _mm512_set1_ps(weights[3]);
+
+  for (size_t i = 0; i < count; i += 16) {
+    // the tail is masked rather than run through a scalar loop
+    const __mmask16 mask =
+        count - i >= 16 ? __mmask16(0xffff) : static_cast<__mmask16>((1u << (count - i)) - 1);
+    __m512 sum = _mm512_mul_ps(wa, _mm512_maskz_loadu_ps(mask, a + i));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(wb, _mm512_maskz_loadu_ps(mask, b + i)));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(wc, _mm512_maskz_loadu_ps(mask, c + i)));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(wd, _mm512_maskz_loadu_ps(mask, d + i)));
+    _mm512_mask_storeu_ps(out + i, mask, sum);
+  }
+}
+
+constexpr SimdKernels c_kernels = {SimdIsa_Avx512, &BlendBones, &Blend4, {}};
+}  // namespace
+
+const SimdKernels* SimdKernelsAvx512() { return &c_kernels; }
+#else
+const SimdKernels* SimdKernelsAvx512() { return nullptr; }
+#endif
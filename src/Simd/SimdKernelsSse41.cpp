@@ -0,0 +1,109 @@
+#include "Simd/SimdKernels.h"
+
+// Built with SSE4.1 enabled, see the comment in SimdKernels.h about what may be called from here.
+#if defined(OPENGLOVE_SIMD_X86) && (defined(__SSE4_1__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+#include <utility>
+
+namespace {
+void BlendBones(const float* open, const float* fist, const float* weights, float* out,
+                size_t count) {
+  for (size_t bone = 0; bone < count; bone++) {
+    const __m128 weight = _mm_set1_ps(weights[bone]);
+    for (size_t i = bone * 8; i < bone * 8 + 8; i += 4) {
+      const __m128 from = _mm_loadu_ps(open + i);
+      const __m128 to = _mm_loadu_ps(fist + i);
+      _mm_storeu_ps(out + i, _mm_add_ps(from, _mm_mul_ps(weight, _mm_sub_ps(to, from))));
+    }
+  }
+}
+
+void Blend4(const float* a, const float* b, const float* c, const float* d, const float* weights,
+            float* out, size_t count) {
+  const __m128 wa = _mm_set1_ps(weights[0]);
+  const __m128 wb = _mm_set1_ps(weights[1]);
+  const __m128 wc = _mm_set1_ps(weights[2]);
+  const __m128 wd = _mm_set1_ps(weights[3]);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 sum = _mm_mul_ps(wa, _mm_loadu_ps(a + i));
+    sum = _mm_add_ps(sum, _mm_mul_ps(wb, _mm_loadu_ps(b + i)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(wc, _mm_loadu_ps(c + i)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(wd, _mm_loadu_ps(d + i)));
+    _mm_storeu_ps(out + i, sum);
+  }
+  for (; i < count; i++)
+    out[i] = weights[0] * a[i] + weights[1] * b[i] + weights[2] * c[i] + weights[3] * d[i];
+}
+
+constexpr uint32_t c_rangeMap = 1 << 0;
+constexpr uint32_t c_filter = 1 << 1;
+constexpr uint32_t c_deadband = 1 << 2;
+constexpr uint32_t c_curve = 1 << 3;
+
+// Operand order matches the scalar clamp and max, NaN included.
+template <uint32_t Stages>
+void SignalLanes(const SignalLaneParameters& parameters, const float* curveTable, float smoothing,
+                 float* filtered, float* lanes) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.f);
+
+  for (size_t i = 0; i < c_signalLaneCount; i += 4) {
+    __m128 value = _mm_loadu_ps(lanes + i);
+
+    if constexpr ((Stages & c_rangeMap) != 0) {
+      value = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(parameters.rangeMin)),
+                         _mm_set1_ps(parameters.rangeScale));
+      value = _mm_max_ps(zero, _mm_min_ps(one, value));
+    }
+
+    if constexpr ((Stages & c_filter) != 0) {
+      const __m128 history = _mm_loadu_ps(filtered + i);
+      value = _mm_add_ps(value, _mm_mul_ps(_mm_sub_ps(history, value), _mm_set1_ps(smoothing)));
+      _mm_storeu_ps(filtered + i, value);
+    }
+
+    if constexpr ((Stages & c_deadband) != 0) {
+      value = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(parameters.deadband)),
+                         _mm_set1_ps(parameters.deadbandScale));
+      value = _mm_max_ps(value, zero);
+    }
+
+    if constexpr ((Stages & c_curve) != 0) {
+      const __m128 position = _mm_mul_ps(_mm_max_ps(zero, _mm_min_ps(one, value)),
+                                         _mm_set1_ps(static_cast<float>(c_signalCurveTableSize)));
+      // NaN truncates to INT_MIN, the lower bound keeps it inside the table
+      const __m128i index = _mm_max_epi32(
+          _mm_setzero_si128(),
+          _mm_min_epi32(_mm_cvttps_epi32(position),
+                        _mm_set1_epi32(static_cast<int>(c_signalCurveTableSize - 1))));
+      const __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+
+      alignas(16) int32_t indices[4];
+      _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+      const __m128 low = _mm_set_ps(curveTable[indices[3]], curveTable[indices[2]],
+                                    curveTable[indices[1]], curveTable[indices[0]]);
+      const __m128 high = _mm_set_ps(curveTable[indices[3] + 1], curveTable[indices[2] + 1],
+                                     curveTable[indices[1] + 1], curveTable[indices[0] + 1]);
+      value = _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), fraction));
+    }
+
+    _mm_storeu_ps(lanes + i, value);
+  }
+}
+
+template <size_t... StageSets>
+constexpr SimdKernels MakeKernels(std::index_sequence<StageSets...>) {
+  return {SimdIsa_Sse41, &BlendBones, &Blend4,
+          {&SignalLanes<static_cast<uint32_t>(StageSets)>...}};
+}
+
+constexpr SimdKernels c_kernels = MakeKernels(std::make_index_sequence<16>());
+}  // namespace
+
+const SimdKernels* SimdKernelsSse41() { return &c_kernels; }
+#else
+const SimdKernels* SimdKernelsSse41() { return nullptr; }
+#endif
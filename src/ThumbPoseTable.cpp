@@ -0,0 +1,208 @@
+#include "ThumbPoseTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+#include "Bones.h"
+#include "Quaternion.h"
+#include "Simd/SimdKernels.h"
+
+// how far the metacarpal turns at either end of the opposition axis
+static const double c_oppositionDegrees = 35.0;
+static const double c_abductionDegrees = 20.0;
+
+// Evaluate blends a bone transform as eight floats, position then orientation
+static_assert(sizeof(vr::VRBoneTransform_t) == 8 * sizeof(float));
+
+static constexpr vr::BoneIndex_t c_thumbBones[ThumbPoseTable::c_boneCount] = {
+    eBone_Thumb0, eBone_Thumb1, eBone_Thumb2, eBone_Thumb3, eBone_Aux_Thumb};
+static_assert(eBone_Thumb3 - eBone_Thumb0 == 3);
+
+namespace {
+struct Vector {
+  double x, y, z;
+
+  Vector operator+(const Vector& o) const { return {x + o.x, y + o.y, z + o.z}; }
+  Vector operator-(const Vector& o) const { return {x - o.x, y - o.y, z - o.z}; }
+  Vector operator-() const { return {-x, -y, -z}; }
+  double Dot(const Vector& o) const { return x * o.x + y * o.y + z * o.z; }
+  Vector Cross(const Vector& o) const {
+    return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x};
+  }
+  Vector Normalized() const {
+    const double length = std::sqrt(Dot(*this));
+    return {x / length, y / length, z / length};
+  }
+};
+
+Vector Rotate(const vr::HmdQuaternion_t& q, const Vector& v) {
+  const vr::HmdQuaternion_t p =
+      MultiplyQuaternion(MultiplyQuaternion(q, {0, v.x, v.y, v.z}), QuatConjugate(q));
+  return {p.x, p.y, p.z};
+}
+
+// rotation then translation, child transforms compose on the right
+struct Rigid {
+  vr::HmdQuaternion_t rotation;
+  Vector position;
+
+  Rigid operator*(const Rigid& child) const {
+    return {MultiplyQuaternion(rotation, child.rotation),
+            position + Rotate(rotation, child.position)};
+  }
+  Rigid Inverse() const {
+    const vr::HmdQuaternion_t inverse = QuatConjugate(rotation);
+    return {inverse, -Rotate(inverse, position)};
+  }
+};
+
+Rigid FromBone(const vr::VRBoneTransform_t& bone) {
+  return {{bone.orientation.w, bone.orientation.x, bone.orientation.y, bone.orientation.z},
+          {bone.position.v[0], bone.position.v[1], bone.position.v[2]}};
+}
+
+void ToBone(const Rigid& rigid, vr::VRBoneTransform_t& bone) {
+  bone.orientation = {static_cast<float>(rigid.rotation.w), static_cast<float>(rigid.rotation.x),
+                      static_cast<float>(rigid.rotation.y), static_cast<float>(rigid.rotation.z)};
+  bone.position = {{static_cast<float>(rigid.position.x), static_cast<float>(rigid.position.y),
+                    static_cast<float>(rigid.position.z), 1.f}};
+}
+
+// transform of the last bone of the chain in root space, each bone the child of the one before.
+// Lerped poses are not unit quaternions, so they are normalised here to keep the result rigid.
+Rigid ModelTransform(const vr::VRBoneTransform_t* pose, std::initializer_list<int> chain) {
+  Rigid result = {{1, 0, 0, 0}, {0, 0, 0}};
+  for (int bone : chain) {
+    Rigid local = FromBone(pose[bone]);
+    const double norm = QuatNorm(local.rotation);
+    local.rotation = {local.rotation.w / norm, local.rotation.x / norm, local.rotation.y / norm,
+                      local.rotation.z / norm};
+    result = result * local;
+  }
+  return result;
+}
+
+Rigid ThumbTip(const vr::VRBoneTransform_t* pose) {
+  return ModelTransform(pose,
+                        {eBone_Wrist, eBone_Thumb0, eBone_Thumb1, eBone_Thumb2, eBone_Thumb3});
+}
+
+void TurnMetacarpal(vr::VRBoneTransform_t* pose, const Vector& axis, double angle) {
+  const Rigid metacarpal = FromBone(pose[eBone_Thumb0]);
+  const vr::HmdQuaternion_t turn = QuaternionFromAngle(axis.x, axis.y, axis.z, angle);
+  ToBone({MultiplyQuaternion(turn, metacarpal.rotation), metacarpal.position}, pose[eBone_Thumb0]);
+}
+
+// rootAxis in the wrist's frame, which is the metacarpal's parent, pointing the way that makes a
+// positive turn move the thumb tip towards direction. That keeps the two hands mirrored without
+// per-hand tables.
+Vector MetacarpalAxis(const vr::VRBoneTransform_t* pose, const Vector& rootAxis,
+                      const Vector& direction) {
+  const Vector axis = Rotate(QuatConjugate(FromBone(pose[eBone_Wrist]).rotation), rootAxis);
+
+  vr::VRBoneTransform_t turned[NUM_BONES];
+  std::copy(pose, pose + NUM_BONES, turned);
+  TurnMetacarpal(turned, axis, 0.1);
+
+  const Vector shift = ThumbTip(turned).position - ThumbTip(pose).position;
+  return shift.Dot(direction) >= 0 ? axis : -axis;
+}
+
+vr::VRBoneTransform_t LerpBone(const vr::VRBoneTransform_t& a, const vr::VRBoneTransform_t& b,
+                               float f) {
+  vr::VRBoneTransform_t result;
+  for (int i = 0; i < 4; i++) result.position.v[i] = Lerp(a.position.v[i], b.position.v[i], f);
+  result.orientation.w = Lerp(a.orientation.w, b.orientation.w, f);
+  result.orientation.x = Lerp(a.orientation.x, b.orientation.x, f);
+  result.orientation.y = Lerp(a.orientation.y, b.orientation.y, f);
+  result.orientation.z = Lerp(a.orientation.z, b.orientation.z, f);
+  return result;
+}
+}  // namespace
+
+ThumbPoseTable::ThumbPoseTable(const vr::VRBoneTransform_t* openPose,
+                               const vr::VRBoneTransform_t* fistPose) {
+  // palm frame from the open hand: along the fingers, across the knuckles and out of the palm on
+  // the side the fingers close towards
+  const Vector wrist = ModelTransform(openPose, {eBone_Wrist}).position;
+  const Vector indexKnuckle =
+      ModelTransform(openPose, {eBone_Wrist, eBone_IndexFinger0, eBone_IndexFinger1}).position;
+  const Vector pinkyKnuckle =
+      ModelTransform(openPose, {eBone_Wrist, eBone_PinkyFinger0, eBone_PinkyFinger1}).position;
+
+  const Vector alongFingers = (indexKnuckle - wrist).Normalized();
+  const Vector acrossKnuckles = (pinkyKnuckle - indexKnuckle).Normalized();
+  Vector palmNormal = alongFingers.Cross(acrossKnuckles).Normalized();
+
+  const auto indexTip = [](const vr::VRBoneTransform_t* pose) {
+    return ModelTransform(pose, {eBone_Wrist, eBone_IndexFinger0, eBone_IndexFinger1,
+                                 eBone_IndexFinger2, eBone_IndexFinger3, eBone_IndexFinger4})
+        .position;
+  };
+  if ((indexTip(fistPose) - indexTip(openPose)).Dot(palmNormal) < 0) palmNormal = -palmNormal;
+
+  // opposition swings the thumb about the fingers' direction into the palm, abduction about the
+  // palm normal away from the index finger
+  const Vector opposedAxis = MetacarpalAxis(openPose, alongFingers, palmNormal);
+  const Vector abductedAxis = MetacarpalAxis(openPose, palmNormal, -acrossKnuckles);
+  const double degreesToRadians = std::acos(-1.0) / 180.0;
+
+  for (int o = 0; o < c_oppositionSteps; o++) {
+    // -1 fully abducted, 0 as authored, 1 fully opposed
+    const double opposition = 2.0 * o / (c_oppositionSteps - 1) - 1.0;
+    const Vector& axis = opposition < 0 ? abductedAxis : opposedAxis;
+    const double angle = std::abs(opposition) * degreesToRadians *
+                         (opposition < 0 ? c_abductionDegrees : c_oppositionDegrees);
+
+    for (int c = 0; c < c_curlSteps; c++) {
+      const float curl = static_cast<float>(c) / (c_curlSteps - 1);
+
+      // the same lerp as the other fingers, so the authored row matches ComputeBoneFlexion
+      vr::VRBoneTransform_t pose[NUM_BONES];
+      for (int bone = 0; bone < NUM_BONES; bone++)
+        pose[bone] = LerpBone(openPose[bone], fistPose[bone], curl);
+
+      const Rigid tipBefore = ThumbTip(pose);
+      TurnMetacarpal(pose, axis, angle);
+
+      // the aux bone lives in root space, it moves with the tip
+      const Rigid tipMove = ThumbTip(pose) * tipBefore.Inverse();
+      ToBone(tipMove * FromBone(pose[eBone_Aux_Thumb]), pose[eBone_Aux_Thumb]);
+
+      for (int i = 0; i < c_boneCount; i++) m_nodes[o][c].bones[i] = pose[c_thumbBones[i]];
+    }
+  }
+}
+
+void ThumbPoseTable::Evaluate(float curl, float opposition,
+                              vr::VRBoneTransform_t* handTransforms) const {
+  // written so NaN lands on 0
+  curl = curl > 0.f ? std::min(curl, 1.f) : 0.f;
+  opposition = opposition > 0.f ? std::min(opposition, 1.f) : 0.f;
+
+  const float c = curl * (c_curlSteps - 1);
+  const float o = opposition * (c_oppositionSteps - 1);
+  const int c0 = std::min(static_cast<int>(c), c_curlSteps - 2);
+  const int o0 = std::min(static_cast<int>(o), c_oppositionSteps - 2);
+  const float fc = c - c0;
+  const float fo = o - o0;
+
+  const float w00 = (1.f - fc) * (1.f - fo);
+  const float w01 = fc * (1.f - fo);
+  const float w10 = (1.f - fc) * fo;
+  const float w11 = fc * fo;
+
+  const Node& n00 = m_nodes[o0][c0];
+  const Node& n01 = m_nodes[o0][c0 + 1];
+  const Node& n10 = m_nodes[o0 + 1][c0];
+  const Node& n11 = m_nodes[o0 + 1][c0 + 1];
+
+  // the first four thumb bones are contiguous in the hand as well as in a node, the aux bone is not
+  const float weights[4] = {w00, w01, w10, w11};
+  const Blend4Kernel blend = Simd().blend4;
+  blend(&n00.bones[0].position.v[0], &n01.bones[0].position.v[0], &n10.bones[0].position.v[0],
+        &n11.bones[0].position.v[0], weights, &handTransforms[eBone_Thumb0].position.v[0], 4 * 8);
+  blend(&n00.bones[4].position.v[0], &n01.bones[4].position.v[0], &n10.bones[4].position.v[0],
+        &n11.bones[4].position.v[0], weights, &handTransforms[eBone_Aux_Thumb].position.v[0], 8);
+}
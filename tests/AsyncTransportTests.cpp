@@ -0,0 +1,243 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "Communication/AsyncTransport.h"
+#include "Test.h"
+
+// Socketpairs stand in for the serial port and Bluetooth socket; Windows has no socketpair().
+#if !defined(_WIN32)
+using namespace std::chrono_literals;
+
+namespace {
+using Socket = asio::local::stream_protocol::socket;
+
+// A device on one end of a socketpair and the driver's end on an io_context of its own, run on a
+// thread for as long as the case needs it.
+class SocketPair {
+ public:
+  SocketPair()
+      : m_driverEnd(m_context), m_deviceEnd(m_deviceContext), m_work(m_context.get_executor()) {
+    asio::local::connect_pair(m_driverEnd, m_deviceEnd);
+    m_thread = std::thread([this]() { m_context.run(); });
+  }
+  ~SocketPair() { Stop(); }
+
+  void Stop() {
+    if (!m_thread.joinable()) return;
+    m_work.reset();
+    m_context.stop();
+    m_thread.join();
+  }
+
+  void Send(std::string_view bytes) { asio::write(m_deviceEnd, asio::buffer(bytes)); }
+
+  asio::io_context& Context() { return m_context; }
+  Socket& DriverEnd() { return m_driverEnd; }
+
+ private:
+  asio::io_context m_context;
+  asio::io_context m_deviceContext;
+  Socket m_driverEnd;
+  Socket m_deviceEnd;
+  asio::executor_work_guard<asio::io_context::executor_type> m_work;
+  std::thread m_thread;
+};
+
+template <typename Predicate>
+bool WaitFor(Predicate&& predicate) {
+  const auto giveUp = std::chrono::steady_clock::now() + 5s;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > giveUp) return false;
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+}  // namespace
+
+TEST(AsyncTransport, ReadsAFrameSplitAcrossReads) {
+  SocketPair pair;
+  FrameBuffer frameBuffer;
+  std::string frames[2];
+  std::atomic<int> read{0};
+
+  asio::co_spawn(
+      pair.Context(),
+      [&]() -> asio::awaitable<void> {
+        for (std::string& frame : frames) {
+          frame = std::string(co_await AsyncReadFrame(pair.DriverEnd(), frameBuffer, 2s));
+          read++;
+        }
+      },
+      asio::detached);
+
+  // each piece arrives as a read of its own, the second frame comes with the end of the first
+  pair.Send("A51");
+  std::this_thread::sleep_for(20ms);
+  pair.Send("2B6");
+  std::this_thread::sleep_for(20ms);
+  CHECK_EQ(read.load(), 0);
+  pair.Send("40\nA1\n");
+
+  REQUIRE(WaitFor([&]() { return read == 2; }));
+  CHECK(frames[0] == "A512B640\n");
+  CHECK(frames[1] == "A1\n");
+}
+
+TEST(AsyncTransport, DeadlineExpiresWithoutAWholeFrame) {
+  SocketPair pair;
+  FrameBuffer frameBuffer;
+  std::atomic<bool> done{false};
+  asio::error_code error;
+  DriverDuration waited{};
+
+  asio::co_spawn(
+      pair.Context(),
+      [&]() -> asio::awaitable<void> {
+        const DriverTimePoint start = DriverClock().Now();
+        try {
+          co_await AsyncReadFrame(pair.DriverEnd(), frameBuffer, 100ms);
+        } catch (const asio::system_error& e) {
+          error = e.code();
+        }
+        waited = DriverClock().Now() - start;
+        done = true;
+      },
+      asio::detached);
+
+  // bytes that never make a frame don't hold the deadline off
+  pair.Send("A5");
+  REQUIRE(WaitFor([&]() { return done.load(); }));
+  CHECK(error == asio::error::timed_out);
+  CHECK(waited >= DriverDuration(100ms));
+  CHECK(waited < DriverDuration(1s));
+}
+
+TEST(AsyncTransport, DeadlineEndsWithTheRead) {
+  SocketPair pair;
+  FrameBuffer frameBuffer;
+  std::atomic<int> read{0};
+  bool failed = false;
+
+  asio::co_spawn(
+      pair.Context(),
+      [&]() -> asio::awaitable<void> {
+        try {
+          co_await AsyncReadFrame(pair.DriverEnd(), frameBuffer, 50ms);
+          read++;
+          // the first read's deadline runs out during this one, which has a long one of its own
+          co_await AsyncReadFrame(pair.DriverEnd(), frameBuffer, 2s);
+          read++;
+        } catch (const asio::system_error&) {
+          failed = true;
+        }
+      },
+      asio::detached);
+
+  pair.Send("A1\n");
+  REQUIRE(WaitFor([&]() { return read == 1; }));
+  std::this_thread::sleep_for(150ms);
+  pair.Send("A2\n");
+
+  REQUIRE(WaitFor([&]() { return read == 2 || failed; }));
+  CHECK(!failed);
+}
+
+TEST(AsyncTransport, RunBlockingResumesOnTheCallersExecutor) {
+  SocketPair pair;
+  asio::thread_pool pool(1);
+  std::atomic<bool> done{false};
+  bool ranElsewhere = false;
+  bool resumedHere = false;
+
+  asio::co_spawn(
+      pair.Context(),
+      [&]() -> asio::awaitable<void> {
+        const std::thread::id caller = std::this_thread::get_id();
+        ranElsewhere =
+            co_await RunBlocking(pool, [&]() { return std::this_thread::get_id() != caller; });
+        resumedHere = pair.Context().get_executor().running_in_this_thread();
+        done = true;
+      },
+      asio::detached);
+
+  REQUIRE(WaitFor([&]() { return done.load(); }));
+  CHECK(ranElsewhere);
+  CHECK(resumedHere);
+  pool.join();
+}
+
+TEST(AsyncTransport, StopDuringRunBlockingDiscardsTheResult) {
+  SocketPair pair;
+  asio::thread_pool pool(1);
+  std::atomic<bool> blocking{false};
+  std::atomic<bool> release{false};
+  std::atomic<bool> resumed{false};
+  // set on the reactor thread, the way Disconnect() marks a transport as stopped
+  bool stopped = false;
+  bool used = false;
+
+  asio::co_spawn(
+      pair.Context(),
+      [&]() -> asio::awaitable<void> {
+        const bool connected = co_await RunBlocking(pool, [&]() {
+          blocking = true;
+          while (!release) std::this_thread::sleep_for(1ms);
+          return true;
+        });
+        used = connected && !stopped;
+        resumed = true;
+      },
+      asio::detached);
+
+  REQUIRE(WaitFor([&]() { return blocking.load(); }));
+  // the reactor carries on while the call blocks
+  std::atomic<bool> handled{false};
+  asio::post(pair.Context(), [&]() {
+    stopped = true;
+    handled = true;
+  });
+  REQUIRE(WaitFor([&]() { return handled.load(); }));
+  CHECK(!resumed);
+
+  release = true;
+  REQUIRE(WaitFor([&]() { return resumed.load(); }));
+  CHECK(!used);
+  pool.join();
+}
+
+TEST(AsyncTransport, ReactorStoppedDuringRunBlockingNeverResumes) {
+  asio::thread_pool pool(1);
+  std::atomic<bool> blocking{false};
+  std::atomic<bool> release{false};
+  std::atomic<bool> finished{false};
+  std::atomic<bool> resumed{false};
+
+  {
+    SocketPair pair;
+    asio::co_spawn(
+        pair.Context(),
+        [&]() -> asio::awaitable<void> {
+          co_await RunBlocking(pool, [&]() {
+            blocking = true;
+            while (!release) std::this_thread::sleep_for(1ms);
+            finished = true;
+            return 0;
+          });
+          resumed = true;
+        },
+        asio::detached);
+
+    REQUIRE(WaitFor([&]() { return blocking.load(); }));
+    // as IoReactor::Stop(): the reactor first, then the pool is left to drain
+    pair.Stop();
+    release = true;
+    pool.join();
+  }
+
+  // the continuation was queued on a stopped reactor and destroyed with it
+  CHECK(finished);
+  CHECK(!resumed);
+}
+#endif
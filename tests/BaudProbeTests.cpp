@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Communication/BaudProbe.h"
+#include "Test.h"
+
+namespace {
+// What one read from the port returns: the bytes, and whether the driver flagged a framing error
+// among them.
+struct Read {
+  std::string bytes;
+  bool lineError = false;
+};
+
+std::string Packets(int count) {
+  std::string packets;
+  for (int i = 0; i < count; i++) {
+    char packet[64];
+    std::snprintf(packet, sizeof(packet), "A%dB%dC%dD%dE%dF%dG%d\n", 500 + i, 640 - i, 700, 800 + i,
+                  900, 511, 511);
+    packets += packet;
+  }
+  return packets;
+}
+
+// The line as the glove drives it, 8N1 at its own rate: per byte a start bit, eight data bits least
+// significant first and a stop bit, bytes back to back within a packet and some idle between
+// packets.
+std::vector<bool> Transmit(std::string_view text) {
+  std::vector<bool> bits(40, true);
+  for (char c : text) {
+    bits.push_back(false);
+    for (int bit = 0; bit < 8; bit++) bits.push_back((static_cast<uint8_t>(c) >> bit) & 1);
+    bits.push_back(true);
+    if (c == '\n') bits.insert(bits.end(), 40, true);
+  }
+  return bits;
+}
+
+// A UART receiving the line at portRate: it looks for a start bit at 16 times its own rate, samples
+// each bit in the middle of where it expects it and flags a framing error when the stop bit is low.
+// Hands the bytes over in reads of readSize, as the driver queue would.
+std::vector<Read> Receive(const std::vector<bool>& line, uint32_t lineRate, uint32_t portRate,
+                          size_t readSize) {
+  const double lineEnd = static_cast<double>(line.size()) / lineRate;
+  const auto level = [&](double t) {
+    const size_t bit = static_cast<size_t>(t * lineRate);
+    return bit >= line.size() || line[bit];
+  };
+
+  std::vector<Read> reads(1);
+  const double step = 1.0 / (16.0 * portRate);
+  bool previous = true;
+  for (double t = 0; t < lineEnd; t += step) {
+    const bool current = level(t);
+    const bool startBit = previous && !current;
+    previous = current;
+    if (!startBit) continue;
+
+    uint8_t byte = 0;
+    for (int bit = 0; bit < 8; bit++)
+      if (level(t + (bit + 1.5) / portRate)) byte |= 1 << bit;
+    const double stop = t + 9.5 / portRate;
+
+    if (reads.back().bytes.size() == readSize) reads.emplace_back();
+    reads.back().bytes += static_cast<char>(byte);
+    if (!level(stop)) reads.back().lineError = true;
+
+    // look for the next start bit from the middle of this stop bit
+    t = stop;
+    previous = level(t);
+  }
+  return reads;
+}
+
+// Feeds reads to a probe the way ProbeBaudRate() does: the error state is checked before each read.
+bool Probe(const std::vector<Read>& reads) {
+  BaudProbe probe;
+  for (const Read& read : reads) {
+    if (read.lineError) probe.OnLineError();
+
+    std::string_view bytes = read.bytes;
+    while (!bytes.empty()) {
+      const size_t chunk = std::min(bytes.size(), probe.WritableBytes());
+      std::memcpy(probe.WritePtr(), bytes.data(), chunk);
+      if (probe.Commit(chunk)) return true;
+      bytes.remove_prefix(chunk);
+    }
+  }
+  return false;
+}
+
+bool ProbeText(std::string_view text) { return Probe({Read{std::string(text)}}); }
+}  // namespace
+
+TEST(BaudProbe, AcceptsARunOfPrintableFrames) {
+  CHECK(ProbeText(Packets(4)));
+  // the first frame only makes up the count
+  CHECK(!ProbeText(Packets(3)));
+  CHECK(ProbeText("A1\r\nA2\r\nA3\r\nA4\r\n"));
+}
+
+TEST(BaudProbe, SkipsTheFrameThePurgeCutInto) {
+  CHECK(ProbeText("\x01\xfe" "512B640\n" + Packets(3)));
+}
+
+TEST(BaudProbe, GarbageRestartsTheRun) {
+  const std::string packets = Packets(2);
+  CHECK(!ProbeText(packets + "A5\x80" "12\n" + packets));
+  CHECK(!ProbeText(packets + "\n" + packets));
+  CHECK(!ProbeText(packets + std::string(1, '\0') + "\n" + packets));
+  CHECK(ProbeText(packets + "\xff\n" + Packets(4)));
+}
+
+TEST(BaudProbe, LineErrorsRestartTheRun) {
+  const std::string packets = Packets(3);
+  CHECK(Probe({Read{packets}, Read{Packets(2)}}));
+  CHECK(!Probe({Read{packets}, Read{Packets(2), true}}));
+  CHECK(Probe({Read{packets}, Read{Packets(2), true}, Read{Packets(1)}}));
+}
+
+TEST(BaudProbe, MatchesOnlyTheRateTheGloveSendsAt) {
+  const std::vector<bool> line = Transmit(Packets(20));
+
+  for (uint32_t gloveRate : c_autoBaudRates) {
+    for (uint32_t portRate : c_autoBaudRates) {
+      // reads of a few bytes and of whole bursts, as a busy or an idle listener would make
+      for (size_t readSize : {7, 256}) {
+        const bool matched = Probe(Receive(line, gloveRate, portRate, readSize));
+        if (matched != (gloveRate == portRate)) {
+          std::fprintf(stderr, "glove at %u, port at %u, reads of %zu: %s\n", gloveRate, portRate,
+                       readSize, matched ? "matched" : "no match");
+        }
+        CHECK(matched == (gloveRate == portRate));
+      }
+    }
+  }
+}
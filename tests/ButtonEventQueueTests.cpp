@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ButtonEventQueue.h"
+#include "Encode/AlphaEncodingManager.h"
+#include "Encode/PackedSample.h"
+#include "Test.h"
+
+namespace {
+const int64_t c_packetNs = 1000000;  // a 1kHz glove
+const int c_packetsPerFrame = 11;    // and a 90Hz headset
+
+// One packet of a glove holding the given flag keys (H joystick, I trigger, J A, K B, L grab).
+std::string Packet(const std::string& flags) {
+  return "A512B512C512D512E512F512G512" + flags + "\n";
+}
+
+// What SteamVR ends up seeing: every press and release with its offset from the frame it is
+// submitted in.
+struct Submitted {
+  uint16_t buttons;
+  uint16_t changed;
+  int64_t packet;
+  int64_t frameOffsetNs;
+};
+
+// Decodes the packets one by one the way a transport does and drains the queue every frame the way
+// RunFrame does.
+std::vector<Submitted> Replay(const std::vector<std::string>& flags) {
+  AlphaEncodingManager encoding(1023.f);
+  ButtonEventQueue queue(64);
+  std::vector<Submitted> submitted;
+
+  for (size_t i = 0; i <= flags.size(); i++) {
+    const int64_t nowNs = static_cast<int64_t>(i) * c_packetNs;
+
+    if (i % c_packetsPerFrame == 0) {
+      queue.Drain([&](const ButtonEvent& event) {
+        submitted.push_back(
+            {event.buttons, event.changed, event.timeNs / c_packetNs, event.timeNs - nowNs});
+      });
+    }
+
+    if (i < flags.size()) {
+      queue.OnSample(
+          PackSample(encoding.Decode(Packet(flags[i])), static_cast<uint32_t>(i), nowNs));
+    }
+  }
+
+  return submitted;
+}
+}  // namespace
+
+TEST(ButtonEventQueue, ReplaysRapidTapsBetweenFrames) {
+  // 33 packets, three frames. Every tap is one packet long and over before the next frame
+  std::vector<std::string> flags(33);
+  flags[2] = "J";    // A
+  flags[4] = "K";    // B
+  flags[5] = "IK";   // trigger while B is held
+  flags[7] = "H";    // joystick click
+  flags[12] = "L";   // grab follows the analog channels, no events
+  flags[14] = "JL";  // A, released on the next frame boundary
+  flags[22] = "J";   // and pressed again right on it
+
+  const std::vector<Submitted> submitted = Replay(flags);
+
+  const std::vector<Submitted> expected = {
+      {PackedButton_A, PackedButton_A, 2, 2 * c_packetNs - 11 * c_packetNs},
+      {0, PackedButton_A, 3, 3 * c_packetNs - 11 * c_packetNs},
+      {PackedButton_B, PackedButton_B, 4, 4 * c_packetNs - 11 * c_packetNs},
+      {PackedButton_B | PackedButton_Trigger, PackedButton_Trigger, 5,
+       5 * c_packetNs - 11 * c_packetNs},
+      {0, PackedButton_B | PackedButton_Trigger, 6, 6 * c_packetNs - 11 * c_packetNs},
+      {PackedButton_Joystick, PackedButton_Joystick, 7, 7 * c_packetNs - 11 * c_packetNs},
+      {0, PackedButton_Joystick, 8, 8 * c_packetNs - 11 * c_packetNs},
+      {PackedButton_A, PackedButton_A, 14, 14 * c_packetNs - 22 * c_packetNs},
+      {0, PackedButton_A, 15, 15 * c_packetNs - 22 * c_packetNs},
+      {PackedButton_A, PackedButton_A, 22, 22 * c_packetNs - 33 * c_packetNs},
+      {0, PackedButton_A, 23, 23 * c_packetNs - 33 * c_packetNs},
+  };
+
+  REQUIRE(submitted.size() == expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    CHECK_EQ(submitted[i].buttons, expected[i].buttons);
+    CHECK_EQ(submitted[i].changed, expected[i].changed);
+    CHECK_EQ(submitted[i].packet, expected[i].packet);
+    CHECK_EQ(submitted[i].frameOffsetNs, expected[i].frameOffsetNs);
+  }
+
+  // taking only the latest packet at each frame would have seen none of these taps
+  for (int frame = 1; frame * c_packetsPerFrame <= 33; frame++)
+    CHECK(flags[frame * c_packetsPerFrame - 1].find_first_of("HIJK") == std::string::npos);
+}
+
+TEST(ButtonEventQueue, OverflowKeepsTheFinalState) {
+  ButtonEventQueue queue(4);
+
+  PackedSample sample{};
+  for (int i = 0; i < 10; i++) {
+    sample.timeNs = i;
+    sample.buttons = (i % 2 == 0) ? PackedButton_A : 0;
+    queue.OnSample(sample);
+  }
+  // pressed at the end, with the last queued event a press too
+  sample.timeNs = 10;
+  sample.buttons = PackedButton_A | PackedButton_B;
+  queue.OnSample(sample);
+  CHECK(queue.Overflows() > 0);
+
+  uint16_t state = 0;
+  queue.Drain([&](const ButtonEvent& event) {
+    CHECK_EQ(event.changed, static_cast<uint16_t>(event.buttons ^ state));
+    state = event.buttons;
+  });
+
+  // the next packet carries the change that didn't fit
+  sample.timeNs = 11;
+  queue.OnSample(sample);
+  queue.Drain([&](const ButtonEvent& event) {
+    CHECK_EQ(event.changed, static_cast<uint16_t>(event.buttons ^ state));
+    state = event.buttons;
+  });
+  CHECK_EQ(state, static_cast<uint16_t>(PackedButton_A | PackedButton_B));
+}
+
+TEST(ButtonEventQueue, ReplaysAcrossThreads) {
+  // a transport thread decoding as fast as it can against a frame loop draining
+  const int packets = 200000;
+  ButtonEventQueue queue(1024);
+
+  std::vector<PackedSample> samples(packets);
+  uint32_t random = 12345;
+  uint16_t buttons = 0;
+  int changes = 0;
+  for (int i = 0; i < packets; i++) {
+    random = random * 1664525u + 1013904223u;
+    // a tap or release on roughly one packet in eight
+    if ((random >> 24) < 32) {
+      buttons ^= static_cast<uint16_t>(1u << ((random >> 8) % 4));
+      changes++;
+    }
+    samples[i].timeNs = i;
+    samples[i].buttons = buttons;
+  }
+
+  std::atomic<bool> done{false};
+  std::thread producer([&]() {
+    for (const PackedSample& sample : samples) queue.OnSample(sample);
+    done = true;
+  });
+
+  uint16_t state = 0;
+  int64_t lastNs = -1;
+  int events = 0;
+  bool finished = false;
+  while (!finished) {
+    finished = done;
+    queue.Drain([&](const ButtonEvent& event) {
+      CHECK_EQ(event.changed, static_cast<uint16_t>(event.buttons ^ state));
+      CHECK(event.timeNs > lastNs);
+      state = event.buttons;
+      lastNs = event.timeNs;
+      events++;
+    });
+  }
+  producer.join();
+
+  // a change that overflowed is folded into a later one, otherwise every change arrives
+  CHECK(events <= changes);
+  if (queue.Overflows() == 0) CHECK_EQ(events, changes);
+
+  // and once the transport delivers again the state is right whatever was lost
+  queue.OnSample(samples.back());
+  queue.Drain([&](const ButtonEvent& event) { state = event.buttons; });
+  CHECK_EQ(state, buttons);
+}
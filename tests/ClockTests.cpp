@@ -0,0 +1,200 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+#include "LateLatchScheduler.h"
+#include "Recorder.h"
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+// Makes a SimulatedClock the driver clock for one case and puts the system clock back afterwards.
+class ScopedSimulatedClock {
+ public:
+  ScopedSimulatedClock() {
+    auto clock = std::make_unique<SimulatedClock>();
+    m_clock = clock.get();
+    SetDriverClock(std::move(clock));
+  }
+  ~ScopedSimulatedClock() { SetDriverClock(nullptr); }
+
+  SimulatedClock& operator*() { return *m_clock; }
+  SimulatedClock* operator->() { return m_clock; }
+
+ private:
+  SimulatedClock* m_clock;
+};
+
+// Spins until the condition holds, or gives up after a generous amount of real time.
+template <typename Condition>
+bool WaitFor(Condition condition) {
+  const auto giveUp = std::chrono::steady_clock::now() + 10s;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > giveUp) return false;
+    std::this_thread::yield();
+  }
+  return true;
+}
+}  // namespace
+
+TEST(Clock, SimulatedSleepersWakeInDeadlineOrder) {
+  SimulatedClock clock;
+  std::mutex mutex;
+  std::vector<int> woken;
+
+  std::thread late([&]() {
+    clock.SleepUntil(DriverTimePoint(20ms));
+    std::lock_guard<std::mutex> lock(mutex);
+    woken.push_back(20);
+  });
+  std::thread early([&]() {
+    clock.SleepUntil(DriverTimePoint(10ms));
+    std::lock_guard<std::mutex> lock(mutex);
+    woken.push_back(10);
+  });
+
+  REQUIRE(WaitFor([&]() { return clock.SleepingCount() == 2; }));
+  CHECK(clock.AdvanceToNextWakeup());
+  CHECK(clock.Now() == DriverTimePoint(10ms));
+  REQUIRE(WaitFor([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return woken.size() == 1;
+  }));
+
+  CHECK(clock.AdvanceToNextWakeup());
+  CHECK(clock.Now() == DriverTimePoint(20ms));
+  late.join();
+  early.join();
+
+  CHECK(woken == std::vector<int>({10, 20}));
+  CHECK(!clock.AdvanceToNextWakeup());
+}
+
+TEST(Clock, SimulatedTimeNeverRunsBackwards) {
+  SimulatedClock clock(DriverTimePoint(5s));
+  clock.AdvanceTo(DriverTimePoint(1s));
+  CHECK(clock.Now() == DriverTimePoint(5s));
+
+  clock.AdvanceBy(250ms);
+  CHECK(clock.Now() == DriverTimePoint(5250ms));
+}
+
+TEST(Clock, ParticipantsRunFasterThanRealTime) {
+  SimulatedClock clock;
+  clock.SetParticipants(1);
+
+  // an hour of 90Hz frames
+  const DriverDuration period = 11111111ns;
+  const int ticks = 90 * 3600;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::thread worker([&]() {
+    Ticker ticker(clock, period);
+    for (int i = 0; i < ticks; i++) ticker.Wait();
+  });
+  worker.join();
+
+  // every tick lands exactly on the schedule, nothing drifts
+  CHECK(clock.Now() == DriverTimePoint(period * ticks));
+  CHECK(std::chrono::steady_clock::now() - start < 60s);
+}
+
+TEST(Clock, TickerRebasesInsteadOfBursting) {
+  SimulatedClock clock;
+  Ticker ticker(clock, 10ms);
+  CHECK(ticker.NextTick() == DriverTimePoint(10ms));
+
+  clock.AdvanceBy(35ms);
+  ticker.Wait();
+  CHECK(ticker.NextTick() == DriverTimePoint(45ms));
+
+  ticker.SetPeriod(20ms);
+  CHECK(ticker.NextTick() == DriverTimePoint(55ms));
+}
+
+TEST(Clock, SignalCutsSleepShort) {
+  SystemClock systemClock;
+  SimulatedClock simulatedClock;
+
+  for (IClock* clock : {static_cast<IClock*>(&systemClock), static_cast<IClock*>(&simulatedClock)}) {
+    ClockSignal stop;
+    std::atomic<int> result{-1};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread sleeper([&]() { result = clock->SleepFor(1h, stop) ? 1 : 0; });
+    std::this_thread::sleep_for(5ms);
+    stop.Set();
+    sleeper.join();
+
+    CHECK_EQ(result.load(), 0);
+    CHECK(std::chrono::steady_clock::now() - start < 5s);
+
+    // stays set, and an elapsed deadline still counts as a cancel
+    CHECK(!clock->SleepFor(0ns, stop));
+    stop.Reset();
+    CHECK(clock->SleepFor(0ns, stop));
+  }
+
+  CHECK_EQ(simulatedClock.SleepingCount(), 0u);
+}
+
+TEST(Clock, HostWaitsFollowTheClock) {
+  SystemClock systemClock;
+  SimulatedClock simulatedClock;
+
+  CHECK(systemClock.MaxHostWait(1h) == DriverDuration(1h));
+  CHECK(simulatedClock.MaxHostWait(1h) <= DriverDuration(1ms));
+  CHECK(simulatedClock.MaxHostWait(100us) == DriverDuration(100us));
+}
+
+TEST(Clock, LateLatchSchedulerRunsOnSimulatedTime) {
+  ScopedSimulatedClock clock;
+  clock->SetParticipants(1);
+
+  const DriverDuration period = 11ms;
+  std::mutex mutex;
+  std::vector<DriverTimePoint> submits;
+
+  LateLatchScheduler scheduler(period, 2ms);
+  scheduler.Start([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (submits.size() < 1000) submits.push_back(DriverClock().Now());
+  });
+
+  REQUIRE(WaitFor([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return submits.size() == 1000;
+  }));
+  scheduler.Stop();
+
+  // no RunFrame seen, so it runs at the initial period, to the nanosecond
+  for (size_t i = 1; i < submits.size(); i++) CHECK(submits[i] - submits[i - 1] == period);
+}
+
+TEST(Clock, StopsWithoutWaitingForSimulatedTime) {
+  ScopedSimulatedClock clock;
+
+  // time never moves, so without the signal both threads would sleep forever
+  LateLatchScheduler scheduler(11ms, 2ms);
+  scheduler.Start([]() {});
+  REQUIRE(WaitFor([&]() { return clock->SleepingCount() == 1; }));
+  scheduler.Stop();
+
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "openglove_tests" / "clock_recorder";
+  Recorder recorder(directory.string(), RecorderContent_Frames);
+  REQUIRE(recorder.Start("frames.txt"));
+  recorder.RecordFrame("A1\n");
+  REQUIRE(WaitFor([&]() { return clock->SleepingCount() == 1; }));
+  recorder.Stop();
+
+  CHECK_EQ(recorder.Written(), 1u);
+  CHECK_EQ(clock->SleepingCount(), 0u);
+  std::error_code error;
+  std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,568 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ButtonEventQueue.h"
+#include "Communication/FramePipeline.h"
+#include "Communication/TransportWaiter.h"
+#include "Encode/PackedSample.h"
+#include "SampleHistory.h"
+#include "SeqLock.h"
+#include "SpscRing.h"
+#include "Test.h"
+
+/**
+ * Stress and linearizability checks for the lock-free primitives. Every case runs its producer and
+ * consumers flat out with random stalls on either side, so the threads interleave at every point
+ * of the protocols, and checks after every operation:
+ *
+ *   - nothing torn: each value carries fields derived from its sequence number
+ *   - nothing lost, duplicated or reordered where the primitive promises that
+ *   - real-time order: an operation never returns a value older than one whose store had already
+ *     completed when the operation started
+ *
+ * Each case runs for OPENGLOVE_STRESS_MS milliseconds, 300 if unset, and reports throughput and
+ * latency percentiles. Build with -DOPENGLOVE_SANITIZE=thread to run them under ThreadSanitizer.
+ **/
+namespace {
+using SteadyClock = std::chrono::steady_clock;
+
+SteadyClock::duration StressTime() {
+  const char* value = std::getenv("OPENGLOVE_STRESS_MS");
+  return std::chrono::milliseconds(value != nullptr ? std::atoi(value) : 300);
+}
+
+int ReaderThreads() {
+  return static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 3u, 7u)) - 1;
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now().time_since_epoch())
+      .count();
+}
+
+class Random {
+ public:
+  explicit Random(uint32_t seed) : m_state(seed) {}
+
+  uint32_t Next() {
+    m_state = m_state * 1664525u + 1013904223u;
+    return m_state >> 8;
+  }
+  uint32_t Below(uint32_t limit) { return Next() % limit; }
+
+ private:
+  uint32_t m_state;
+};
+
+// Stalls now and then for a random while, from a few pauses to a trip through the scheduler.
+void Jitter(Random& random) {
+  const uint32_t roll = random.Below(1024);
+  if (roll < 16) {
+    for (uint32_t i = random.Below(512); i > 0; i--) CpuRelax();
+  } else if (roll < 18) {
+    std::this_thread::yield();
+  } else if (roll < 19) {
+    std::this_thread::sleep_for(std::chrono::microseconds(random.Below(100)));
+  }
+}
+
+// Power of two buckets, enough for percentiles to within a factor of two without storing samples.
+class LatencyRecorder {
+ public:
+  void Add(int64_t ns) {
+    int bucket = 0;
+    while (bucket < 63 && (int64_t(1) << bucket) < ns) bucket++;
+    m_buckets[bucket]++;
+    m_count++;
+  }
+
+  void Merge(const LatencyRecorder& other) {
+    for (size_t i = 0; i < m_buckets.size(); i++) m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+  }
+
+  // Upper bound of the bucket holding the given fraction of samples.
+  int64_t Percentile(double fraction) const {
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+      seen += m_buckets[i];
+      if (seen > 0 && static_cast<double>(seen) >= fraction * static_cast<double>(m_count))
+        return int64_t(1) << i;
+    }
+    return 0;
+  }
+
+ private:
+  std::array<uint64_t, 64> m_buckets{};
+  uint64_t m_count = 0;
+};
+
+void Report(const char* name, uint64_t operations, SteadyClock::duration elapsed,
+            const LatencyRecorder* latency = nullptr) {
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  std::printf("  %-28s %12.0f ops/s", name, static_cast<double>(operations) / seconds);
+  if (latency != nullptr) {
+    std::printf("   latency p50 <%lld ns  p99 <%lld ns  p99.9 <%lld ns",
+                static_cast<long long>(latency->Percentile(0.5)),
+                static_cast<long long>(latency->Percentile(0.99)),
+                static_cast<long long>(latency->Percentile(0.999)));
+  }
+  std::printf("\n");
+}
+
+// Every field follows from the sequence, so a value stitched from two writes shows.
+struct Stamped {
+  uint64_t sequence;
+  int64_t sentNs;
+  uint64_t check[6];
+
+  static Stamped Make(uint64_t sequence, int64_t sentNs) {
+    Stamped value{sequence, sentNs, {}};
+    for (uint64_t i = 0; i < 6; i++) value.check[i] = sequence * 0x9e3779b97f4a7c15ull + i;
+    return value;
+  }
+
+  bool Whole() const {
+    for (uint64_t i = 0; i < 6; i++)
+      if (check[i] != sequence * 0x9e3779b97f4a7c15ull + i) return false;
+    return true;
+  }
+};
+
+PackedSample MakeSample(uint32_t sequence) {
+  PackedSample sample{};
+  sample.timeNs = int64_t(sequence) * 1000;
+  sample.sequence = sequence;
+  sample.buttons = static_cast<uint16_t>(sequence * 3);
+  for (int i = 0; i < 5; i++) {
+    sample.flexion[i] = static_cast<uint16_t>(sequence * 7 + i);
+    sample.splay[i] = static_cast<uint16_t>(sequence * 13 + i);
+  }
+  sample.joyX = static_cast<int16_t>(sequence * 17);
+  sample.joyY = static_cast<int16_t>(sequence * 19);
+  return sample;
+}
+
+bool SameSample(const PackedSample& a, const PackedSample& b) {
+  return std::memcmp(&a, &b, sizeof(PackedSample)) == 0;
+}
+}  // namespace
+
+TEST(ConcurrencyStress, SpscRingKeepsOrderAndLosesNothing) {
+  SpscRing<Stamped> ring(64);
+  std::atomic<bool> running{true};
+  // pushes that have returned, the consumer's view of what has to be in the ring or already out
+  std::atomic<uint64_t> pushed{0};
+
+  std::thread producer([&]() {
+    Random random(1);
+    uint64_t next = 0;
+    while (running) {
+      if (ring.TryPush(Stamped::Make(next, NowNs()))) {
+        next++;
+        pushed.store(next, std::memory_order_release);
+      }
+      Jitter(random);
+    }
+  });
+
+  Random random(2);
+  LatencyRecorder latency;
+  uint64_t popped = 0;
+  bool whole = true;
+  bool ordered = true;
+  bool emptyOnlyWhenDrained = true;
+
+  const auto start = SteadyClock::now();
+  const auto end = start + StressTime();
+  bool finishing = false;
+  while (true) {
+    if (!finishing && SteadyClock::now() >= end) {
+      running = false;
+      producer.join();
+      finishing = true;
+    }
+
+    const uint64_t completed = pushed.load(std::memory_order_acquire);
+    Stamped value;
+    if (ring.TryPop(value)) {
+      latency.Add(NowNs() - value.sentNs);
+      whole &= value.Whole();
+      ordered &= value.sequence == popped;
+      popped++;
+    } else {
+      // empty, so everything pushed before the pop started has come out
+      emptyOnlyWhenDrained &= popped >= completed;
+      if (finishing) break;
+    }
+    Jitter(random);
+  }
+  const auto elapsed = SteadyClock::now() - start;
+
+  Report("SpscRing", popped, elapsed, &latency);
+  CHECK(whole);
+  CHECK(ordered);
+  CHECK(emptyOnlyWhenDrained);
+  CHECK_EQ(popped, pushed.load());
+  CHECK(popped > 0);
+}
+
+TEST(ConcurrencyStress, SeqLockReadsAreWholeAndNeverGoBack) {
+  SeqLock<Stamped> lock(Stamped::Make(0, 0));
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> stored{0};
+
+  const int readers = ReaderThreads();
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> reads(readers);
+  std::vector<LatencyRecorder> latencies(readers);
+  std::atomic<bool> whole{true};
+  std::atomic<bool> linearizable{true};
+
+  for (int reader = 0; reader < readers; reader++) {
+    threads.emplace_back([&, reader]() {
+      Random random(100 + reader);
+      uint64_t last = 0;
+      uint32_t lastVersion = 0;
+      while (running) {
+        const uint64_t completed = stored.load(std::memory_order_acquire);
+        const int64_t startNs = NowNs();
+        uint32_t version;
+        const Stamped value = lock.Load(&version);
+        latencies[reader].Add(NowNs() - startNs);
+
+        whole = whole && value.Whole();
+        // the k-th store leaves version 2k, and no read may return a value older than one whose
+        // store had finished before it began, nor older than what this reader already saw
+        linearizable = linearizable && version == 2 * value.sequence &&
+                       value.sequence >= completed && value.sequence >= last &&
+                       version >= lastVersion;
+        last = value.sequence;
+        lastVersion = version;
+        reads[reader]++;
+        Jitter(random);
+      }
+    });
+  }
+
+  Random random(3);
+  const auto start = SteadyClock::now();
+  const auto end = start + StressTime();
+  uint64_t stores = 0;
+  while (SteadyClock::now() < end) {
+    stores++;
+    lock.Store(Stamped::Make(stores, 0));
+    stored.store(stores, std::memory_order_release);
+    Jitter(random);
+  }
+  running = false;
+  for (std::thread& thread : threads) thread.join();
+  const auto elapsed = SteadyClock::now() - start;
+
+  uint64_t totalReads = 0;
+  LatencyRecorder latency;
+  for (int reader = 0; reader < readers; reader++) {
+    totalReads += reads[reader];
+    latency.Merge(latencies[reader]);
+  }
+  Report("SeqLock stores", stores, elapsed);
+  Report("SeqLock loads", totalReads, elapsed, &latency);
+
+  CHECK(whole);
+  CHECK(linearizable);
+  CHECK(totalReads > 0);
+}
+
+TEST(ConcurrencyStress, SampleHistoryReadersSeeWholeOrderedSamples) {
+  SampleHistory history(256);
+  std::atomic<bool> running{true};
+
+  const int readers = ReaderThreads();
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> reads(readers);
+  std::vector<uint64_t> misses(readers);
+  std::atomic<bool> whole{true};
+  std::atomic<bool> linearizable{true};
+
+  for (int reader = 0; reader < readers; reader++) {
+    threads.emplace_back([&, reader]() {
+      Random random(200 + reader);
+      uint32_t lastLatest = 0;
+      PackedSample recent[32];
+
+      while (running) {
+        const uint64_t appended = history.Appended();
+        PackedSample latest;
+        switch (random.Below(3)) {
+          case 0:
+            if (!history.Latest(latest)) {
+              misses[reader]++;
+              break;
+            }
+            whole = whole && SameSample(latest, MakeSample(latest.sequence));
+            // at least the newest sample appended before the call, and never older than before
+            linearizable = linearizable && latest.sequence + 1 >= appended &&
+                           latest.sequence >= lastLatest;
+            lastLatest = latest.sequence;
+            break;
+
+          case 1: {
+            const size_t copied = history.CopyRecent(recent, 1 + random.Below(32));
+            if (copied == 0) {
+              misses[reader]++;
+              break;
+            }
+            for (size_t i = 0; i < copied; i++) {
+              whole = whole && SameSample(recent[i], MakeSample(recent[i].sequence));
+              // consecutive, oldest first, ending no earlier than what was appended at the start
+              if (i > 0)
+                linearizable = linearizable && recent[i].sequence == recent[i - 1].sequence + 1;
+            }
+            linearizable = linearizable && recent[copied - 1].sequence + 1 >= appended;
+            break;
+          }
+
+          default: {
+            if (appended < 2) break;
+            // a time right on a recent sample interpolates to exactly that sample
+            const uint32_t window = appended < 64 ? static_cast<uint32_t>(appended) : 64;
+            const uint64_t back = random.Below(window);
+            const uint32_t sequence = static_cast<uint32_t>(appended - 1 - back);
+            VRCommData_t value = UnpackSample(PackedSample{});
+            if (!history.ValueAt(int64_t(sequence) * 1000, value)) {
+              misses[reader]++;
+              break;
+            }
+            const VRCommData_t expected = UnpackSample(MakeSample(sequence));
+            whole = whole && value.flexion == expected.flexion && value.splay == expected.splay &&
+                    value.joyX == expected.joyX && value.joyY == expected.joyY;
+            break;
+          }
+        }
+        reads[reader]++;
+        Jitter(random);
+      }
+    });
+  }
+
+  Random random(4);
+  const auto start = SteadyClock::now();
+  const auto end = start + StressTime();
+  uint32_t appends = 0;
+  while (SteadyClock::now() < end) {
+    history.Append(MakeSample(appends++));
+    Jitter(random);
+  }
+  running = false;
+  for (std::thread& thread : threads) thread.join();
+  const auto elapsed = SteadyClock::now() - start;
+
+  uint64_t totalReads = 0;
+  uint64_t totalMisses = 0;
+  for (int reader = 0; reader < readers; reader++) {
+    totalReads += reads[reader];
+    totalMisses += misses[reader];
+  }
+  Report("SampleHistory appends", appends, elapsed);
+  Report("SampleHistory reads", totalReads, elapsed);
+  std::printf("  %-28s %12llu lapped by the writer\n", "",
+              static_cast<unsigned long long>(totalMisses));
+
+  CHECK(whole);
+  CHECK(linearizable);
+  // giving up after being lapped is allowed, and common under a sanitizer's slow copies, but the
+  // checks above need reads that got through
+  CHECK(totalMisses < totalReads);
+}
+
+TEST(ConcurrencyStress, ButtonEventQueueDeliversEveryChangeInOrder) {
+  ButtonEventQueue queue(64);
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> changes{0};
+  PackedSample last{};
+
+  std::thread producer([&]() {
+    Random random(5);
+    PackedSample sample{};
+    int64_t lastNs = 0;
+    while (running) {
+      if (random.Below(4) == 0) {
+        sample.buttons ^= static_cast<uint16_t>(1u << random.Below(4));
+        changes++;
+      }
+      // strictly increasing so the consumer can check the order
+      sample.timeNs = std::max(NowNs(), lastNs + 1);
+      lastNs = sample.timeNs;
+      queue.OnSample(sample);
+      Jitter(random);
+    }
+    last = sample;
+  });
+
+  Random random(6);
+  LatencyRecorder latency;
+  uint16_t state = 0;
+  int64_t lastNs = -1;
+  uint64_t events = 0;
+  bool consistent = true;
+
+  const auto start = SteadyClock::now();
+  const auto end = start + StressTime();
+  bool finishing = false;
+  while (true) {
+    if (!finishing && SteadyClock::now() >= end) {
+      running = false;
+      producer.join();
+      finishing = true;
+    }
+
+    queue.Drain([&](const ButtonEvent& event) {
+      latency.Add(NowNs() - event.timeNs);
+      consistent &= event.changed == (event.buttons ^ state) && event.changed != 0;
+      consistent &= event.timeNs > lastNs;
+      state = event.buttons;
+      lastNs = event.timeNs;
+      events++;
+    });
+    if (finishing) break;
+    Jitter(random);
+  }
+  const auto elapsed = SteadyClock::now() - start;
+
+  // the next packet carries any change that found the queue full. The producer side is free now
+  last.timeNs++;
+  queue.OnSample(last);
+  queue.Drain([&](const ButtonEvent& event) {
+    consistent &= event.changed == (event.buttons ^ state);
+    state = event.buttons;
+  });
+
+  Report("ButtonEventQueue", events, elapsed, &latency);
+  CHECK(consistent);
+  CHECK_EQ(state, last.buttons);
+  // folding into the next event is the only way a change can go missing
+  CHECK(events <= changes);
+  if (queue.Overflows() == 0) CHECK_EQ(events, changes.load());
+}
+
+namespace {
+// Frames of varying length that name their sequence and say when they were written, with a
+// checksum over the rest.
+size_t WriteFrame(char* out, uint64_t sequence, size_t padding) {
+  char body[64];
+  const int length = std::snprintf(body, sizeof(body), "%llu,%lld,",
+                                   static_cast<unsigned long long>(sequence),
+                                   static_cast<long long>(NowNs()));
+  std::memcpy(out, body, length);
+  std::memset(out + length, 'a' + sequence % 26, padding);
+  const size_t size = length + padding;
+  out[size] = '\n';
+  return size + 1;
+}
+
+// false if the frame is not one WriteFrame() wrote
+bool ReadFrame(std::string_view frame, uint64_t& sequence, int64_t& sentNs) {
+  unsigned long long parsedSequence;
+  long long parsedNs;
+  int consumed = 0;
+  const std::string text(frame);
+  if (std::sscanf(text.c_str(), "%llu,%lld,%n", &parsedSequence, &parsedNs, &consumed) != 2)
+    return false;
+
+  sequence = parsedSequence;
+  sentNs = parsedNs;
+  const char filler = static_cast<char>('a' + sequence % 26);
+  for (size_t i = consumed; i + 1 < frame.size(); i++)
+    if (frame[i] != filler) return false;
+  return frame.back() == '\n';
+}
+
+void StressPipeline(VRBackpressurePolicy policy, const char* name) {
+  FramePipeline pipeline(4096, policy, 256);
+  std::atomic<uint64_t> written{0};
+
+  Random readerRandom(7);
+  std::thread reader([&]() {
+    // frames are cut into reads of random size, the way bytes arrive from a transport
+    std::string pending;
+    uint64_t sequence = 0;
+    char frame[512];
+    while (true) {
+      while (pending.size() < 1024) {
+        pending.append(frame, WriteFrame(frame, sequence++, readerRandom.Below(200)));
+      }
+
+      size_t room = 0;
+      char* writePtr = pipeline.PrepareWrite(room);
+      if (writePtr == nullptr) break;
+
+      const size_t bytes = std::min<size_t>({1 + readerRandom.Below(600), pending.size(), room});
+      std::memcpy(writePtr, pending.data(), bytes);
+      pipeline.Commit(bytes);
+      pending.erase(0, bytes);
+
+      // complete frames handed over so far
+      written.store(sequence - std::count(pending.begin(), pending.end(), '\n'),
+                    std::memory_order_release);
+      Jitter(readerRandom);
+    }
+  });
+
+  Random random(8);
+  LatencyRecorder latency;
+  uint64_t received = 0;
+  uint64_t expected = 0;
+  bool whole = true;
+  bool ordered = true;
+
+  const auto start = SteadyClock::now();
+  std::thread stopper([&]() {
+    std::this_thread::sleep_for(StressTime());
+    pipeline.Stop();
+  });
+
+  std::string_view frame;
+  while (pipeline.NextFrame(frame)) {
+    uint64_t sequence = 0;
+    int64_t sentNs = 0;
+    whole &= ReadFrame(frame, sequence, sentNs);
+    latency.Add(NowNs() - sentNs);
+
+    // blocking loses nothing, dropping only ever skips ahead
+    ordered &= policy == BACKPRESSURE_BLOCK ? sequence == expected : sequence >= expected;
+    expected = sequence + 1;
+    received++;
+
+    Jitter(random);
+    pipeline.Release();
+  }
+  stopper.join();
+  reader.join();
+  const auto elapsed = SteadyClock::now() - start;
+
+  Report(name, received, elapsed, &latency);
+  CHECK(whole);
+  CHECK(ordered);
+  CHECK(received > 0);
+  CHECK(received <= written.load());
+  if (policy == BACKPRESSURE_BLOCK) CHECK_EQ(pipeline.Stats().framesDropped.load(), 0u);
+}
+}  // namespace
+
+TEST(ConcurrencyStress, FramePipelineBlockingKeepsEveryFrame) {
+  StressPipeline(BACKPRESSURE_BLOCK, "FramePipeline blocking");
+}
+
+TEST(ConcurrencyStress, FramePipelineDroppingKeepsFramesWhole) {
+  StressPipeline(BACKPRESSURE_DROP, "FramePipeline dropping");
+}
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Communication/FrameBuffer.h"
+#include "Communication/FramePipeline.h"
+#include "Encode/AlphaEncodingManager.h"
+#include "Encode/LegacyEncodingManager.h"
+#include "Encode/PackedSample.h"
+#include "Test.h"
+
+/**
+ * Adversarial streams (no terminators, huge numbers, repeated keys, binary garbage) through framing
+ * and both decoders. Besides the output being sane, the cost has to stay linear: time per byte and
+ * the memory held while a stream goes through have fixed ceilings, whatever the stream looks like.
+ *
+ * The memory ceiling is checked by counting every byte allocated through operator new, which this
+ * file replaces for the whole test binary.
+ **/
+namespace {
+std::atomic<int64_t> g_liveBytes{0};
+std::atomic<int64_t> g_peakBytes{0};
+// keeps the block behind the size as aligned as operator new has to be
+constexpr size_t c_allocationHeader = alignof(std::max_align_t);
+}  // namespace
+
+void* operator new(size_t size) {
+  void* block = std::malloc(size + c_allocationHeader);
+  if (block == nullptr) throw std::bad_alloc();
+  *static_cast<size_t*>(block) = size;
+
+  const int64_t bytes = static_cast<int64_t>(size);
+  const int64_t live = g_liveBytes.fetch_add(bytes) + bytes;
+  int64_t peak = g_peakBytes.load();
+  while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live)) {
+  }
+  return static_cast<char*>(block) + c_allocationHeader;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer == nullptr) return;
+  void* block = static_cast<char*>(pointer) - c_allocationHeader;
+  g_liveBytes.fetch_sub(static_cast<int64_t>(*static_cast<size_t*>(block)));
+  std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+
+namespace {
+// Far above what framing and decoding cost even in a debug or sanitizer build. Rescanning a frame
+// for every read, or a decoder that backtracks, lands well above it on these streams.
+constexpr double c_maxNsPerByte = 250;
+// Nothing on the hot path allocates once the buffers exist, this leaves room for the exceptions
+// the decoders throw on bad frames.
+constexpr int64_t c_maxPeakBytes = 64 * 1024;
+
+class Random {
+ public:
+  explicit Random(uint32_t seed) : m_state(seed) {}
+
+  uint32_t Next() {
+    m_state = m_state * 1664525u + 1013904223u;
+    return m_state >> 8;
+  }
+  uint32_t Below(uint32_t limit) { return Next() % limit; }
+
+ private:
+  uint32_t m_state;
+};
+
+std::string ValidAlpha(Random& random) {
+  std::string packet;
+  for (char key = 'A'; key <= 'G'; key++) packet += key + std::to_string(random.Below(1024));
+  if (random.Below(2)) packet += 'J';
+  return packet + "\n";
+}
+
+std::string NoTerminators(size_t size) {
+  std::string stream;
+  Random random(1);
+  while (stream.size() < size) stream += ValidAlpha(random).substr(0, 20);
+  return stream;
+}
+
+std::string HugeNumbers(size_t size) {
+  std::string stream;
+  Random random(2);
+  while (stream.size() < size) {
+    // just under the frame limit, far over it, and the same for the legacy format
+    const size_t digits = random.Below(2) ? c_maxFrameSize - 8 : 20 * c_maxFrameSize;
+    if (random.Below(2)) stream += 'A';
+    stream.append(digits, '9');
+    stream += "&9\n";
+  }
+  return stream;
+}
+
+std::string RepeatedKeys(size_t size) {
+  std::string stream;
+  Random random(3);
+  while (stream.size() < size) {
+    const size_t repeats = random.Below(2) ? 150 : 2000;
+    std::string line;
+    for (size_t i = 0; i < repeats; i++) line += random.Below(2) ? "A1" : "JB";
+    stream += line + "\n";
+  }
+  return stream;
+}
+
+std::string BinaryGarbage(size_t size) {
+  std::string stream(size, '\0');
+  Random random(4);
+  for (char& byte : stream) {
+    byte = static_cast<char>(random.Below(256));
+    if (byte == '\n' && random.Below(4) != 0) byte = 'A';
+  }
+  return stream;
+}
+
+std::string Mixed(size_t size) {
+  std::string stream;
+  Random random(5);
+  while (stream.size() < size) {
+    switch (random.Below(4)) {
+      case 0:
+        stream += BinaryGarbage(random.Below(3000));
+        break;
+      case 1:
+        stream += std::string(random.Below(2 * c_maxFrameSize), '7');
+        break;
+      default:
+        stream += ValidAlpha(random);
+        break;
+    }
+  }
+  return stream;
+}
+
+struct Stream {
+  const char* name;
+  std::string bytes;
+};
+
+std::vector<Stream> AdversarialStreams() {
+  const size_t size = 1 << 20;
+  return {{"no terminators", NoTerminators(size)},
+          {"huge numbers", HugeNumbers(size)},
+          {"repeated keys", RepeatedKeys(size)},
+          {"binary garbage", BinaryGarbage(size)},
+          {"mixed", Mixed(size)}};
+}
+
+// Frames the stream in reads of random size, the way a transport would.
+template <typename OnFrame>
+void FrameStream(FrameBuffer& buffer, std::string_view stream, uint32_t seed, OnFrame&& onFrame) {
+  Random random(seed);
+  while (!stream.empty()) {
+    const size_t bytes = std::min<size_t>(
+        {1 + random.Below(4096), stream.size(), buffer.WritableBytes()});
+    std::memcpy(buffer.WritePtr(), stream.data(), bytes);
+    buffer.Commit(bytes);
+    stream.remove_prefix(bytes);
+
+    std::string_view frame;
+    while (buffer.NextFrame(frame)) onFrame(frame);
+  }
+}
+
+// A decoded frame must come out in range whatever went in.
+bool Sane(const VRCommData_t& data) {
+  const VRCommData_t unpacked = UnpackSample(PackSample(data, 0, 0));
+  for (int i = 0; i < 5; i++) {
+    if (!(unpacked.flexion[i] >= 0.f && unpacked.flexion[i] <= 1.f)) return false;
+    if (!(unpacked.splay[i] >= 0.f && unpacked.splay[i] <= 1.f)) return false;
+  }
+  return std::abs(unpacked.joyX) <= 1.f && std::abs(unpacked.joyY) <= 1.f;
+}
+
+// Runs the stream through a pipeline's reader and decoder threads and collects what the decoder
+// gets.
+std::vector<std::string> Pipe(std::string_view stream, VRBackpressurePolicy policy, uint32_t seed) {
+  FramePipeline pipeline(8192, policy);
+  std::vector<std::string> frames;
+  std::atomic<uint64_t> decoded{0};
+
+  std::thread decoder([&]() {
+    std::string_view frame;
+    while (pipeline.NextFrame(frame)) {
+      frames.emplace_back(frame);
+      pipeline.Release();
+      decoded++;
+    }
+  });
+
+  Random random(seed);
+  while (!stream.empty()) {
+    size_t room = 0;
+    char* writePtr = pipeline.PrepareWrite(room);
+    if (writePtr == nullptr) break;
+
+    const size_t bytes = std::min<size_t>({1 + random.Below(4096), stream.size(), room});
+    std::memcpy(writePtr, stream.data(), bytes);
+    pipeline.Commit(bytes);
+    stream.remove_prefix(bytes);
+  }
+
+  // Stop() ends the decoder even with frames still queued
+  while (decoded < pipeline.Stats().framesPublished) std::this_thread::yield();
+  pipeline.Stop();
+  decoder.join();
+
+  return frames;
+}
+}  // namespace
+
+TEST(DecoderFuzz, FramingAndDecodingStayLinear) {
+  for (const Stream& stream : AdversarialStreams()) {
+    FrameBuffer buffer;
+    AlphaEncodingManager alpha(1023.f);
+    LegacyEncodingManager legacy(1023.f);
+
+    size_t frames = 0;
+    size_t frameBytes = 0;
+    size_t rejected = 0;
+    bool framesBounded = true;
+    bool decodedSane = true;
+
+    const int64_t liveBefore = g_liveBytes.load();
+    g_peakBytes = liveBefore;
+    const auto start = std::chrono::steady_clock::now();
+
+    FrameStream(buffer, stream.bytes, 42, [&](std::string_view frame) {
+      frames++;
+      frameBytes += frame.size();
+      framesBounded &= frame.size() <= c_maxFrameSize && frame.back() == '\n';
+
+      for (IEncodingManager* decoder : {static_cast<IEncodingManager*>(&alpha),
+                                        static_cast<IEncodingManager*>(&legacy)}) {
+        try {
+          decodedSane &= Sane(decoder->Decode(frame));
+        } catch (const std::invalid_argument&) {
+          rejected++;
+        }
+      }
+    });
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double nsPerByte =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+        static_cast<double>(stream.bytes.size());
+    const int64_t peakGrowth = g_peakBytes.load() - liveBefore;
+
+    std::printf("  %-16s %7zu frames %7zu rejected %9llu dropped %6.1f ns/byte %6lld peak bytes\n",
+                stream.name, frames, rejected,
+                static_cast<unsigned long long>(buffer.DroppedBytes()), nsPerByte,
+                static_cast<long long>(peakGrowth));
+
+    CHECK(framesBounded);
+    CHECK(decodedSane);
+    // every byte is handed out in a frame, dropped, or still waiting for its terminator
+    CHECK(frameBytes + buffer.DroppedBytes() <= stream.bytes.size());
+    CHECK(stream.bytes.size() - frameBytes - buffer.DroppedBytes() <= c_maxFrameSize);
+    CHECK(nsPerByte < c_maxNsPerByte);
+    CHECK(peakGrowth < c_maxPeakBytes);
+  }
+}
+
+TEST(DecoderFuzz, DecodersCostAtMostOnePassPerFrame) {
+  AlphaEncodingManager alpha(1023.f);
+  LegacyEncodingManager legacy(1023.f);
+
+  // the worst a frame under the limit can do: every byte a key, or one long number
+  std::string keys;
+  while (keys.size() + 2 < c_maxFrameSize) keys += "A1";
+  keys += "\n";
+  const std::string number = "A" + std::string(c_maxFrameSize - 2, '9');
+  const std::string fields = [] {
+    std::string line;
+    while (line.size() + 2 < c_maxFrameSize) line += "9&";
+    return line + "\n";
+  }();
+
+  for (const std::string& frame : {keys, number, fields}) {
+    const int repeats = 2000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+      for (IEncodingManager* decoder : {static_cast<IEncodingManager*>(&alpha),
+                                        static_cast<IEncodingManager*>(&legacy)}) {
+        try {
+          VRCommData_t data = decoder->Decode(frame);
+          CHECK(Sane(data));
+        } catch (const std::invalid_argument&) {
+        }
+      }
+    }
+    const double nsPerByte =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count()) /
+        (2.0 * repeats * frame.size());
+    CHECK(nsPerByte < c_maxNsPerByte);
+  }
+}
+
+TEST(DecoderFuzz, HugeValuesSaturateInsteadOfWrapping) {
+  AlphaEncodingManager alpha(1023.f);
+
+  // a finger bent past any ADC range reads as fully bent, the joystick pinned to its corner
+  const VRCommData_t bent = alpha.Decode("A" + std::string(60, '9') + "F" + std::string(60, '9') +
+                                         "G-" + std::string(60, '9') + "\n");
+  const VRCommData_t unpacked = UnpackSample(PackSample(bent, 0, 0));
+  CHECK_NEAR(unpacked.flexion[0], 1.0, 1e-6);
+  CHECK_NEAR(unpacked.joyX, 1.0, 1e-4);
+  CHECK_NEAR(unpacked.joyY, -1.0, 1e-4);
+}
+
+TEST(DecoderFuzz, PipelineFramesLikeTheBuffer) {
+  for (const Stream& stream : AdversarialStreams()) {
+    std::vector<std::string> expected;
+    FrameBuffer buffer;
+    FrameStream(buffer, stream.bytes, 7,
+                [&](std::string_view frame) { expected.emplace_back(frame); });
+
+    // blocking, nothing is lost and the frames are exactly the ones the buffer finds
+    const std::vector<std::string> blocked = Pipe(stream.bytes, BACKPRESSURE_BLOCK, 7);
+    CHECK_EQ(blocked.size(), expected.size());
+    CHECK(blocked == expected);
+
+    // dropping, whole frames can go missing but nothing else changes
+    const std::vector<std::string> dropped = Pipe(stream.bytes, BACKPRESSURE_DROP, 9);
+    size_t next = 0;
+    bool subsequence = true;
+    for (const std::string& frame : dropped) {
+      while (next < expected.size() && expected[next] != frame) next++;
+      subsequence &= next < expected.size();
+      next++;
+    }
+    CHECK(subsequence);
+  }
+}
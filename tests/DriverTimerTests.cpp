@@ -0,0 +1,49 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Clock.h"
+#include "DriverTimer.h"
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+TEST(DriverTimer, ExpiresOnSimulatedTime) {
+  auto owned = std::make_unique<SimulatedClock>();
+  SimulatedClock& clock = *owned;
+  SetDriverClock(std::move(owned));
+
+  asio::io_context context;
+  DriverTimer timer(context);
+  std::atomic<bool> fired{false};
+
+  timer.expires_after(1h);
+  timer.async_wait([&](const asio::error_code& ec) { fired = !ec; });
+  std::thread reactor([&]() { context.run(); });
+
+  // an hour of simulated time hasn't passed, however long the reactor waits for real
+  std::this_thread::sleep_for(50ms);
+  CHECK(!fired);
+
+  clock.AdvanceBy(1h);
+  const auto giveUp = std::chrono::steady_clock::now() + 5s;
+  while (!fired && std::chrono::steady_clock::now() < giveUp) std::this_thread::yield();
+  CHECK(fired);
+
+  reactor.join();
+  SetDriverClock(nullptr);
+}
+
+TEST(DriverTimer, FollowsTheSystemClock) {
+  asio::io_context context;
+  DriverTimer timer(context);
+  bool fired = false;
+
+  const DriverTimePoint start = DriverClock().Now();
+  timer.expires_after(20ms);
+  timer.async_wait([&](const asio::error_code& ec) { fired = !ec; });
+  context.run();
+
+  CHECK(fired);
+  CHECK(DriverClock().Now() - start >= DriverDuration(20ms));
+}
@@ -0,0 +1,116 @@
+#include <limits>
+#include <stdexcept>
+
+#include "Encode/AlphaEncodingManager.h"
+#include "Encode/AnalogValue.h"
+#include "Encode/LegacyEncodingManager.h"
+#include "Encode/PackedSample.h"
+#include "Test.h"
+
+TEST(Encoding, AlphaDecodesEveryKey) {
+  AlphaEncodingManager encoding(1023.f);
+  const VRCommData_t data = encoding.Decode("A0B1023C511.5D100E200F1023G0HIJKLMO\n");
+
+  CHECK_NEAR(data.flexion[0], 0.f, 1e-6);
+  CHECK_NEAR(data.flexion[1], 1.f, 1e-6);
+  CHECK_NEAR(data.flexion[2], 511.5f / 1023.f, 1e-6);
+  CHECK_NEAR(data.flexion[3], 100.f / 1023.f, 1e-6);
+  CHECK_NEAR(data.flexion[4], 200.f / 1023.f, 1e-6);
+  CHECK_NEAR(data.joyX, 1.f, 1e-6);
+  CHECK_NEAR(data.joyY, -1.f, 1e-6);
+  CHECK(data.joyButton && data.trgButton && data.aButton && data.bButton);
+  CHECK(data.grab && data.pinch && data.calibrate);
+}
+
+TEST(Encoding, AlphaLeavesMissingFingersUnset) {
+  AlphaEncodingManager encoding(1023.f);
+  const VRCommData_t data = encoding.Decode("C512\n");
+
+  CHECK_EQ(data.flexion[0], -1.f);
+  CHECK_NEAR(data.flexion[2], 512.f / 1023.f, 1e-6);
+  CHECK_EQ(data.joyX, 0.f);
+  CHECK(!data.aButton);
+}
+
+TEST(Encoding, AlphaRejectsKeyWithoutValue) {
+  AlphaEncodingManager encoding(1023.f);
+  bool threw = false;
+  try {
+    encoding.Decode("A\n");
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+TEST(Encoding, LegacyDecodesFields) {
+  LegacyEncodingManager encoding(1023.f);
+  const VRCommData_t data = encoding.Decode("0&1023&511&100&200&1023&0&1&0&1&0&1&0\n");
+
+  CHECK_NEAR(data.flexion[0], 0.f, 1e-6);
+  CHECK_NEAR(data.flexion[1], 1.f, 1e-6);
+  CHECK_NEAR(data.flexion[2], 511.f / 1023.f, 1e-6);
+  CHECK_NEAR(data.joyX, 1.f, 1e-6);
+  CHECK_NEAR(data.joyY, -1.f, 1e-6);
+  CHECK(data.joyButton && !data.trgButton && data.aButton && !data.bButton);
+  CHECK(data.grab && !data.pinch);
+}
+
+TEST(Encoding, ParseAnalogValueStopsAtTheFirstOtherCharacter) {
+  float value = 7.f;
+  CHECK_EQ(ParseAnalogValue("  -12.5B3", value), 7u);
+  CHECK_EQ(value, -12.5f);
+
+  value = 7.f;
+  CHECK_EQ(ParseAnalogValue("B", value), 0u);
+  CHECK_EQ(value, 7.f);
+
+  CHECK(ParseAnalogValue("99999999999999999999", value) > 0);
+  CHECK_EQ(value, c_maxAnalogMagnitude);
+}
+
+TEST(Encoding, PackedSampleRoundTrips) {
+  const VRCommData_t data({0.f, 0.25f, 0.5f, 0.75f, 1.f}, {0.1f, 0.2f, 0.3f, 0.4f, 0.5f}, -0.5f,
+                          0.75f, true, false, true, false, true, false, true);
+  const PackedSample sample = PackSample(data, 42, 1234);
+  const VRCommData_t unpacked = UnpackSample(sample);
+
+  CHECK_EQ(sample.sequence, 42u);
+  CHECK_EQ(sample.timeNs, 1234);
+  for (size_t i = 0; i < 5; i++) {
+    CHECK_NEAR(unpacked.flexion[i], data.flexion[i], 1.f / 65535);
+    CHECK_NEAR(unpacked.splay[i], data.splay[i], 1.f / 65535);
+  }
+  CHECK_NEAR(unpacked.joyX, data.joyX, 1.f / 32767);
+  CHECK_NEAR(unpacked.joyY, data.joyY, 1.f / 32767);
+  CHECK(unpacked.joyButton && !unpacked.trgButton && unpacked.aButton && !unpacked.bButton);
+  CHECK(unpacked.grab && !unpacked.pinch && unpacked.calibrate);
+}
+
+TEST(Encoding, PackedSampleClampsBeforeConverting) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  // a saturated analog value over a small maximum is far past what an int32 can hold
+  const VRCommData_t data({c_maxAnalogMagnitude / 1023.f, -c_maxAnalogMagnitude, nan, inf, -inf},
+                          {1.5f, -0.5f, 0.f, 1.f, nan}, nan, inf, false, false, false, false,
+                          false, false, false);
+  const PackedSample sample = PackSample(data, 0, 0);
+
+  CHECK_EQ(sample.flexion[0], 65535);
+  CHECK_EQ(sample.flexion[1], 0);
+  CHECK_EQ(sample.flexion[2], 0);
+  CHECK_EQ(sample.flexion[3], 65535);
+  CHECK_EQ(sample.flexion[4], 0);
+  CHECK_EQ(sample.splay[0], 65535);
+  CHECK_EQ(sample.splay[1], 0);
+  CHECK_EQ(sample.splay[3], 65535);
+  CHECK_EQ(sample.splay[4], 0);
+  CHECK_EQ(sample.joyX, 0);
+  CHECK_EQ(sample.joyY, 32767);
+}
+
+TEST(Encoding, SaturatedFingerPacksAsBent) {
+  AlphaEncodingManager encoding(1023.f);
+  const PackedSample sample = PackSample(encoding.Decode("A99999999999999\n"), 0, 0);
+  CHECK_EQ(sample.flexion[0], 65535);
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Communication/FrameBuffer.h"
+#include "Test.h"
+
+namespace {
+// Feeds text through the buffer in reads of at most chunk bytes, the way a transport would, and
+// collects every frame that comes out.
+std::vector<std::string> Frame(FrameBuffer& buffer, std::string_view text, size_t chunk) {
+  std::vector<std::string> frames;
+  while (!text.empty()) {
+    const size_t bytes = std::min({chunk, text.size(), buffer.WritableBytes()});
+    std::memcpy(buffer.WritePtr(), text.data(), bytes);
+    buffer.Commit(bytes);
+    text.remove_prefix(bytes);
+
+    std::string_view frame;
+    while (buffer.NextFrame(frame)) frames.emplace_back(frame);
+  }
+  return frames;
+}
+
+std::string Packet(int i) {
+  char packet[32];
+  std::snprintf(packet, sizeof(packet), "A%dB%d\n", i, i * 7);
+  return packet;
+}
+}  // namespace
+
+TEST(FrameBuffer, SplitsOnTerminators) {
+  FrameBuffer buffer(64, 32);
+  const std::vector<std::string> frames = Frame(buffer, "A1B2\nC3\n\nD4", 64);
+
+  REQUIRE(frames.size() == 3);
+  CHECK_EQ(frames[0], "A1B2\n");
+  CHECK_EQ(frames[1], "C3\n");
+  CHECK_EQ(frames[2], "\n");
+}
+
+TEST(FrameBuffer, ReassemblesFramesAcrossReads) {
+  FrameBuffer buffer(64, 32);
+  std::string text;
+  for (int i = 0; i < 100; i++) text += Packet(i);
+
+  // every read size, so frames straddle reads and compactions at every offset
+  for (size_t chunk = 1; chunk <= 17; chunk++) {
+    buffer.Clear();
+    const std::vector<std::string> frames = Frame(buffer, text, chunk);
+
+    REQUIRE(frames.size() == 100);
+    for (int i = 0; i < 100; i++) CHECK_EQ(frames[i], Packet(i));
+  }
+}
+
+TEST(FrameBuffer, DropsOversizedFramesAndRecovers) {
+  FrameBuffer buffer(64, 16);
+  const std::string text = "A1\n" + std::string(200, 'x') + "\nB2\n";
+  const std::vector<std::string> frames = Frame(buffer, text, 7);
+
+  REQUIRE(frames.size() == 2);
+  CHECK_EQ(frames[0], "A1\n");
+  CHECK_EQ(frames[1], "B2\n");
+  CHECK_EQ(buffer.OversizedFrames(), 1u);
+  CHECK_EQ(buffer.DroppedBytes(), 201u);
+}
+
+TEST(FrameBuffer, BatchesFrames) {
+  FrameBuffer buffer(64, 32);
+  const char text[] = "A\nB\nC\n";
+  std::memcpy(buffer.WritePtr(), text, sizeof(text) - 1);
+  buffer.Commit(sizeof(text) - 1);
+
+  std::string_view frames[2];
+  CHECK_EQ(buffer.NextFrames(frames, 2), 2u);
+  CHECK_EQ(frames[0], "A\n");
+  CHECK_EQ(frames[1], "B\n");
+  CHECK_EQ(buffer.NextFrames(frames, 2), 1u);
+  CHECK_EQ(frames[0], "C\n");
+  CHECK_EQ(buffer.NextFrames(frames, 2), 0u);
+}
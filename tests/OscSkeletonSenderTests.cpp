@@ -0,0 +1,246 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DeviceControl.h"
+#include "Encode/PackedSample.h"
+#include "Output/OscSkeletonSender.h"
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+// One OSC message as the receiver sees it, float arguments only apart from a leading string.
+struct OscMessage {
+  std::string address;
+  std::string typeTags;
+  std::string name;
+  std::vector<float> values;
+};
+
+class OscReader {
+ public:
+  OscReader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+  bool ReadBundle(std::vector<OscMessage>& messages) {
+    if (ReadString() != "#bundle") return false;
+    m_position += 8;  // time tag
+
+    while (m_ok && m_position < m_size) {
+      const size_t end = m_position + 4 + ReadUint32();
+      OscMessage message;
+      message.address = ReadString();
+      message.typeTags = ReadString();
+      for (char tag : message.typeTags.substr(1)) {
+        if (tag == 's') message.name = ReadString();
+        if (tag == 'f') {
+          const uint32_t bits = ReadUint32();
+          float value;
+          std::memcpy(&value, &bits, sizeof(value));
+          message.values.push_back(value);
+        }
+        if (tag == 'i') message.values.push_back(static_cast<float>(ReadUint32()));
+      }
+      m_ok &= m_position == end;
+      messages.push_back(message);
+    }
+    return m_ok && m_position == m_size;
+  }
+
+ private:
+  std::string ReadString() {
+    const size_t length = strnlen(m_data + m_position, m_size - m_position);
+    std::string value(m_data + m_position, length);
+    m_position += (length + 4) & ~size_t(3);
+    m_ok &= m_position <= m_size;
+    return value;
+  }
+
+  uint32_t ReadUint32() {
+    if (m_position + 4 > m_size) {
+      m_ok = false;
+      return 0;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(m_data + m_position);
+    m_position += 4;
+    return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) |
+           uint32_t(bytes[3]);
+  }
+
+  const char* m_data;
+  size_t m_size;
+  size_t m_position = 0;
+  bool m_ok = true;
+};
+
+// A VMC receiver on an ephemeral localhost port.
+class Receiver {
+ public:
+  Receiver() : m_socket(m_context, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0)) {
+    m_socket.non_blocking(true);
+  }
+
+  uint16_t Port() const { return m_socket.local_endpoint().port(); }
+
+  // Waits up to timeout for the next datagram, returns its size or 0.
+  size_t Receive(std::chrono::steady_clock::duration timeout) {
+    const auto giveUp = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < giveUp) {
+      asio::error_code ec;
+      asio::ip::udp::endpoint sender;
+      const size_t size = m_socket.receive_from(asio::buffer(m_datagram), sender, 0, ec);
+      if (!ec) return size;
+      std::this_thread::sleep_for(200us);
+    }
+    return 0;
+  }
+
+  const char* Datagram() const { return m_datagram.data(); }
+
+ private:
+  asio::io_context m_context;
+  asio::ip::udp::socket m_socket;
+  std::array<char, 65536> m_datagram;
+};
+
+std::shared_ptr<DeviceControl> Hand(float flexion, float boneOffset) {
+  auto control = std::make_shared<DeviceControl>(VRInputTuning_t(), std::string());
+  control->Counters().connected = true;
+
+  VRCommData_t data = UnpackSample(PackedSample{});
+  for (float& finger : data.flexion) finger = flexion;
+  control->PublishSample(PackSample(data, 0, 0));
+
+  vr::VRBoneTransform_t bones[NUM_BONES] = {};
+  for (int i = 0; i < NUM_BONES; i++) {
+    bones[i].position = {{boneOffset + i, 2.f * i, 3.f * i, 1.f}};
+    bones[i].orientation = {0.5f, 0.1f * i, 0.2f, 0.3f};
+  }
+  control->PublishSkeleton(bones);
+  return control;
+}
+
+void Republish(DeviceControl& control) {
+  HandSkeleton skeleton = control.Skeleton().Load();
+  control.PublishSkeleton(skeleton.bones);
+}
+}  // namespace
+
+TEST(OscSkeletonSender, SendsBothHandsInOneBundle) {
+  Receiver receiver;
+  auto left = Hand(0.25f, 100.f);
+  auto right = Hand(0.75f, 200.f);
+  OscSkeletonSender sender("127.0.0.1", receiver.Port(), 60.f);
+  sender.AddDevice(left, false);
+  sender.AddDevice(right, true);
+  REQUIRE(sender.Start());
+
+  // only changes are sent, and every datagram carries both hands whichever one changed
+  Republish(*left);
+  const size_t size = receiver.Receive(2s);
+  REQUIRE(size > 0);
+  sender.Stop();
+
+  std::vector<OscMessage> messages;
+  REQUIRE(OscReader(receiver.Datagram(), size).ReadBundle(messages));
+
+  // OK, time, then per hand 15 bones and the curls
+  REQUIRE(messages.size() == 2 + 2 * 16);
+  CHECK(messages[0].address == "/VMC/Ext/OK");
+  CHECK(messages[1].address == "/VMC/Ext/T");
+
+  for (int hand = 0; hand < 2; hand++) {
+    const OscMessage* bones = &messages[2 + hand * 16];
+    const float offset = hand == 0 ? 100.f : 200.f;
+
+    CHECK(bones[0].address == "/VMC/Ext/Bone/Pos");
+    CHECK(bones[0].name == (hand == 0 ? "LeftThumbProximal" : "RightThumbProximal"));
+    CHECK(bones[14].name == (hand == 0 ? "LeftLittleDistal" : "RightLittleDistal"));
+
+    // the index proximal phalanx, with z flipped into Unity's axes
+    const OscMessage& index = bones[3];
+    REQUIRE(index.values.size() == 7u);
+    CHECK(index.name == (hand == 0 ? "LeftIndexProximal" : "RightIndexProximal"));
+    const float joint = static_cast<float>(eBone_IndexFinger1);
+    CHECK_NEAR(index.values[0], offset + joint, 1e-4);
+    CHECK_NEAR(index.values[1], 2.f * joint, 1e-4);
+    CHECK_NEAR(index.values[2], -3.f * joint, 1e-4);
+    CHECK_NEAR(index.values[3], -0.1f * joint, 1e-4);
+    CHECK_NEAR(index.values[4], -0.2f, 1e-6);
+    CHECK_NEAR(index.values[5], 0.3f, 1e-6);
+    CHECK_NEAR(index.values[6], 0.5f, 1e-6);
+
+    const OscMessage& curl = bones[15];
+    CHECK(curl.address == (hand == 0 ? "/openglove/left/curl" : "/openglove/right/curl"));
+    REQUIRE(curl.values.size() == 5u);
+    for (float value : curl.values) CHECK_NEAR(value, hand == 0 ? 0.25 : 0.75, 1e-3);
+  }
+}
+
+TEST(OscSkeletonSender, KeepsToItsRateUnderConstantChange) {
+  Receiver receiver;
+  auto left = Hand(0.f, 0.f);
+  auto right = Hand(1.f, 0.f);
+
+  const float rateHz = 100.f;
+  OscSkeletonSender sender("127.0.0.1", receiver.Port(), rateHz);
+  sender.AddDevice(left, false);
+  sender.AddDevice(right, true);
+
+  // a skeleton update every millisecond, ten times what the sender is allowed to pass on
+  std::atomic<bool> publishing{true};
+  std::thread skeletonLoop([&]() {
+    while (publishing) {
+      Republish(*left);
+      Republish(*right);
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+  REQUIRE(sender.Start());
+
+  const std::chrono::milliseconds window = 1s;
+  const auto start = std::chrono::steady_clock::now();
+  int datagrams = 0;
+  bool complete = true;
+  while (std::chrono::steady_clock::now() - start < window) {
+    const size_t size = receiver.Receive(window / 4);
+    if (size == 0) continue;
+
+    std::vector<OscMessage> messages;
+    complete &= OscReader(receiver.Datagram(), size).ReadBundle(messages);
+    complete &= messages.size() == 2 + 2 * 16;
+    datagrams++;
+  }
+
+  publishing = false;
+  skeletonLoop.join();
+  sender.Stop();
+
+  // one datagram per tick holding both hands, never more than the rate; a loaded machine may
+  // miss ticks
+  CHECK(complete);
+  CHECK(datagrams <= static_cast<int>(rateHz * 1.1f) + 1);
+  CHECK(datagrams >= static_cast<int>(rateHz / 2));
+}
+
+TEST(OscSkeletonSender, StaysQuietWithoutChanges) {
+  Receiver receiver;
+  auto hand = Hand(0.5f, 0.f);
+  OscSkeletonSender sender("127.0.0.1", receiver.Port(), 90.f);
+  sender.AddDevice(hand, true);
+  REQUIRE(sender.Start());
+
+  // well inside the keepalive period
+  CHECK_EQ(receiver.Receive(300ms), 0u);
+
+  Republish(*hand);
+  CHECK(receiver.Receive(2s) > 0);
+  CHECK_EQ(receiver.Receive(300ms), 0u);
+  sender.Stop();
+}
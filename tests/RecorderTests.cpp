@@ -0,0 +1,126 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "DeviceControl.h"
+#include "Recorder.h"
+#include "Test.h"
+
+namespace {
+// An empty directory of its own for each case, removed again afterwards.
+class TemporaryDirectory {
+ public:
+  explicit TemporaryDirectory(const char* name)
+      : m_path(std::filesystem::temp_directory_path() / "openglove_tests" / name) {
+    std::filesystem::remove_all(m_path);
+  }
+  ~TemporaryDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(m_path, error);
+  }
+
+  const std::filesystem::path& Path() const { return m_path; }
+
+ private:
+  std::filesystem::path m_path;
+};
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string Command(DeviceControl& control, const char* request) {
+  char response[256];
+  control.HandleRequest(request, response, sizeof(response));
+  return response;
+}
+}  // namespace
+
+TEST(Recorder, AcceptsOnlyPlainFileNames) {
+  CHECK(IsPlainFileName("capture.txt"));
+  CHECK(IsPlainFileName("left-hand_2.csv"));
+
+  CHECK(!IsPlainFileName(""));
+  CHECK(!IsPlainFileName("."));
+  CHECK(!IsPlainFileName(".."));
+  CHECK(!IsPlainFileName("..."));
+  CHECK(!IsPlainFileName(".hidden"));
+  CHECK(!IsPlainFileName("capture."));
+  CHECK(!IsPlainFileName("../capture.txt"));
+  CHECK(!IsPlainFileName("..\\capture.txt"));
+  CHECK(!IsPlainFileName("/etc/passwd"));
+  CHECK(!IsPlainFileName("C:capture.txt"));
+  CHECK(!IsPlainFileName("capture.txt:stream"));
+  CHECK(!IsPlainFileName("a b.txt"));
+  CHECK(!IsPlainFileName(std::string(200, 'a')));
+  CHECK(!IsPlainFileName("nul"));
+  CHECK(!IsPlainFileName("COM3.txt"));
+  CHECK(!IsPlainFileName("Lpt1"));
+  CHECK(IsPlainFileName("COM10.txt"));
+  CHECK(IsPlainFileName("console.txt"));
+}
+
+TEST(Recorder, WritesIntoItsDirectory) {
+  TemporaryDirectory directory("recorder_directory");
+  Recorder recorder(directory.Path().string(), RecorderContent_Frames);
+
+  CHECK(!recorder.Start("../escaped.txt"));
+  CHECK(!std::filesystem::exists(directory.Path().parent_path() / "escaped.txt"));
+
+  REQUIRE(recorder.Start("frames.txt"));
+  recorder.RecordFrame("A1B2\n");
+  recorder.Stop();
+
+  const std::string contents = ReadFile(directory.Path() / "frames.txt");
+  CHECK(contents.size() > 5);
+  CHECK(contents.find(" A1B2\n") != std::string::npos);
+  CHECK_EQ(recorder.Written(), 1u);
+}
+
+TEST(Recorder, KeepsWholeFrames) {
+  TemporaryDirectory directory("recorder_frames");
+  Recorder recorder(directory.Path().string(), RecorderContent_Frames);
+
+  // as long as framing lets through, terminator included
+  const std::string frame = std::string(c_maxFrameSize - 1, 'x') + "\n";
+  REQUIRE(recorder.Start("frames.txt"));
+  recorder.RecordFrame(frame);
+  recorder.Stop();
+
+  const std::string contents = ReadFile(directory.Path() / "frames.txt");
+  CHECK(contents.find(frame) != std::string::npos);
+}
+
+TEST(Recorder, ControlPlaneRefusesPaths) {
+  TemporaryDirectory directory("recorder_control");
+  DeviceControl control(VRInputTuning_t(), directory.Path().string());
+
+  CHECK_EQ(Command(control, "record start ../../escaped.txt").rfind("error:", 0), 0u);
+  CHECK_EQ(Command(control, "capture start /tmp/escaped.txt").rfind("error:", 0), 0u);
+  CHECK(!std::filesystem::exists(directory.Path()));
+
+  CHECK_EQ(Command(control, "capture start capture.txt"), "ok");
+  control.Capture().RecordFrame("A1\n");
+  CHECK_EQ(Command(control, "capture stop").rfind("ok written=1", 0), 0u);
+  CHECK(std::filesystem::exists(directory.Path() / "capture.txt"));
+}
+
+TEST(Recorder, RecordsOnlyItsOwnContent) {
+  TemporaryDirectory directory("recorder_samples");
+  Recorder recorder(directory.Path().string(), RecorderContent_Samples);
+
+  VRCommData_t data = UnpackSample(PackedSample{});
+  data.flexion[1] = 0.5f;
+  REQUIRE(recorder.Start("samples.csv"));
+  recorder.RecordSample(PackSample(data, 42, 0));
+  recorder.RecordFrame("A1\n");
+  recorder.Stop();
+
+  const std::string contents = ReadFile(directory.Path() / "samples.csv");
+  CHECK(contents.find(",42,0.0000,0.5000,") != std::string::npos);
+  CHECK(contents.find("A1") == std::string::npos);
+  CHECK_EQ(recorder.Written(), 1u);
+  CHECK_EQ(recorder.Dropped(), 0u);
+}
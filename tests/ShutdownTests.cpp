@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "Communication/FramePipeline.h"
+#include "Communication/PluginCommunicationManager.h"
+#include "Encode/AlphaEncodingManager.h"
+#include "LateLatchScheduler.h"
+#include "Recorder.h"
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * Every thread the driver starts has to be stoppable in bounded time, whatever it is doing at the
+ * time: flat out on a glove streaming as fast as it can, or parked waiting for one that never sends.
+ **/
+namespace {
+// SteamVR gives a driver a few seconds to unload. Each stop here should take well under a
+// millisecond; the slack is for loaded CI machines, not for anything the threads do.
+constexpr auto c_maxStopTime = 250ms;
+// what PluginCommunicationManager waits at most in one read
+constexpr auto c_pluginReadTimeout = 100ms;
+
+template <typename Fn>
+std::chrono::steady_clock::duration TimeOf(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::steady_clock::now() - start;
+}
+
+// A transport plugin the test drives. Read streams packets with no pause, blocks until it is
+// interrupted ignoring its timeout the way a careless plugin might, or sits out its timeout idle.
+struct FakeTransport {
+  enum class Mode { STREAM, BLOCK_UNTIL_INTERRUPTED, IDLE };
+
+  static Mode s_mode;
+  static std::mutex s_mutex;
+  static std::condition_variable s_wake;
+  static bool s_interrupted;
+  static std::atomic<int> s_reading;
+
+  static void* Open(const char*) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_interrupted = false;
+    return &s_mode;
+  }
+  static void Close(void*) {}
+
+  static int32_t Read(void*, char* buffer, uint32_t capacity, uint32_t timeoutMs) {
+    s_reading++;
+    int32_t result = 0;
+    switch (s_mode) {
+      case Mode::STREAM: {
+        constexpr std::string_view c_packet = "A512B512C512D512E512F512G512\n";
+        while (result + c_packet.size() <= capacity) {
+          std::memcpy(buffer + result, c_packet.data(), c_packet.size());
+          result += static_cast<int32_t>(c_packet.size());
+        }
+        break;
+      }
+      case Mode::BLOCK_UNTIL_INTERRUPTED: {
+        // capped so a broken Interrupt fails the test instead of hanging it
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_wake.wait_for(lock, 10s, []() { return s_interrupted; });
+        break;
+      }
+      case Mode::IDLE:
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        break;
+    }
+    s_reading--;
+    return result;
+  }
+
+  static void Interrupt(void*) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_interrupted = true;
+    s_wake.notify_all();
+  }
+};
+
+FakeTransport::Mode FakeTransport::s_mode = FakeTransport::Mode::STREAM;
+std::mutex FakeTransport::s_mutex;
+std::condition_variable FakeTransport::s_wake;
+bool FakeTransport::s_interrupted = false;
+std::atomic<int> FakeTransport::s_reading{0};
+
+OpengloveTransportApi FakeTransportApi(bool interruptible) {
+  return {sizeof(OpengloveTransportApi),
+          "fake",
+          &FakeTransport::Open,
+          &FakeTransport::Close,
+          &FakeTransport::Read,
+          interruptible ? &FakeTransport::Interrupt : nullptr};
+}
+
+// Starts a listener on the fake transport, lets it run, and returns how long Disconnect() took.
+std::chrono::steady_clock::duration StopPluginListener(FakeTransport::Mode mode, bool interruptible,
+                                                       std::atomic<uint64_t>& samples) {
+  FakeTransport::s_mode = mode;
+  const OpengloveTransportApi api = FakeTransportApi(interruptible);
+
+  PluginCommunicationManager manager(&api, "", std::make_unique<AlphaEncodingManager>(1023.f));
+  manager.Connect();
+  manager.BeginListener([&](const PackedSample&) { samples++; });
+
+  // wait until the listener is inside a read, then give it time to settle into it
+  const auto giveUp = std::chrono::steady_clock::now() + 5s;
+  while (FakeTransport::s_reading == 0 && std::chrono::steady_clock::now() < giveUp)
+    std::this_thread::yield();
+  std::this_thread::sleep_for(50ms);
+
+  return TimeOf([&]() { manager.Disconnect(); });
+}
+}  // namespace
+
+TEST(Shutdown, PluginListenerStopsUnderLoad) {
+  std::atomic<uint64_t> samples{0};
+  const auto stopTime = StopPluginListener(FakeTransport::Mode::STREAM, true, samples);
+
+  CHECK(samples > 0);
+  CHECK(stopTime < c_maxStopTime);
+}
+
+TEST(Shutdown, PluginListenerInterruptsABlockedRead) {
+  std::atomic<uint64_t> samples{0};
+  const auto stopTime =
+      StopPluginListener(FakeTransport::Mode::BLOCK_UNTIL_INTERRUPTED, true, samples);
+
+  CHECK(stopTime < c_maxStopTime);
+  CHECK_EQ(FakeTransport::s_reading.load(), 0);
+}
+
+TEST(Shutdown, PluginListenerWithoutInterruptStopsWithinTheReadTimeout) {
+  std::atomic<uint64_t> samples{0};
+  const auto stopTime = StopPluginListener(FakeTransport::Mode::IDLE, false, samples);
+
+  CHECK(stopTime < c_pluginReadTimeout + c_maxStopTime);
+}
+
+TEST(Shutdown, PipelineStopWakesBothSides) {
+  // blocking backpressure with a stuck decoder: the reader waits for ring space
+  FramePipeline pipeline(4096, BACKPRESSURE_BLOCK, 64);
+  std::atomic<bool> readerDone{false};
+  std::atomic<bool> holding{false};
+
+  std::thread reader([&]() {
+    size_t room = 0;
+    char* writePtr;
+    while ((writePtr = pipeline.PrepareWrite(room)) != nullptr) {
+      std::memset(writePtr, 'A', room);
+      for (size_t i = 31; i < room; i += 32) writePtr[i] = '\n';
+      pipeline.Commit(room);
+    }
+    readerDone = true;
+  });
+
+  // takes every frame and never releases one, so the reader fills the ring and blocks, and the
+  // decoder ends up waiting for frames that cannot come
+  std::thread decoder([&]() {
+    std::string_view frame;
+    while (pipeline.NextFrame(frame)) holding = true;
+  });
+
+  const auto giveUp = std::chrono::steady_clock::now() + 5s;
+  while ((!holding || pipeline.Stats().readerStalls == 0) &&
+         std::chrono::steady_clock::now() < giveUp)
+    std::this_thread::yield();
+  REQUIRE(pipeline.Stats().readerStalls > 0);
+
+  const auto stopTime = TimeOf([&]() {
+    pipeline.Stop();
+    reader.join();
+    decoder.join();
+  });
+
+  CHECK(readerDone);
+  CHECK(stopTime < c_maxStopTime);
+}
+
+TEST(Shutdown, SchedulerStopsMidSleep) {
+  // a period SteamVR would never use, so the submit thread is asleep when Stop() comes
+  LateLatchScheduler scheduler(1h, 1ms);
+  std::atomic<int> submits{0};
+  scheduler.Start([&]() { submits++; });
+  std::this_thread::sleep_for(20ms);
+
+  CHECK(TimeOf([&]() { scheduler.Stop(); }) < c_maxStopTime);
+
+  // and again under load, submitting as fast as the schedule allows
+  LateLatchScheduler busy(100us, 50us);
+  busy.Start([&]() { submits++; });
+  std::this_thread::sleep_for(50ms);
+  CHECK(TimeOf([&]() { busy.Stop(); }) < c_maxStopTime);
+  CHECK(submits > 0);
+}
+
+TEST(Shutdown, RecorderStopsWhileBeingFlooded) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "openglove_tests" / "shutdown_recorder";
+  Recorder recorder(directory.string(), RecorderContent_Frames);
+  REQUIRE(recorder.Start("frames.txt"));
+
+  std::atomic<bool> flooding{true};
+  std::thread frameLoop([&]() {
+    while (flooding) recorder.RecordFrame("A512B512C512D512E512F512G512\n");
+  });
+  std::this_thread::sleep_for(50ms);
+
+  // Stop() drains what is queued, which is bounded by the queue, not by how much was recorded
+  const auto stopTime = TimeOf([&]() { recorder.Stop(); });
+  flooding = false;
+  frameLoop.join();
+
+  CHECK(recorder.Written() > 0);
+  CHECK(stopTime < c_maxStopTime);
+
+  std::error_code error;
+  std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,130 @@
+#include <cmath>
+
+#include "SignalGraph.h"
+#include "Test.h"
+
+namespace {
+VRCommData_t Packet(std::array<float, 5> flexion, float joyX = 0.f, float joyY = 0.f) {
+  return VRCommData_t(flexion, {0.5f, 0.5f, 0.5f, 0.5f, 0.5f}, joyX, joyY, false, false, false,
+                      false, false, false, false);
+}
+
+VRInputTuning_t JoystickDeadzone(float deadzone) {
+  VRInputTuning_t tuning;
+  tuning.joystickDeadzone = deadzone;
+  return tuning;
+}
+}  // namespace
+
+TEST(SignalGraph, DefaultTuningRunsNoStages) {
+  SignalGraph graph;
+  CHECK_EQ(graph.Stages(), 0u);
+
+  VRCommData_t data = Packet({0.1f, 0.2f, 0.3f, 0.4f, 0.5f}, 0.25f, -0.5f);
+  graph.Process(data);
+  CHECK_EQ(data.flexion[2], 0.3f);
+  CHECK_EQ(data.joyX, 0.25f);
+  CHECK_EQ(data.joyY, -0.5f);
+}
+
+TEST(SignalGraph, JoystickDeadzoneIsRadial) {
+  SignalGraph graph;
+  graph.Compile(JoystickDeadzone(0.2f));
+  CHECK_EQ(graph.Stages(), static_cast<uint32_t>(SignalStage_JoystickDeadzone));
+
+  // inside the deadzone on the diagonal, where each axis alone would be outside it
+  VRCommData_t data = Packet({}, 0.12f, 0.12f);
+  graph.Process(data);
+  CHECK_EQ(data.joyX, 0.f);
+  CHECK_EQ(data.joyY, 0.f);
+
+  // the length is remapped from [0.2, 1] to [0, 1]
+  data = Packet({}, 0.6f, 0.f);
+  graph.Process(data);
+  CHECK_NEAR(data.joyX, 0.5f, 1e-6);
+  CHECK_EQ(data.joyY, 0.f);
+
+  data = Packet({}, -0.36f, 0.48f);
+  graph.Process(data);
+  CHECK_NEAR(std::hypot(data.joyX, data.joyY), 0.5f, 1e-6);
+  CHECK_NEAR(data.joyY / data.joyX, 0.48f / -0.36f, 1e-5);
+}
+
+TEST(SignalGraph, JoystickDeadzoneNeverLeavesTheUnitCircle) {
+  SignalGraph graph;
+  graph.Compile(JoystickDeadzone(0.2f));
+
+  // a square gate reads full scale on both axes at once
+  for (float x = -1.f; x <= 1.f; x += 0.125f) {
+    for (float y = -1.f; y <= 1.f; y += 0.125f) {
+      VRCommData_t data = Packet({}, x, y);
+      graph.Process(data);
+      CHECK(std::hypot(data.joyX, data.joyY) <= 1.f + 1e-6f);
+      // the direction survives
+      CHECK_NEAR(data.joyX * y - data.joyY * x, 0.f, 1e-6);
+    }
+  }
+
+  VRCommData_t data = Packet({}, 1.f, 1.f);
+  graph.Process(data);
+  CHECK_NEAR(data.joyX, std::sqrt(0.5f), 1e-6);
+  CHECK_NEAR(data.joyY, std::sqrt(0.5f), 1e-6);
+}
+
+TEST(SignalGraph, FilterStartsFromTheFirstPacket) {
+  SignalGraph graph;
+  graph.Compile(VRInputTuning_t(0.5f));
+  CHECK_EQ(graph.Stages(), static_cast<uint32_t>(SignalStage_Filter));
+
+  VRCommData_t data = Packet({0.8f, 0.8f, 0.8f, 0.8f, 0.8f});
+  graph.Process(data);
+  CHECK_NEAR(data.flexion[0], 0.8f, 1e-6);
+
+  data = Packet({0.f, 0.f, 0.f, 0.f, 0.f});
+  graph.Process(data);
+  CHECK_NEAR(data.flexion[0], 0.4f, 1e-6);
+}
+
+TEST(SignalGraph, RangeMapDeadbandAndCurve) {
+  SignalGraph graph;
+  graph.Compile(VRInputTuning_t(0.f, 2.f, 0.5f, 0.f, 0.2f, 0.8f));
+  CHECK_EQ(graph.Stages(), static_cast<uint32_t>(SignalStage_RangeMap | SignalStage_Deadband |
+                                                  SignalStage_Curve));
+
+  // 0.65 maps to 0.75 over the range, 0.5 past the deadband, 0.25 on the curve
+  VRCommData_t data = Packet({0.65f, 0.1f, 0.9f, 0.35f, 0.5f});
+  graph.Process(data);
+  CHECK_NEAR(data.flexion[0], 0.25f, 1e-3);
+  CHECK_EQ(data.flexion[1], 0.f);
+  CHECK_NEAR(data.flexion[2], 1.f, 1e-6);
+  CHECK_EQ(data.flexion[3], 0.f);
+}
+
+TEST(SignalGraph, GesturesFollowTheFingers) {
+  VRInputTuning_t tuning;
+  tuning.grabThreshold = 0.8f;
+  tuning.pinchThreshold = 0.7f;
+  SignalGraph graph;
+  graph.Compile(tuning);
+
+  // lanes are thumb, index, middle, ring, pinky
+  VRCommData_t data = Packet({0.1f, 0.1f, 0.9f, 0.9f, 0.85f});
+  graph.Process(data);
+  CHECK(data.grab);
+  CHECK(!data.pinch);
+
+  data = Packet({0.75f, 0.8f, 0.1f, 0.1f, 0.1f});
+  graph.Process(data);
+  CHECK(!data.grab);
+  CHECK(data.pinch);
+}
+
+TEST(SignalGraph, BypassTakesStagesOut) {
+  SignalGraph graph;
+  graph.Compile(VRInputTuning_t(0.5f, 2.f));
+  graph.SetBypass(SignalStage_Filter);
+  CHECK_EQ(graph.Stages(), static_cast<uint32_t>(SignalStage_Curve));
+
+  graph.SetBypass(0);
+  CHECK_EQ(graph.Stages(), static_cast<uint32_t>(SignalStage_Filter | SignalStage_Curve));
+}
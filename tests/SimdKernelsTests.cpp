@@ -0,0 +1,180 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "Simd/SimdKernels.h"
+#include "Test.h"
+
+namespace {
+class Random {
+ public:
+  explicit Random(uint32_t seed) : m_state(seed) {}
+
+  // uniform in [low, high)
+  float Uniform(float low, float high) {
+    m_state = m_state * 1664525u + 1013904223u;
+    return low + (high - low) * static_cast<float>(m_state >> 8) / static_cast<float>(1u << 24);
+  }
+  uint32_t Below(uint32_t limit) {
+    m_state = m_state * 1664525u + 1013904223u;
+    return (m_state >> 8) % limit;
+  }
+
+ private:
+  uint32_t m_state;
+};
+
+// Variants are built without contraction and keep the reference's operation order, so they have
+// to match it bit for bit, NaN for NaN.
+bool Same(float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+bool Same(const std::vector<float>& a, const std::vector<float>& b) {
+  for (size_t i = 0; i < a.size(); i++)
+    if (!Same(a[i], b[i])) return false;
+  return true;
+}
+
+// The variants this CPU can run that are built into the binary.
+std::vector<SimdKernels> Variants() {
+  std::vector<SimdKernels> variants;
+  for (uint32_t isa = SimdIsa_Sse41; isa <= DetectSimdIsa(); isa++) {
+    const SimdKernels kernels = SimdKernelsFor(static_cast<SimdIsa>(isa));
+    if (kernels.isa == isa) variants.push_back(kernels);
+  }
+  return variants;
+}
+
+std::vector<float> Values(Random& random, size_t count, float low, float high) {
+  std::vector<float> values(count);
+  for (float& value : values) value = random.Uniform(low, high);
+  return values;
+}
+
+SignalLaneParameters RandomParameters(Random& random) {
+  SignalLaneParameters parameters;
+  parameters.rangeMin = random.Uniform(-0.2f, 0.4f);
+  parameters.rangeScale = random.Uniform(0.5f, 3.f);
+  parameters.deadband = random.Uniform(0.f, 0.3f);
+  parameters.deadbandScale = 1.f / (1.f - parameters.deadband);
+  return parameters;
+}
+
+std::vector<float> CurveTable(Random& random) {
+  std::vector<float> table(c_signalCurveTableSize + 1);
+  const float exponent = random.Uniform(0.3f, 3.f);
+  for (size_t i = 0; i < table.size(); i++)
+    table[i] = std::pow(static_cast<float>(i) / c_signalCurveTableSize, exponent);
+  return table;
+}
+}  // namespace
+
+TEST(SimdKernels, VariantsMatchTheScalarReference) {
+  const SimdKernels reference = SimdKernelsFor(SimdIsa_Scalar);
+  CHECK_EQ(reference.isa, SimdIsa_Scalar);
+
+  for (const SimdKernels& variant : Variants()) {
+    std::printf("  checking %s\n", SimdIsaName(variant.isa));
+    Random random(variant.isa);
+
+    // every remainder of the vector widths, from nothing up to a whole skeleton and more
+    for (size_t count = 0; count <= 40; count++) {
+      const std::vector<float> open = Values(random, count * 8, -2.f, 2.f);
+      const std::vector<float> fist = Values(random, count * 8, -2.f, 2.f);
+      const std::vector<float> weights = Values(random, count, -0.25f, 1.25f);
+
+      std::vector<float> expected(count * 8, -1.f);
+      std::vector<float> actual(count * 8, -1.f);
+      reference.blendBones(open.data(), fist.data(), weights.data(), expected.data(), count);
+      variant.blendBones(open.data(), fist.data(), weights.data(), actual.data(), count);
+      CHECK(Same(expected, actual));
+    }
+
+    for (size_t count = 0; count <= 70; count++) {
+      std::vector<float> inputs[4];
+      for (std::vector<float>& input : inputs) input = Values(random, count, -10.f, 10.f);
+      const std::vector<float> weights = Values(random, 4, 0.f, 1.f);
+
+      std::vector<float> expected(count, -1.f);
+      std::vector<float> actual(count, -1.f);
+      reference.blend4(inputs[0].data(), inputs[1].data(), inputs[2].data(), inputs[3].data(),
+                       weights.data(), expected.data(), count);
+      variant.blend4(inputs[0].data(), inputs[1].data(), inputs[2].data(), inputs[3].data(),
+                     weights.data(), actual.data(), count);
+      CHECK(Same(expected, actual));
+    }
+
+    for (uint32_t stages = 0; stages < 16; stages++) {
+      const SignalLaneParameters parameters = RandomParameters(random);
+      const std::vector<float> curveTable = CurveTable(random);
+      const float smoothing = random.Uniform(0.f, 0.95f);
+
+      // a run of packets so the filter history is carried along as in the signal graph
+      std::vector<float> expectedHistory = Values(random, c_signalLaneCount, 0.f, 1.f);
+      std::vector<float> actualHistory = expectedHistory;
+      bool same = true;
+      for (int packet = 0; packet < 200; packet++) {
+        // mostly in range, with values either side and the exact ends
+        std::vector<float> expected = Values(random, c_signalLaneCount, -0.5f, 1.5f);
+        if (packet % 10 == 0) expected[random.Below(c_signalLaneCount)] = 0.f;
+        if (packet % 10 == 5) expected[random.Below(c_signalLaneCount)] = 1.f;
+        std::vector<float> actual = expected;
+
+        reference.signalLanes[stages](parameters, curveTable.data(), smoothing,
+                                      expectedHistory.data(), expected.data());
+        variant.signalLanes[stages](parameters, curveTable.data(), smoothing,
+                                    actualHistory.data(), actual.data());
+        same &= Same(expected, actual) && Same(expectedHistory, actualHistory);
+      }
+      CHECK(same);
+    }
+  }
+}
+
+TEST(SimdKernels, NaNPassesThroughLikeTheReference) {
+  const SimdKernels reference = SimdKernelsFor(SimdIsa_Scalar);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  for (const SimdKernels& variant : Variants()) {
+    Random random(variant.isa);
+    const std::vector<float> curveTable = CurveTable(random);
+
+    // the curve stage turns its input into a table index, which the reference leaves undefined
+    // for NaN, so it is left out
+    for (uint32_t stages = 0; stages < 8; stages++) {
+      const SignalLaneParameters parameters = RandomParameters(random);
+      std::vector<float> expectedHistory(c_signalLaneCount, 0.5f);
+      std::vector<float> actualHistory = expectedHistory;
+      std::vector<float> expected = Values(random, c_signalLaneCount, 0.f, 1.f);
+      expected[1] = nan;
+      expected[6] = nan;
+      std::vector<float> actual = expected;
+
+      reference.signalLanes[stages](parameters, curveTable.data(), 0.5f, expectedHistory.data(),
+                                    expected.data());
+      variant.signalLanes[stages](parameters, curveTable.data(), 0.5f, actualHistory.data(),
+                                  actual.data());
+      CHECK(Same(expected, actual));
+      CHECK(Same(expectedHistory, actualHistory));
+    }
+  }
+}
+
+TEST(SimdKernels, BindsTheBestVariantUpToTheLimit) {
+  CHECK_EQ(BindSimdKernels(SimdIsa_Scalar), SimdIsa_Scalar);
+  CHECK_EQ(Simd().isa, SimdIsa_Scalar);
+
+  const SimdIsa bound = BindSimdKernels();
+  CHECK(bound <= DetectSimdIsa());
+  CHECK_EQ(Simd().isa, bound);
+  CHECK_EQ(SimdKernelsFor(DetectSimdIsa()).isa, bound);
+
+  for (uint32_t isa = 0; isa < c_simdIsaCount; isa++) {
+    SimdIsa parsed;
+    REQUIRE(SimdIsaFromName(SimdIsaName(static_cast<SimdIsa>(isa)), parsed));
+    CHECK_EQ(parsed, static_cast<SimdIsa>(isa));
+  }
+  SimdIsa parsed;
+  CHECK(!SimdIsaFromName("neon", parsed));
+}
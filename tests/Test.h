@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+/**
+ * Just enough of a test framework for openglove_tests. TEST cases register themselves, CHECK
+ * records a failure and carries on, REQUIRE records it and ends the case. A case passes if nothing
+ * failed. CHECK may be used from any thread the case starts.
+ *
+ * openglove_tests runs every case, or with a suite name only that suite, which is how CTest runs
+ * them: one CTest test per *Tests.cpp file, named after it.
+ **/
+using TestFunction = void (*)();
+
+bool RegisterTest(const char* suite, const char* name, TestFunction function);
+void ReportFailure(const char* file, int line, const std::string& message);
+
+// thrown by REQUIRE to leave the case
+struct TestAbort {};
+
+template <typename T>
+std::string DescribeValue(const T& value) {
+  if constexpr (requires(std::ostream& stream) { stream << value; }) {
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+  } else {
+    return "?";
+  }
+}
+
+#define TEST(suite, name)                                                                      \
+  static void suite##_##name();                                                                \
+  static const bool suite##_##name##_registered = RegisterTest(#suite, #name, &suite##_##name); \
+  static void suite##_##name()
+
+#define CHECK(condition) \
+  do {                   \
+    if (!(condition)) ReportFailure(__FILE__, __LINE__, #condition); \
+  } while (0)
+
+#define REQUIRE(condition)                              \
+  do {                                                  \
+    if (!(condition)) {                                 \
+      ReportFailure(__FILE__, __LINE__, #condition);    \
+      throw TestAbort();                                \
+    }                                                   \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                           \
+  do {                                                                                       \
+    const auto& checkActual = (actual);                                                      \
+    const auto& checkExpected = (expected);                                                  \
+    if (!(checkActual == checkExpected))                                                     \
+      ReportFailure(__FILE__, __LINE__,                                                      \
+                    std::string(#actual " == " #expected ", got ") + DescribeValue(checkActual) + \
+                        " and " + DescribeValue(checkExpected));                             \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                               \
+  do {                                                                                        \
+    const double checkActual = (actual);                                                      \
+    const double checkExpected = (expected);                                                  \
+    if (!(std::fabs(checkActual - checkExpected) <= (tolerance)))                             \
+      ReportFailure(__FILE__, __LINE__,                                                       \
+                    std::string(#actual " near " #expected ", got ") +                        \
+                        DescribeValue(checkActual) + " and " + DescribeValue(checkExpected)); \
+  } while (0)
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Test.h"
+
+namespace {
+struct RegisteredTest {
+  const char* suite;
+  const char* name;
+  TestFunction function;
+};
+
+std::vector<RegisteredTest>& Registry() {
+  static std::vector<RegisteredTest> registry;
+  return registry;
+}
+
+std::mutex g_failureMutex;
+int g_failures = 0;
+}  // namespace
+
+bool RegisterTest(const char* suite, const char* name, TestFunction function) {
+  Registry().push_back({suite, name, function});
+  return true;
+}
+
+void ReportFailure(const char* file, int line, const std::string& message) {
+  std::lock_guard<std::mutex> lock(g_failureMutex);
+  g_failures++;
+  std::fprintf(stderr, "%s:%d: %s\n", file, line, message.c_str());
+}
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+
+  int run = 0;
+  int failed = 0;
+  for (const RegisteredTest& test : Registry()) {
+    const std::string fullName = std::string(test.suite) + "." + test.name;
+    if (filter && fullName != filter && std::strcmp(test.suite, filter) != 0) continue;
+
+    std::printf("[ RUN  ] %s\n", fullName.c_str());
+    std::fflush(stdout);
+
+    const int failuresBefore = g_failures;
+    try {
+      test.function();
+    } catch (const TestAbort&) {
+    } catch (const std::exception& e) {
+      ReportFailure(test.suite, 0, std::string("unexpected exception: ") + e.what());
+    }
+
+    run++;
+    const bool passed = g_failures == failuresBefore;
+    if (!passed) failed++;
+    std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", fullName.c_str());
+  }
+
+  if (run == 0) {
+    std::fprintf(stderr, "no test matches %s\n", filter ? filter : "");
+    return 1;
+  }
+
+  std::printf("%d of %d passed\n", run - failed, run);
+  return failed == 0 ? 0 : 1;
+}